@@ -9,6 +9,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "wizchip_conf.h"
+#include "socket.h"
+#include "w5500_reconn.h"
+#include "w5500_failover.h"
 
 
 
@@ -16,15 +19,60 @@ typedef struct __W5500_Cnf_s {
   wiz_NetInfo   info;
   uint8_t       dest_ip[4];
   uint16_t      port;
+  const char*   host;         /// Server host name, NULL to use dest_ip; must stay valid while the connection is open
+  const W5500_Server_t* servers;  /// Server list replacing dest_ip/port/host, NULL for none; must stay valid while the connection is open
+  uint8_t       server_cnt;
 } W5500_Cnf_t;
 
+typedef struct __W5500_DisconStat_s {
+  uint32_t  count;            /// Connection losses (peer close or timeout)
+  uint32_t  timeouts;         /// Losses found by retransmission or keep-alive timeout
+  uint32_t  link_losses;      /// Connections aborted on PHY link loss
+  uint32_t  last_latency_ms;  /// Detection latency of the last loss
+  uint32_t  max_latency_ms;   /// Worst detection latency
+  uint32_t  total_latency_ms; /// Sum of detection latencies, divide by count for the mean
+} W5500_DisconStat_t;
+
+typedef struct __W5500_BootStat_s {
+  uint32_t  spi_us;           /// GPIO, SPI and DMA setup with the reset pulse
+  uint32_t  ready_us;         /// Reset release to VERSIONR answering
+  uint32_t  chip_us;          /// Soft reset, socket memory and network registers
+  uint32_t  sockets_us;       /// Closing every socket
+  uint32_t  init_us;          /// Whole w5500_client_init()
+  uint32_t  link_ms;          /// Init start to link up, 0 until then
+  uint32_t  first_conn_ms;    /// Init start to the first established connection, 0 until then
+  uint32_t  ready_polls;      /// VERSIONR reads until the chip answered
+} W5500_BootStat_t;
+
+typedef int8_t W5500_Handle_t;      /// Client connection, negative when invalid
+
 bool w5500_client_init (const W5500_Cnf_t* INFO);
+int8_t w5500_client_reconfigure (const wiz_NetInfo* info);
 bool w5500_cable_getStatus (uint8_t tries, uint16_t delay);
-int32_t w5500_client_transmit (uint8_t* buf, uint16_t len);
-uint16_t w5500_client_receive (uint8_t* buf, uint16_t len);
-bool w5500_client_is_connected (void);
-bool w5500_client_reconnect (const W5500_Cnf_t* INFO);
-bool w5500_client_disconnect (uint32_t timeout_ms);
+int8_t w5500_client_allocSocket (void);
+void w5500_client_freeSocket (uint8_t sn);
+W5500_Handle_t w5500_client_open (const W5500_Cnf_t* cfg);
+void w5500_client_close (W5500_Handle_t h);
+int8_t w5500_client_getSocket (W5500_Handle_t h);
+int32_t w5500_client_transmit (W5500_Handle_t h, uint8_t* buf, uint16_t len);
+int32_t w5500_client_transmitv (W5500_Handle_t h, wiz_IOVec* iov, uint8_t cnt);
+int32_t w5500_client_tx_reserve (W5500_Handle_t h, uint16_t len, wiz_TxWindow* win);
+int32_t w5500_client_tx_write (W5500_Handle_t h, wiz_TxWindow* win, uint16_t offset, uint8_t* buf, uint16_t len);
+int32_t w5500_client_tx_commit (W5500_Handle_t h, wiz_TxWindow* win, uint16_t len);
+uint16_t w5500_client_receive (W5500_Handle_t h, uint8_t* buf, uint16_t len);
+int32_t w5500_client_receive_view (W5500_Handle_t h, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg);
+uint16_t w5500_client_receive_timeout (W5500_Handle_t h, uint8_t* buf, uint16_t len, uint32_t timeout_ms);
+bool w5500_client_is_connected (W5500_Handle_t h);
+bool w5500_client_reconnect (W5500_Handle_t h);
+bool w5500_client_disconnect (W5500_Handle_t h, uint32_t timeout_ms);
+bool w5500_client_shutdown (W5500_Handle_t h);
+void w5500_client_getDisconStat (W5500_Handle_t h, W5500_DisconStat_t* out);
+void w5500_client_getReconnStat (W5500_Handle_t h, W5500_ReconnStat_t* out);
+void w5500_client_getBootStat (W5500_BootStat_t* out);
+#if (W5500_FAILOVER_ENABLE==YES)
+void w5500_client_getFailoverStat (W5500_Handle_t h, W5500_FailoverStat_t* out);
+bool w5500_client_getServerHealth (W5500_Handle_t h, uint8_t idx, W5500_ServerHealth_t* out);
+#endif
 
 #ifdef __cpluplus
   }
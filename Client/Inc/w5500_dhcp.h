@@ -0,0 +1,71 @@
+
+#ifndef __W5500_DHCP_H_
+#define __W5500_DHCP_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w5500_config.h"
+
+typedef enum {
+  W5500_DHCP_STOPPED = 0,       /// Not started
+  W5500_DHCP_SELECTING,         /// No lease, DISCOVER sent or due, waiting for an OFFER
+  W5500_DHCP_REQUESTING,        /// REQUEST for an OFFER sent, waiting for the ACK
+  W5500_DHCP_REBOOTING,         /// INIT-REBOOT: REQUEST for the stored lease sent, waiting for the ACK
+  W5500_DHCP_BOUND,             /// Lease in use
+  W5500_DHCP_RENEWING,          /// T1 passed, unicast REQUEST to the server
+  W5500_DHCP_REBINDING,         /// T2 passed, broadcast REQUEST to any server
+} W5500_DhcpState_t;
+
+typedef enum {
+  W5500_DHCP_EV_BOUND = 0,      /// New lease applied to the chip
+  W5500_DHCP_EV_RENEWED,        /// Lease extended, the address is unchanged
+  W5500_DHCP_EV_LOST,           /// Lease expired or refused, the address is cleared
+} W5500_DhcpEvent_t;
+
+typedef struct __W5500_DhcpLease_s {
+  uint8_t   mac[6];             /// Owner of the lease
+  uint8_t   ip[4];
+  uint8_t   sn[4];
+  uint8_t   gw[4];
+  uint8_t   dns[4];
+  uint8_t   server[4];          /// Server identifier (option 54)
+  uint32_t  lease_s;            /// Lease time, 0xFFFFFFFF for infinite
+  uint32_t  t1_s;               /// Renewal time
+  uint32_t  t2_s;               /// Rebinding time
+} W5500_DhcpLease_t;
+
+typedef struct __W5500_DhcpStore_s {
+  bool (*load)(W5500_DhcpLease_t* lease);         /// Fill lease from the non-volatile store, false if there is none
+  void (*save)(const W5500_DhcpLease_t* lease);   /// Keep lease for the next start
+} W5500_DhcpStore_t;
+
+typedef struct __W5500_DhcpStat_s {
+  uint32_t  discovers;          /// DISCOVER sent
+  uint32_t  requests;           /// REQUEST sent, all states
+  uint32_t  offers;             /// OFFER taken
+  uint32_t  acks;
+  uint32_t  naks;
+  uint32_t  timeouts;           /// Retransmissions
+  uint32_t  reboots;            /// Leases confirmed by INIT-REBOOT
+  uint32_t  losses;             /// Leases expired or refused
+  uint32_t  last_acquire_ms;    /// First DISCOVER or REQUEST to ACK of the last acquisition
+} W5500_DhcpStat_t;
+
+void w5500_dhcp_setStore (const W5500_DhcpStore_t* store);
+bool w5500_dhcp_init (uint8_t sn, const uint8_t mac[6]);
+void w5500_dhcp_stop (void);
+void w5500_dhcp_process (void);
+bool w5500_dhcp_isBound (void);
+W5500_DhcpState_t w5500_dhcp_getState (void);
+bool w5500_dhcp_getLease (W5500_DhcpLease_t* out);
+void w5500_dhcp_getStat (W5500_DhcpStat_t* out);
+void w5500_dhcp_regCallback (void (*cb)(W5500_DhcpEvent_t ev, const W5500_DhcpLease_t* lease));
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_DHCP_H_
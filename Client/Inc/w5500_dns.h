@@ -0,0 +1,39 @@
+
+#ifndef __W5500_DNS_H_
+#define __W5500_DNS_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w5500_config.h"
+
+typedef enum {
+  W5500_DNS_OK = 0,             /// Address found, from the cache or a dotted literal
+  W5500_DNS_PENDING,            /// Query in flight or waiting for a free slot, call again
+  W5500_DNS_FAIL,               /// The name does not resolve or no server answered, cached for W5500_DNS_NEG_TTL_S
+} W5500_DnsResult_t;
+
+typedef struct __W5500_DnsStat_s {
+  uint32_t  queries;            /// Questions sent, retransmissions included
+  uint32_t  answers;            /// Names resolved by a server
+  uint32_t  cnames;             /// CNAME hops followed
+  uint32_t  failures;           /// NXDOMAIN, empty answers and server errors
+  uint32_t  timeouts;           /// Questions without answer in W5500_DNS_TIMEOUT_MS
+  uint32_t  hits;               /// Lookups answered by the cache, positive or negative
+  uint32_t  misses;             /// Lookups that needed a query
+  uint32_t  last_rtt_us;        /// Question to answer of the last resolution
+} W5500_DnsStat_t;
+
+bool w5500_dns_init (uint8_t sn);
+W5500_DnsResult_t w5500_dns_resolve (const char* name, uint8_t ip[4]);
+void w5500_dns_process (void);
+void w5500_dns_flush (void);
+void w5500_dns_getStat (W5500_DnsStat_t* out);
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_DNS_H_
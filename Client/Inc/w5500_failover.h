@@ -0,0 +1,66 @@
+
+#ifndef __W5500_FAILOVER_H_
+#define __W5500_FAILOVER_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w5500_config.h"
+
+typedef struct __W5500_Server_s {
+  uint8_t       ip[4];
+  uint16_t      port;
+  const char*   host;           /// Host name resolved instead of ip, NULL for none
+  uint8_t       priority;       /// 0 is the most preferred
+} W5500_Server_t;
+
+#if (W5500_FAILOVER_ENABLE==YES)
+typedef struct __W5500_ServerHealth_s {
+  uint32_t  connects;           /// Connections established
+  uint32_t  failures;           /// Failed attempts and connection losses
+  uint8_t   streak;             /// Failures since the last connection
+  uint32_t  connect_us;         /// Smoothed CONNECT to established time
+  uint32_t  rtt_us;             /// Smoothed SEND to SEND_OK time
+  uint32_t  fail_ts;            /// Time of the last failure
+  uint32_t  score;              /// Lower is better, filled on read
+} W5500_ServerHealth_t;
+
+typedef struct __W5500_FailoverStat_s {
+  uint32_t  switches;           /// Moves to another server after failures
+  uint32_t  promotions;         /// Losses taken over by the hot standby
+  uint32_t  failovers;          /// Outages that ended on another server
+  uint32_t  last_latency_ms;    /// First failure to established on another server, last outage
+  uint32_t  max_latency_ms;     /// Worst failover latency
+  uint32_t  total_latency_ms;   /// Sum of failover latencies, divide by failovers for the mean
+} W5500_FailoverStat_t;
+
+typedef struct __W5500_Failover_s {
+  const W5500_Server_t* list;
+  uint8_t               cnt;
+  uint8_t               cur;            /// Server in use
+  bool                  lost;           /// Outage in progress
+  uint8_t               lost_idx;       /// Server of the outage start
+  uint32_t              lost_ts;
+  W5500_ServerHealth_t  health[W5500_FAILOVER_SERVERS];
+  W5500_FailoverStat_t  stat;
+} W5500_Failover_t;
+
+bool w5500_failover_init (W5500_Failover_t* fo, const W5500_Server_t* list, uint8_t cnt);
+int8_t w5500_failover_best (const W5500_Failover_t* fo, int8_t skip);
+bool w5500_failover_next (W5500_Failover_t* fo);
+void w5500_failover_onConnect (W5500_Failover_t* fo, uint8_t idx, uint32_t handshake_us);
+void w5500_failover_onUse (W5500_Failover_t* fo, uint8_t idx);
+void w5500_failover_onFail (W5500_Failover_t* fo, uint8_t idx);
+void w5500_failover_onLoss (W5500_Failover_t* fo);
+void w5500_failover_onRtt (W5500_Failover_t* fo, uint8_t idx, uint32_t rtt_us);
+bool w5500_failover_getHealth (const W5500_Failover_t* fo, uint8_t idx, W5500_ServerHealth_t* out);
+void w5500_failover_getStat (const W5500_Failover_t* fo, W5500_FailoverStat_t* out);
+#endif
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_FAILOVER_H_
@@ -0,0 +1,63 @@
+
+#ifndef __W5500_FRAME_H_
+#define __W5500_FRAME_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w5500_config.h"
+#include "w5500_client.h"
+
+#define W5500_FRAME_ERR_SOCK          (-1)    /// Receive or send failed, or the handle is not open
+#define W5500_FRAME_ERR_SYNC          (-2)    /// Length prefix out of range, the stream can't be trusted anymore
+#define W5500_FRAME_ERR_BUSY          (-3)    /// TX memory short or previous SEND pending, nothing sent, try again
+
+typedef struct __W5500_FrameCnf_s {
+  uint8_t   prefix;             /// Length prefix size: 1, 2 or 4 bytes
+  bool      big_endian;         /// Byte order of the prefix and of the CRC
+  bool      crc;                /// CRC-16/CCITT-FALSE of the payload after it, needs a buffer
+  uint16_t  max_len;            /// Largest payload accepted
+} W5500_FrameCnf_t;
+
+typedef struct __W5500_Frame_s {
+  uint16_t        len;          /// Payload length
+  const uint8_t*  data;         /// Payload in the buffer of the framer, NULL when it is left in the chip
+  wiz_StreamView* view;         /// Where the payload is left in the chip, read it with w5500_frame_read()
+  uint16_t        offset;       /// Offset of the payload in the view
+} W5500_Frame_t;
+
+typedef struct __W5500_FrameStat_s {
+  uint32_t  frames;             /// Frames delivered
+  uint32_t  bytes;              /// Payload bytes delivered
+  uint32_t  recvs;              /// RECV commands issued, frames / recvs is the batching
+  uint32_t  bursts;             /// Data reads from the chip RX memory
+  uint32_t  crc_errors;         /// Frames dropped on a CRC mismatch
+  uint32_t  sync_errors;        /// Length prefixes out of range
+} W5500_FrameStat_t;
+
+typedef struct __W5500_Framer_s {
+  W5500_FrameCnf_t  cnf;
+  uint8_t*          buf;        /// Copy buffer, NULL to leave the payloads in the chip
+  uint16_t          size;
+  uint16_t          rx_max;     /// Socket RX memory size, read on the first receive
+  void              (*on_frame)(const W5500_Frame_t* frame, void* arg);
+  void*             arg;
+  int32_t           count;      /// Frames delivered by the receive in progress
+  int32_t           err;
+  W5500_FrameStat_t stat;
+} W5500_Framer_t;
+
+bool w5500_frame_init (W5500_Framer_t* f, const W5500_FrameCnf_t* cnf, uint8_t* buf, uint16_t size,
+                       void (*on_frame)(const W5500_Frame_t* frame, void* arg), void* arg);
+int32_t w5500_frame_process (W5500_Framer_t* f, W5500_Handle_t h);
+int32_t w5500_frame_read (const W5500_Frame_t* frame, uint16_t offset, uint8_t* buf, uint16_t len);
+int32_t w5500_frame_send (W5500_Framer_t* f, W5500_Handle_t h, uint8_t* buf, uint16_t len);
+void w5500_frame_getStat (const W5500_Framer_t* f, W5500_FrameStat_t* out);
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_FRAME_H_
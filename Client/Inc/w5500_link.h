@@ -0,0 +1,34 @@
+
+#ifndef __W5500_LINK_H_
+#define __W5500_LINK_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w5500_config.h"
+
+typedef struct __W5500_LinkState_s {
+  bool      up;                 /// PHY link established
+  uint8_t   speed;              /// PHY_SPEED_10 or PHY_SPEED_100, valid while up
+  uint8_t   duplex;             /// PHY_DUPLEX_HALF or PHY_DUPLEX_FULL, valid while up
+  uint32_t  changes;            /// Link up/down transitions
+  uint32_t  aborted;            /// TCP sockets aborted on link loss
+  uint32_t  samples;            /// PHYCFGR reads
+  uint32_t  change_ts;          /// Time of the last transition
+  uint32_t  last_down_ms;       /// Length of the last outage
+} W5500_LinkState_t;
+
+void w5500_link_init (void);
+bool w5500_link_process (void);
+void w5500_link_notify (void);
+bool w5500_link_isUp (void);
+void w5500_link_get (W5500_LinkState_t* out);
+bool w5500_link_regCallback (void (*cb)(const W5500_LinkState_t* st));
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_LINK_H_
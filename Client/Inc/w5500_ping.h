@@ -0,0 +1,39 @@
+
+#ifndef __W5500_PING_H_
+#define __W5500_PING_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w5500_config.h"
+
+#if (W5500_PING_ENABLE==YES)
+typedef struct __W5500_PingStat_s {
+  uint8_t   ip[4];                              /// Target address
+  uint32_t  sent;                               /// Echo requests sent
+  uint32_t  received;                           /// Matching echo replies
+  uint32_t  lost;                               /// Requests without reply in W5500_PING_TIMEOUT_MS
+  uint32_t  rtt_min_us;                         /// Smallest RTT
+  uint32_t  rtt_avg_us;                         /// Mean RTT, filled on read
+  uint32_t  rtt_max_us;                         /// Largest RTT
+  uint32_t  rtt_last_us;                        /// RTT of the last reply
+  uint32_t  jitter_us;                          /// Smoothed RTT variation (RFC 3550 interarrival jitter)
+  uint32_t  rtt_hist[W5500_PING_HIST_BINS];     /// RTT histogram
+  uint32_t  jitter_hist[W5500_PING_HIST_BINS];  /// Histogram of the RTT change between consecutive replies
+} W5500_PingStat_t;
+
+bool w5500_ping_init (void);
+int8_t w5500_ping_addTarget (const uint8_t ip[4]);
+void w5500_ping_removeTarget (uint8_t idx);
+void w5500_ping_process (void);
+bool w5500_ping_getStat (uint8_t idx, W5500_PingStat_t* out);
+void w5500_ping_resetStat (uint8_t idx);
+#endif
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_PING_H_
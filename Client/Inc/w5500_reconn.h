@@ -0,0 +1,55 @@
+
+#ifndef __W5500_RECONN_H_
+#define __W5500_RECONN_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  W5500_RECONN_DOWN = 0,        /// Not connected, next attempt at next_ts
+  W5500_RECONN_CONNECTING,      /// CONNECT issued, waiting for the handshake
+  W5500_RECONN_UP,              /// Connection established
+} W5500_ReconnState_t;
+
+typedef struct __W5500_ReconnStat_s {
+  uint32_t  attempts;           /// CONNECT commands issued
+  uint32_t  failures;           /// Attempts refused, timed out or failed to start
+  uint32_t  connects;           /// Connections established
+  uint32_t  link_ups;           /// Link returns that triggered an immediate attempt
+  uint32_t  last_ttr_ms;        /// Time to reconnect of the last outage (loss to established)
+  uint32_t  max_ttr_ms;         /// Longest time to reconnect
+  uint32_t  total_ttr_ms;       /// Sum of times to reconnect, divide by connects for the mean
+  uint32_t  last_recovery_ms;   /// Last failed attempt to established: bounds the delay after the server came back
+  uint32_t  last_handshake_us;  /// CONNECT to established of the last connection
+} W5500_ReconnStat_t;
+
+typedef struct __W5500_Reconn_s {
+  uint8_t             sn;             /// Socket of the connection
+  uint8_t             dest_ip[4];
+  uint16_t            port;
+  W5500_ReconnState_t state;
+  bool                link;           /// Cached PHY link at the last step
+  bool                failed;         /// An attempt failed during the current outage
+  uint32_t            delay_ms;       /// Backoff before the next attempt after a failure
+  uint32_t            next_ts;        /// Time of the next attempt
+  uint32_t            attempt_ts;     /// Time of the current CONNECT
+  uint32_t            down_ts;        /// Time the connection was lost
+  uint32_t            fail_ts;        /// Time of the last failed attempt
+  W5500_ReconnStat_t  stat;
+} W5500_Reconn_t;
+
+void w5500_reconn_init (W5500_Reconn_t* rc, uint8_t sn, const uint8_t ip[4], uint16_t port);
+W5500_ReconnState_t w5500_reconn_process (W5500_Reconn_t* rc);
+void w5500_reconn_kick (W5500_Reconn_t* rc);
+void w5500_reconn_restart (W5500_Reconn_t* rc);
+void w5500_reconn_setDest (W5500_Reconn_t* rc, const uint8_t ip[4], uint16_t port);
+void w5500_reconn_getStat (const W5500_Reconn_t* rc, W5500_ReconnStat_t* out);
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_RECONN_H_
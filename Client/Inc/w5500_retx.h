@@ -0,0 +1,33 @@
+
+#ifndef __W5500_RETX_H_
+#define __W5500_RETX_H_
+
+#ifdef __cplusplus
+  extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct __W5500_RetxStat_s {
+  uint32_t  srtt_us;          /// Smoothed round trip time
+  uint32_t  rttvar_us;        /// Round trip time variation
+  uint32_t  rto_us;           /// Retry time derived from srtt/rttvar before RTR rounding
+  uint16_t  rtr;              /// Applied RTR (100us units)
+  uint8_t   rcr;              /// Applied RCR
+  uint32_t  dead_peer_ms;     /// Time the chip needs to give up on a silent TCP peer
+  uint32_t  samples;          /// RTT samples accepted
+  uint32_t  updates;          /// RTR/RCR reapplications
+  uint32_t  timeouts;         /// Sn_IR_TIMEOUT seen on SEND
+  uint32_t  retransmits;      /// Estimated retransmissions from slow SEND_OK and timeouts
+} W5500_RetxStat_t;
+
+void w5500_retx_init (void);
+void w5500_retx_sample (uint32_t rtt_us, bool exact);
+void w5500_retx_onSendDone (uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact);
+void w5500_retx_getStat (W5500_RetxStat_t* stat);
+
+#ifdef __cplusplus
+  }
+#endif //__cplusplus
+#endif //__W5500_RETX_H_
@@ -12,7 +12,9 @@
  * The driver supports optional FreeRTOS integration and configurable
  * debug tracing.
  *
- * @note This implementation uses socket number 1 for all client operations.
+ * Each connection opened by w5500_client_open() gets a free hardware socket
+ * and is addressed by the returned handle, so up to W5500_CLIENT_MAX_CONN
+ * servers can be served side by side.
  * @note Network parameters can be set statically or dynamically based on
  *       compile-time configuration.
  *
@@ -23,6 +25,12 @@
 #include "w5500_spi_driver.h"
 #include "w5500_client.h"
 #include "w5500_config.h"
+#include "w5500_retx.h"
+#include "w5500_ping.h"
+#include "w5500_reconn.h"
+#include "w5500_link.h"
+#include "w5500_dhcp.h"
+#include "w5500_dns.h"
 #include "socket.h"
 #include "main.h"
 
@@ -53,9 +61,365 @@ const W5500_Cnf_t STATIC_INFO = {
   },
   .dest_ip = W5500_DESTINATION_IP,
   .port    = W5500_PORT,
+  .host    = W5500_DESTINATION_HOST,
 };
 #endif
 
+#if (W5500_KEEPALIVE_ENABLE==YES)
+#if (W5500_KEEPALIVE_INTERVAL_S < 5) || (W5500_KEEPALIVE_INTERVAL_S > 1275)
+#error "W5500_KEEPALIVE_INTERVAL_S out of the Sn_KPALVTR range"
+#endif
+#endif
+
+#if (W5500_CLIENT_MAX_CONN < 1) || (W5500_CLIENT_MAX_CONN > 8)
+#error "W5500_CLIENT_MAX_CONN must be 1 to 8"
+#endif
+
+#define W5500_VERSION                 0x04    // VERSIONR of the W5500
+
+typedef struct __W5500_Conn_s {
+  bool                used;
+  W5500_Reconn_t      reconn;       /// Holds the socket and the server of the connection
+  const char*         host;         /// Server host name, resolved into reconn.dest_ip before each attempt
+  W5500_DisconStat_t  discon;
+  bool                restart;      /// Aborted by a network change, started over on the next step
+  #if (W5500_FAILOVER_ENABLE==YES)
+  W5500_Failover_t    fo;           /// Servers and their health, cnt 0 for a single server
+  #if (W5500_FAILOVER_STANDBY==YES)
+  bool                has_standby;  /// A socket is allocated to the standby
+  int8_t              standby_idx;  /// Server of the standby, -1 for none
+  W5500_Reconn_t      standby;      /// Pre-connection to the best other server
+  #endif
+  #endif
+} W5500_Conn_t;
+
+static W5500_Conn_t conns[W5500_CLIENT_MAX_CONN];
+static uint8_t sock_used;           // Allocated hardware sockets, one bit each
+static uint8_t sock_releasing;      // Freed when their shutdown ends
+static W5500_BootStat_t boot;
+static uint32_t boot_ts;            // Start of w5500_client_init()
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the connection of a handle.
+ *
+ * @param[in] h Connection handle.
+ *
+ * @return The connection, or NULL if the handle is not open.
+ */
+static W5500_Conn_t* __w5500_client_conn (W5500_Handle_t h) {
+  if (h < 0 || h >= W5500_CLIENT_MAX_CONN || !conns[h].used) {
+    return NULL;
+  }
+  return &conns[h];
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Find the open connection using a hardware socket.
+ *
+ * @param[in] sn Socket number.
+ *
+ * @return The connection, or NULL if the socket is not used by one.
+ */
+static W5500_Conn_t* __w5500_client_connOf (uint8_t sn) {
+  for (uint8_t i = 0; i < W5500_CLIENT_MAX_CONN; i++) {
+    if (conns[i].used && conns[i].reconn.sn == sn) {
+      return &conns[i];
+    }
+  }
+  return NULL;
+}
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Disconnect hook registered with the socket layer.
+ *
+ * Records how long a client connection took to notice its loss.
+ * Local disconnects are not failures and are not counted. Connections
+ * aborted by a network change are started over without counting either.
+ *
+ * @param[in] sn         Socket number.
+ * @param[in] cause      SOCK_DISCON_LOCAL, SOCK_DISCON_PEER, SOCK_DISCON_TIMEOUT, SOCK_DISCON_LINK or SOCK_DISCON_NETCHG.
+ * @param[in] latency_ms Time since the server was last heard of.
+ */
+static void __w5500_client_onDisconnect (uint8_t sn, uint8_t cause, uint32_t latency_ms) {
+  W5500_Conn_t* c = __w5500_client_connOf(sn);
+  if (c == NULL || cause == SOCK_DISCON_LOCAL) {
+    return;
+  }
+  if (cause == SOCK_DISCON_NETCHG) {
+    // The server is not to blame, keep it out of the loss and failover books
+    c->restart = true;
+    return;
+  }
+  c->discon.count++;
+  if (cause == SOCK_DISCON_TIMEOUT) {
+    c->discon.timeouts++;
+  }
+  else if (cause == SOCK_DISCON_LINK) {
+    c->discon.link_losses++;
+  }
+  c->discon.last_latency_ms = latency_ms;
+  c->discon.total_latency_ms += latency_ms;
+  if (latency_ms > c->discon.max_latency_ms) {
+    c->discon.max_latency_ms = latency_ms;
+  }
+  LOG_WARNING("W5500 :: Socket %u connection lost (%s), detected after %lu ms", sn,
+              (cause == SOCK_DISCON_TIMEOUT) ? "timeout" : (cause == SOCK_DISCON_LINK) ? "link" : "peer", latency_ms);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Shutdown hook registered with the socket layer.
+ *
+ * The socket of a closed handle returns to the free pool here.
+ *
+ * @param[in] sn         Socket number.
+ * @param[in] how        SOCK_SHUT_CLOSED, SOCK_SHUT_LINGER or SOCK_SHUT_ABORT.
+ * @param[in] elapsed_ms Time the shutdown took.
+ */
+static void __w5500_client_onShutdown (uint8_t sn, uint8_t how, uint32_t elapsed_ms) {
+  (void)elapsed_ms;
+  if (sock_releasing & (1 << sn)) {
+    sock_releasing &= ~(1 << sn);
+    sock_used &= ~(1 << sn);
+  }
+  if (how == SOCK_SHUT_CLOSED) {
+    LOG_TRACE("W5500 :: Socket %u closed gracefully in %lu ms", sn, elapsed_ms);
+  }
+  else {
+    LOG_WARNING("W5500 :: Socket %u %s after %lu ms", sn,
+                (how == SOCK_SHUT_LINGER) ? "linger expired, closed" : "aborted", elapsed_ms);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Link change hook registered with the link monitor.
+ *
+ * Records when the link first came up after the initialization.
+ *
+ * @param[in] st New link state.
+ */
+static void __w5500_client_onLink (const W5500_LinkState_t* st) {
+  if (st->up && boot.link_ms == 0) {
+    boot.link_ms = (st->change_ts - boot_ts) / 1000;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief SEND completion hook registered with the socket layer.
+ *
+ * Feeds the retransmission manager and the health of the server in use.
+ *
+ * @param[in] sn         Socket number.
+ * @param[in] ir         Sn_IR_SENDOK or Sn_IR_TIMEOUT.
+ * @param[in] elapsed_us SEND to completion time.
+ * @param[in] exact      Non-zero if timed by the interrupt.
+ */
+static void __w5500_client_onSendOk (uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact) {
+  (void)sn;
+  (void)ir;
+  (void)elapsed_us;
+  (void)exact;
+  #if (W5500_RETX_ADAPTIVE==YES)
+  w5500_retx_onSendDone(sn, ir, elapsed_us, exact);
+  #endif
+  #if (W5500_FAILOVER_ENABLE==YES)
+  W5500_Conn_t* c = __w5500_client_connOf(sn);
+  if (c != NULL && c->fo.cnt != 0 && (ir & Sn_IR_SENDOK)) {
+    w5500_failover_onRtt(&c->fo, c->fo.cur, elapsed_us);
+  }
+  #endif
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Time of a start-up phase.
+ *
+ * @param[in,out] t Start of the phase, set to the start of the next one.
+ *
+ * @return Duration of the phase in microseconds.
+ */
+static uint32_t __w5500_client_lap (uint32_t* t) {
+  uint32_t now = W5500_GetMicros();
+  uint32_t lap = now - *t;
+  *t = now;
+  return lap;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Wait for the chip to come out of reset.
+ *
+ * VERSIONR reads back W5500_VERSION once the chip answers on SPI, usually
+ * within the first millisecond after RSTn is released.
+ *
+ * @return true if the chip answered within W5500_READY_TIMEOUT_MS.
+ */
+static bool __w5500_client_waitReady (void) {
+  uint32_t start = W5500_GetMicros();
+  do {
+    boot.ready_polls++;
+    if (getVERSIONR() == W5500_VERSION) {
+      return true;
+    }
+  } while ((W5500_GetMicros() - start) / 1000 < W5500_READY_TIMEOUT_MS);
+  return false;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Arm the automatic keep-alive of a freshly connected client socket.
+ *
+ * The chip probes an idle connection every W5500_KEEPALIVE_INTERVAL_S; a
+ * silent server then ends in Sn_IR_TIMEOUT after the RTR/RCR give-up time.
+ *
+ * @param[in] sn Socket number.
+ *
+ * @note The W5500 sends keep-alive only after the first data exchange.
+ */
+static void __w5500_client_keepalive (uint8_t sn) {
+  #if (W5500_KEEPALIVE_ENABLE==YES)
+  uint8_t kpalv = (uint8_t)(W5500_KEEPALIVE_INTERVAL_S / 5);
+  if (setsockopt(sn, SO_KEEPALIVEAUTO, (void*)&kpalv) != SOCK_OK) {
+    LOG_WARNING("W5500 :: Keep-alive not set");
+  }
+  #else
+  (void)sn;
+  #endif
+}
+#if (W5500_FAILOVER_ENABLE==YES)
+//--------------------------------------------------------------------------
+/**
+ * @brief Point the connection to a server of its list.
+ *
+ * @param[in] c   Connection.
+ * @param[in] idx Server.
+ */
+static void __w5500_client_useServer (W5500_Conn_t* c, uint8_t idx) {
+  const W5500_Server_t* sv = &c->fo.list[idx];
+  c->host = sv->host;
+  w5500_reconn_setDest(&c->reconn, sv->ip, sv->port);
+}
+#if (W5500_FAILOVER_STANDBY==YES)
+//--------------------------------------------------------------------------
+/**
+ * @brief Keep the standby connection to the best other server.
+ *
+ * It is retargeted only when it has no server, its server became the one
+ * in use, or its server keeps failing, so small score changes don't make
+ * it reconnect.
+ *
+ * @param[in] c Connection.
+ */
+static void __w5500_client_standby (W5500_Conn_t* c) {
+  W5500_Reconn_t* sb = &c->standby;
+  int8_t want = w5500_failover_best(&c->fo, (int8_t)c->fo.cur);
+  if (want < 0) {
+    return;
+  }
+  if (c->standby_idx < 0 || c->standby_idx == (int8_t)c->fo.cur ||
+      (c->standby_idx != want && sb->state == W5500_RECONN_DOWN && c->fo.health[c->standby_idx].streak >= W5500_FAILOVER_FAILS)) {
+    if (socket_check(sb->sn) != SOCK_CLOSED) {
+      close(sb->sn);
+    }
+    w5500_reconn_init(sb, sb->sn, c->fo.list[want].ip, c->fo.list[want].port);
+    c->standby_idx = want;
+  }
+  const W5500_Server_t* sv = &c->fo.list[c->standby_idx];
+  W5500_ReconnState_t prev = sb->state;
+  uint32_t fails = sb->stat.failures;
+  #if (W5500_DNS_ENABLE==YES)
+  if (prev == W5500_RECONN_DOWN && sv->host != NULL && w5500_dns_resolve(sv->host, sb->dest_ip) != W5500_DNS_OK) {
+    return;
+  }
+  #endif
+  W5500_ReconnState_t st = w5500_reconn_process(sb);
+  if (!w5500_link_isUp()) {
+    return;
+  }
+  if (sb->stat.failures != fails || (prev == W5500_RECONN_UP && st != W5500_RECONN_UP)) {
+    w5500_failover_onFail(&c->fo, (uint8_t)c->standby_idx);
+  }
+  else if (prev != W5500_RECONN_UP && st == W5500_RECONN_UP) {
+    w5500_failover_onConnect(&c->fo, (uint8_t)c->standby_idx, sb->stat.last_handshake_us);
+    __w5500_client_keepalive(sb->sn);
+    LOG_TRACE("W5500 :: Standby to server %d on socket %u", c->standby_idx, sb->sn);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Take the established standby as the connection in use.
+ *
+ * The socket of the lost connection becomes the standby socket.
+ *
+ * @param[in] c Connection.
+ *
+ * @return true if the standby took over.
+ */
+static bool __w5500_client_promote (W5500_Conn_t* c) {
+  if (c->standby_idx < 0 || c->standby.state != W5500_RECONN_UP || socket_check(c->standby.sn) != SOCK_ESTABLISHED) {
+    return false;
+  }
+  W5500_Reconn_t lost = c->reconn;
+  uint8_t idx = (uint8_t)c->standby_idx;
+  c->reconn = c->standby;
+  c->standby = lost;
+  c->standby_idx = -1;
+  c->host = c->fo.list[idx].host;
+  c->fo.stat.promotions++;
+  w5500_failover_onUse(&c->fo, idx);
+  LOG_INFO("W5500 :: Standby to server %u took over on socket %u", idx, c->reconn.sn);
+  return true;
+}
+#endif
+//--------------------------------------------------------------------------
+/**
+ * @brief Account a step of the connection and fail over when needed.
+ *
+ * Failures of the server in use move the connection to the best other
+ * server after W5500_FAILOVER_FAILS in a row, at once rather than after the
+ * backoff. With a standby, the loss is taken over on the same step.
+ * Nothing is held against the servers while the link is down.
+ *
+ * @param[in] c     Connection.
+ * @param[in] prev  State before the step.
+ * @param[in] fails Failed attempts before the step.
+ *
+ * @return State of the connection in use after the step.
+ */
+static W5500_ReconnState_t __w5500_client_failover (W5500_Conn_t* c, W5500_ReconnState_t prev, uint32_t fails) {
+  W5500_Failover_t* fo = &c->fo;
+  W5500_ReconnState_t st = c->reconn.state;
+  if (w5500_link_isUp()) {
+    bool failed = false;
+    if (prev == W5500_RECONN_UP && st != W5500_RECONN_UP) {
+      w5500_failover_onLoss(fo);
+      failed = true;
+    }
+    else if (c->reconn.stat.failures != fails) {
+      w5500_failover_onFail(fo, fo->cur);
+      failed = true;
+    }
+    #if (W5500_FAILOVER_STANDBY==YES)
+    if (st != W5500_RECONN_UP && c->has_standby && __w5500_client_promote(c)) {
+      return c->reconn.state;
+    }
+    #endif
+    if (failed && w5500_failover_next(fo)) {
+      __w5500_client_useServer(c, fo->cur);
+    }
+  }
+  if (prev != W5500_RECONN_UP && st == W5500_RECONN_UP) {
+    if (prev == W5500_RECONN_CONNECTING) {
+      w5500_failover_onConnect(fo, fo->cur, c->reconn.stat.last_handshake_us);
+    }
+    w5500_failover_onUse(fo, fo->cur);
+  }
+  #if (W5500_FAILOVER_STANDBY==YES)
+  if (c->has_standby) {
+    __w5500_client_standby(c);
+  }
+  #endif
+  return st;
+}
+#endif
 //--------------------------------------------------------------------------
 /**
  * @brief Check the W5500 LAN cable link status with retries.
@@ -85,27 +449,35 @@ bool w5500_cable_getStatus (uint8_t tries, uint16_t delay) {
  * @brief Initialize the W5500 Ethernet client with the specified network configuration.
  *
  * This function initializes the W5500 chip and its SPI interface, configures the network
- * settings, checks the LAN cable connection, and establishes a TCP connection to the server.
+ * settings and starts the link monitor. Connections to servers are then opened
+ * with w5500_client_open(); they are established once the LAN cable is connected.
  *
  * @param[in] INFO Pointer to a W5500_Cnf_t structure containing network configuration information.
  *                 If `W5500_USER_NETWORK_CONFIG` is set to `NO`, this parameter is ignored and
  *                 a static configuration is used instead.
  *
- * @return true if the initialization and connection are successful; false otherwise.
+ * @return true if the initialization is successful; false otherwise.
  *
  * @note This function performs the following steps:
  *       - Initializes SPI communication with the W5500.
  *       - Registers chip select and SPI callback functions.
+ *       - Polls VERSIONR until the chip answers, instead of a fixed delay.
  *       - Initializes the Wiznet chip memory size.
  *       - Sets the network information on the W5500.
- *       - Checks the LAN cable status.
- *       - Closes any existing sockets and disconnects.
- *       - Creates a TCP socket and connects to the server specified in INFO.
+ *       - Closes every socket with one batch of commands.
+ *       - Takes a first sample of the LAN cable link, without waiting for it.
+ *       - Starts the DHCP client if the configuration asks for it; the address
+ *         is acquired in the background by w5500_dhcp_process().
+ *       - Opens the DNS resolver on a socket of its own.
+ *       - Returns every socket but the reserved ones to the free pool.
+ *       The time of each phase is kept, refer to w5500_client_getBootStat().
  *
  * @warning If the INFO pointer is NULL when user configuration is enabled, the function returns false.
  * @warning Ensure that the W5500 hardware is correctly connected before calling this function.
  */
 bool w5500_client_init (const W5500_Cnf_t* INFO) {
+  uint32_t t0 = W5500_GetMicros();
+  uint32_t t = t0;
   #if (W5500_USER_NETWORK_CONFIG==NO)
   INFO = &STATIC_INFO;
   #else 
@@ -115,6 +487,16 @@ bool w5500_client_init (const W5500_Cnf_t* INFO) {
   }
   #endif
   LOG_TRACE("W5500 :: Client initializing...");
+  boot = (W5500_BootStat_t){0};
+  boot_ts = t0;
+  for (uint8_t i = 0; i < W5500_CLIENT_MAX_CONN; i++) {
+    conns[i].used = false;
+  }
+  sock_used = 0;
+  sock_releasing = 0;
+  #if (W5500_PING_ENABLE==YES)
+  sock_used |= (1 << W5500_PING_SOCKET);
+  #endif
   if (!w5500_spi_init()) {
     LOG_ERROR("W5500 :: Failed to initial the SPI");
     return false;
@@ -122,7 +504,13 @@ bool w5500_client_init (const W5500_Cnf_t* INFO) {
   reg_wizchip_cs_cbfunc(w5500_cs_low, w5500_cs_high);
   reg_wizchip_spi_cbfunc(w5500_spi_Receive1Byte, w5500_spi_Transmit1Byte);  
   reg_wizchip_spiburst_cbfunc(w5500_spi_ReceiveBurstDMA, w5500_spi_TransmitBurstDMA);  
-  uint8_t tmp;
+  reg_wizchip_spiburstv_cbfunc(w5500_spi_ReceiveBurstvDMA, w5500_spi_TransmitBurstvDMA);
+  boot.spi_us = __w5500_client_lap(&t);
+  if (!__w5500_client_waitReady()) {
+    LOG_ERROR("W5500 :: Chip not responding");
+    return false;
+  }
+  boot.ready_us = __w5500_client_lap(&t);
 	uint8_t memsize[2][8] = {
     { 2, 2, 2, 2, 2, 2, 2, 2 },
     { 2, 2, 2, 2, 2, 2, 2, 2 },
@@ -131,49 +519,292 @@ bool w5500_client_init (const W5500_Cnf_t* INFO) {
 		LOG_ERROR("W5500 :: Failed to initial the LAN module");
 		return false;
 	}
-  LOG_TRACE("W5500 :: LAN Cable checking...");
   ctlnetwork(CN_SET_NETINFO, (void*)&INFO->info);
-  if (!w5500_cable_getStatus(3, 100)) {
-    LOG_ERROR("W5500 :: Cable is not connect");
-    return false;
+  boot.chip_us = __w5500_client_lap(&t);
+  // The PHY negotiates meanwhile, the connections start as soon as the link monitor sees it up
+  close_all();
+  boot.sockets_us = __w5500_client_lap(&t);
+  w5500_link_init();
+  w5500_link_regCallback(__w5500_client_onLink);
+  if (w5500_link_isUp()) {
+    boot.link_ms = (t - t0) / 1000;
   }
-  for (uint8_t i = 0; i < 8; i++) {
-    disconnect(i);
-    W5500_Delay(1);
-    close(i);
+  else {
+    LOG_WARNING("W5500 :: Cable is not connect, the connections wait for the link");
   }
-//  setRTR((W5500_RETRY_CONN_DELAY * 10)); // Retry timeout in 100us units -> = 25 ms
-//  setRCR(W5500_RETRY_COUNTS);          // Retry count
-  if (socket(1, Sn_MR_TCP, 0, 0) != 1) {
-	  LOG_ERROR("W5500 :: Failed to create the socket");
-    return false;
+  #if (W5500_DHCP_ENABLE==YES)
+  if (INFO->info.dhcp == NETINFO_DHCP) {
+    int8_t sn = w5500_client_allocSocket();
+    if (sn < 0 || !w5500_dhcp_init((uint8_t)sn, INFO->info.mac)) {
+      LOG_ERROR("W5500 :: Failed to start DHCP");
+      return false;
+    }
+  }
+  else {
+    w5500_dhcp_stop();
   }
-  if (connect(1, (uint8_t*)INFO->dest_ip, INFO->port) != SOCK_OK) {
-    LOG_ERROR("W5500 :: Can't connect to the server");
+  #endif
+  #if (W5500_DNS_ENABLE==YES)
+  int8_t dns_sn = w5500_client_allocSocket();
+  if (dns_sn < 0 || !w5500_dns_init((uint8_t)dns_sn)) {
+    LOG_ERROR("W5500 :: Failed to start DNS");
     return false;
   }
-  LOG_TRACE("W5500 :: Initial success");
+  #endif
+  #if (W5500_RETX_ADAPTIVE==YES)
+  w5500_retx_init();
+  #endif
+  // Replaces the hook of w5500_retx_init(), which it calls in turn
+  reg_socket_sendok_cbfunc(__w5500_client_onSendOk);
+  reg_socket_discon_cbfunc(__w5500_client_onDisconnect);
+  reg_socket_shutdown_cbfunc(__w5500_client_onShutdown);
+  #if (W5500_PING_ENABLE==YES)
+  w5500_ping_init();
+  #endif
+  boot.init_us = W5500_GetMicros() - t0;
+  LOG_TRACE("W5500 :: Initial success in %lu us (SPI %lu, ready %lu, chip %lu, sockets %lu)",
+            boot.init_us, boot.spi_us, boot.ready_us, boot.chip_us, boot.sockets_us);
   return true;
 }
 //--------------------------------------------------------------------------
 /**
- * @brief Transmit data through the W5500 client socket.
+ * @brief Start a connection over if a network change closed its socket.
+ *
+ * @param[in] rc Reconnect manager of the connection or of its standby.
+ */
+static void __w5500_client_netRestart (W5500_Reconn_t* rc) {
+  if (rc->state != W5500_RECONN_DOWN && getSn_SR(rc->sn) == SOCK_CLOSED) {
+    w5500_reconn_restart(rc);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Change the network settings of a running client, without a chip reset.
+ *
+ * Only the registers that differ are written, in one burst. The connections
+ * the change breaks are aborted and started over on their next
+ * w5500_client_reconnect(), without counting as failures of their server;
+ * the others go on untouched, so a new gateway keeps the peers of the local
+ * subnet connected. A new DNS server flushes the resolver cache.
+ *
+ * @param[in] info New network settings. NETINFO_STATIC stops a running DHCP
+ *                 client first; NETINFO_DHCP leaves it running, its lease
+ *                 then overrides the address on the next renewal.
+ *
+ * @return Number of sockets aborted, -1 if info is NULL.
+ */
+int8_t w5500_client_reconfigure (const wiz_NetInfo* info) {
+  wiz_NetInfo prev;
+  if (info == NULL) {
+    return -1;
+  }
+  #if (W5500_DHCP_ENABLE==YES)
+  if (info->dhcp == NETINFO_STATIC && w5500_dhcp_getState() != W5500_DHCP_STOPPED) {
+    w5500_dhcp_stop();
+  }
+  #endif
+  ctlnetwork(CN_GET_NETINFO, (void*)&prev);
+  uint8_t chg = (uint8_t)ctlnetwork(CN_UPDATE_NETINFO, (void*)info);
+  int8_t aborted = 0;
+  if (chg & (NETINFO_CHG_GW | NETINFO_CHG_SN | NETINFO_CHG_MAC | NETINFO_CHG_IP)) {
+    aborted = socket_netchange(&prev, (wiz_NetInfo*)info);
+    // Attempts in progress are aborted too, and not reported as disconnects
+    for (uint8_t i = 0; i < W5500_CLIENT_MAX_CONN; i++) {
+      if (!conns[i].used) {
+        continue;
+      }
+      conns[i].restart = false;
+      __w5500_client_netRestart(&conns[i].reconn);
+      #if (W5500_FAILOVER_ENABLE==YES) && (W5500_FAILOVER_STANDBY==YES)
+      if (conns[i].has_standby) {
+        __w5500_client_netRestart(&conns[i].standby);
+      }
+      #endif
+    }
+  }
+  #if (W5500_DNS_ENABLE==YES)
+  if (chg & NETINFO_CHG_DNS) {
+    w5500_dns_flush();
+  }
+  #endif
+  LOG_INFO("W5500 :: Network reconfigured (changes 0x%02X), %d sockets aborted", chg, aborted);
+  return aborted;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Allocate a free hardware socket.
+ *
+ * For the client connections and any other module that needs a socket of
+ * its own, so they never step on each other.
+ *
+ * @return The socket number, or -1 if all sockets are in use.
+ */
+int8_t w5500_client_allocSocket (void) {
+  for (uint8_t sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++) {
+    if (!(sock_used & (1 << sn))) {
+      sock_used |= (1 << sn);
+      return (int8_t)sn;
+    }
+  }
+  return -1;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Return a socket allocated by w5500_client_allocSocket() to the free pool.
+ *
+ * @param[in] sn Socket number. The socket must be closed by the caller.
+ */
+void w5500_client_freeSocket (uint8_t sn) {
+  if (sn < _WIZCHIP_SOCK_NUM_) {
+    sock_releasing &= ~(1 << sn);
+    sock_used &= ~(1 << sn);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Open a connection to a server on a free hardware socket.
+ *
+ * Returns at once; the connection is established and kept up by
+ * w5500_client_reconnect() from the service loop.
+ *
+ * @param[in] cfg Server address and port (dest_ip, port), or host name (host) resolved
+ *                before each connect attempt. With W5500_FAILOVER_ENABLE, a server
+ *                list (servers, server_cnt) instead: the connection fails over
+ *                between them, and with W5500_FAILOVER_STANDBY keeps a second
+ *                socket connected to the best other one. If `W5500_USER_NETWORK_CONFIG`
+ *                is set to `NO`, NULL selects the static configuration.
+ *
+ * @return The connection handle, or -1 if no connection slot or socket is free.
+ */
+W5500_Handle_t w5500_client_open (const W5500_Cnf_t* cfg) {
+  #if (W5500_USER_NETWORK_CONFIG==NO)
+  if (cfg == NULL) {
+    cfg = &STATIC_INFO;
+  }
+  #else
+  if (cfg == NULL) {
+    LOG_ERROR("W5500 :: NULL config");
+    return -1;
+  }
+  #endif
+  for (W5500_Handle_t h = 0; h < W5500_CLIENT_MAX_CONN; h++) {
+    if (conns[h].used) {
+      continue;
+    }
+    int8_t sn = w5500_client_allocSocket();
+    if (sn < 0) {
+      LOG_ERROR("W5500 :: No free socket");
+      return -1;
+    }
+    conns[h] = (W5500_Conn_t){0};
+    w5500_reconn_init(&conns[h].reconn, (uint8_t)sn, cfg->dest_ip, cfg->port);
+    conns[h].host = cfg->host;
+    #if (W5500_FAILOVER_ENABLE==YES)
+    if (cfg->servers != NULL) {
+      if (!w5500_failover_init(&conns[h].fo, cfg->servers, cfg->server_cnt)) {
+        LOG_ERROR("W5500 :: Bad server list");
+        w5500_client_freeSocket((uint8_t)sn);
+        return -1;
+      }
+      __w5500_client_useServer(&conns[h], conns[h].fo.cur);
+      #if (W5500_FAILOVER_STANDBY==YES)
+      conns[h].standby_idx = -1;
+      int8_t ssn = (cfg->server_cnt > 1) ? w5500_client_allocSocket() : -1;
+      if (ssn >= 0) {
+        conns[h].has_standby = true;
+        conns[h].standby.sn = (uint8_t)ssn;
+      }
+      else if (cfg->server_cnt > 1) {
+        LOG_WARNING("W5500 :: No socket for the standby");
+      }
+      #endif
+    }
+    #endif
+    conns[h].used = true;
+    LOG_TRACE("W5500 :: Connection %d on socket %d", h, sn);
+    return h;
+  }
+  LOG_ERROR("W5500 :: No free connection slot");
+  return -1;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Shut a socket down in the background and return it to the free pool.
+ *
+ * @param[in] sn Socket number.
+ */
+static void __w5500_client_release (uint8_t sn) {
+  // Set first: a shutdown that ends at once is reported from inside disconnect_async()
+  sock_releasing |= (1 << sn);
+  if (disconnect_async(sn, W5500_SHUTDOWN_LINGER_MS) == SOCK_BUSY) {
+    return;
+  }
+  sock_releasing &= ~(1 << sn);
+  close(sn);
+  w5500_client_freeSocket(sn);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Close a connection and release its handle.
+ *
+ * The connection is shut down gracefully in the background; its socket
+ * returns to the free pool when the shutdown ends.
+ *
+ * @param[in] h Connection handle.
+ */
+void w5500_client_close (W5500_Handle_t h) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return;
+  }
+  c->used = false;
+  __w5500_client_release(c->reconn.sn);
+  #if (W5500_FAILOVER_ENABLE==YES) && (W5500_FAILOVER_STANDBY==YES)
+  if (c->has_standby) {
+    __w5500_client_release(c->standby.sn);
+  }
+  #endif
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the hardware socket of a connection, e.g. for pollsocket().
+ *
+ * @param[in] h Connection handle.
+ *
+ * @return The socket number, or -1 if the handle is not open.
+ */
+int8_t w5500_client_getSocket (W5500_Handle_t h) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  return (c == NULL) ? -1 : (int8_t)c->reconn.sn;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Transmit data through a W5500 client connection.
  * 
  * This function sends `len` bytes of data from the provided buffer through
- * socket number 1. If the buffer is NULL or length is zero, no data is sent.
+ * the socket of the connection. If the buffer is NULL or length is zero, no data is sent.
  * 
+ * @param[in] h   Connection handle.
  * @param[in] buf Pointer to the buffer containing the data to send.
  * @param[in] len Number of bytes to send from the buffer.
  * 
  * @return The number of bytes actually sent on success.
- * @return -1 if sending failed.
+ * @return -1 if sending failed, the link is down or the handle is not open.
  * @return 0 if buf is NULL or len is zero (no data sent).
  */
-int32_t w5500_client_transmit (uint8_t* buf, uint16_t len) {
+int32_t w5500_client_transmit (W5500_Handle_t h, uint8_t* buf, uint16_t len) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return -1;
+  }
   if (buf == NULL || len == 0) {
     return 0;
   }
-  int32_t ret = send(1, buf, len);
+  if (!w5500_link_isUp()) {
+    // No cable, don't touch the chip
+    return -1;
+  }
+  int32_t ret = send(c->reconn.sn, buf, len);
   if (ret == SOCK_ERROR) {
     LOG_ERROR("W5500 :: Send failed");
     return -1;
@@ -183,132 +814,392 @@ int32_t w5500_client_transmit (uint8_t* buf, uint16_t len) {
 }
 //--------------------------------------------------------------------------
 /**
- * @brief Receive data from the W5500 client socket.
+ * @brief Transmit several buffers through a W5500 client connection as one send.
+ *
+ * The fragments (e.g. header, body and CRC) are written back-to-back into the
+ * chip TX memory and leave with a single SEND command, without concatenating
+ * them in MCU RAM first.
+ *
+ * @param[in] h   Connection handle.
+ * @param[in] iov Fragments to send in order.
+ * @param[in] cnt Number of fragments.
+ *
+ * @return The total number of bytes sent on success.
+ * @return -1 if sending failed, the link is down or the handle is not open.
+ * @return 0 if iov is NULL or cnt is zero (no data sent).
+ */
+int32_t w5500_client_transmitv (W5500_Handle_t h, wiz_IOVec* iov, uint8_t cnt) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return -1;
+  }
+  if (iov == NULL || cnt == 0) {
+    return 0;
+  }
+  if (!w5500_link_isUp()) {
+    // No cable, don't touch the chip
+    return -1;
+  }
+  int32_t ret = sendv(c->reconn.sn, iov, cnt);
+  if (ret < 0) {
+    LOG_ERROR("W5500 :: Send failed");
+    return -1;
+  }
+  return ret;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Reserve space in the chip TX memory of a client connection.
+ *
+ * The outgoing data is then written straight into the W5500 with
+ * w5500_client_tx_write() and sent with w5500_client_tx_commit(), so a
+ * message can be built piece by piece without staging it in MCU RAM.
+ *
+ * @param[in]  h   Connection handle.
+ * @param[in]  len Number of bytes to reserve.
+ * @param[out] win Reserved window.
+ *
+ * @return The number of bytes reserved on success.
+ * @return SOCK_BUSY if the socket is non-blocking and there is not enough free space.
+ * @return A negative SOCKERR_* code on failure, SOCKERR_SOCKNUM if the handle is not open.
+ */
+int32_t w5500_client_tx_reserve (W5500_Handle_t h, uint16_t len, wiz_TxWindow* win) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return SOCKERR_SOCKNUM;
+  }
+  int32_t ret = send_reserve(c->reconn.sn, len, win);
+  if (ret < 0) {
+    LOG_ERROR("W5500 :: TX reserve failed (%ld)", ret);
+  }
+  return ret;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Write data into a window reserved by w5500_client_tx_reserve().
+ *
+ * @param[in] h      Connection handle.
+ * @param[in] win    Reserved window.
+ * @param[in] offset Offset in the window.
+ * @param[in] buf    Pointer to the data.
+ * @param[in] len    Number of bytes to write.
+ *
+ * @return The number of bytes written, or a negative SOCKERR_* code.
+ */
+int32_t w5500_client_tx_write (W5500_Handle_t h, wiz_TxWindow* win, uint16_t offset, uint8_t* buf, uint16_t len) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return SOCKERR_SOCKNUM;
+  }
+  return send_write(c->reconn.sn, win, offset, buf, len);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Send the first `len` bytes of a reserved window.
+ *
+ * @param[in] h   Connection handle.
+ * @param[in] win Reserved window.
+ * @param[in] len Number of bytes to send, 0 cancels the reservation.
+ *
+ * @return The number of bytes sent on success.
+ * @return SOCK_BUSY if the previous send is still in progress; call again.
+ * @return A negative SOCKERR_* code on failure, SOCKERR_SOCKNUM if the handle is not open.
+ */
+int32_t w5500_client_tx_commit (W5500_Handle_t h, wiz_TxWindow* win, uint16_t len) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return SOCKERR_SOCKNUM;
+  }
+  int32_t ret = send_commit(c->reconn.sn, win, len);
+  if (ret < 0) {
+    LOG_ERROR("W5500 :: TX commit failed (%ld)", ret);
+  }
+  return ret;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Receive data from a W5500 client connection.
  *
- * This function attempts to read up to `len` bytes of data from the W5500 socket
- * into the provided buffer. It first checks if data is available before attempting
- * to receive. If no data is available or an error occurs, it returns 0.
+ * This function reads up to `len` bytes of the data already received by the W5500
+ * socket into the provided buffer, in one register snapshot and one data burst.
+ * If no data is available or an error occurs, it returns 0.
  *
+ * @param[in]  h   Connection handle.
  * @param[out] buf Pointer to the buffer where received data will be stored.
  * @param[in] len Maximum number of bytes to receive.
  *
  * @return The number of bytes actually received, or 0 if no data is available or an error occurred.
  *
- * @note Socket number 1 is used in this function.
  * @note Ensure the buffer has enough space for `len` bytes.
  */
-uint16_t w5500_client_receive (uint8_t* buf, uint16_t len) {
-  if (buf == NULL || len == 0) {
+uint16_t w5500_client_receive (W5500_Handle_t h, uint8_t* buf, uint16_t len) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL || buf == NULL || len == 0) {
+    return 0;
+  }
+  int32_t ret = recv_avail(c->reconn.sn, buf, len);
+  if (ret == SOCK_BUSY) {
+    // No data
+    return 0;
+  }
+  if (ret < 0) {
+    LOG_ERROR("W5500 :: Receive failed (%ld)", ret);
+    return 0;
+  }
+  return (uint16_t)ret;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Look at the data received by a W5500 client connection in place.
+ *
+ * The callback gets a view of everything waiting in the chip RX memory,
+ * reads what it needs with stream_read() and returns the number of bytes
+ * it consumed; they are released with one RECV command. The rest stays in
+ * the chip for the next call, so a message that arrived in part needs no
+ * buffering in MCU RAM.
+ *
+ * @param[in] h   Connection handle.
+ * @param[in] cb  Callback called once if data is waiting.
+ * @param[in] arg User argument passed to cb.
+ *
+ * @return The number of bytes consumed, 0 if none (no data or nothing consumed).
+ * @return -1 if the receive failed or the handle is not open.
+ */
+int32_t w5500_client_receive_view (W5500_Handle_t h, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL || cb == NULL) {
+    return -1;
+  }
+  int32_t ret = recv_view(c->reconn.sn, cb, arg);
+  if (ret == SOCK_BUSY) {
+    // No data
+    return 0;
+  }
+  if (ret < 0) {
+    LOG_ERROR("W5500 :: Receive failed (%ld)", ret);
+    return -1;
+  }
+  return ret;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Receive data from a W5500 client connection, waiting up to timeout_ms.
+ *
+ * The caller sleeps while the server is silent instead of polling the chip:
+ * on the socket interrupt when INTn is wired, on a growing backoff otherwise.
+ *
+ * @param[in]  h          Connection handle.
+ * @param[out] buf        Pointer to the buffer where received data will be stored.
+ * @param[in]  len        Maximum number of bytes to receive.
+ * @param[in]  timeout_ms Maximum time to wait for data.
+ *
+ * @return The number of bytes actually received, or 0 on timeout or error.
+ */
+uint16_t w5500_client_receive_timeout (W5500_Handle_t h, uint8_t* buf, uint16_t len, uint32_t timeout_ms) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL || buf == NULL || len == 0) {
     return 0;
   }
-  int32_t rx_size = getSn_RX_RSR(1);
-  if (rx_size <= 0) {
-    // No data or error
+  int32_t ret = recv_timeout(c->reconn.sn, buf, len, timeout_ms);
+  if (ret == SOCKERR_TIMEOUT || ret == SOCK_BUSY) {
     return 0;
   }
-  uint16_t to_read = (len < rx_size) ? len : (uint16_t)rx_size;
-  int32_t ret = recv(1, buf, to_read);
-  if (ret == SOCK_ERROR || ret <= 0) {
-    LOG_ERROR("W5500 :: Receive failed");
+  if (ret < 0) {
+    LOG_ERROR("W5500 :: Receive failed (%ld)", ret);
     return 0;
   }
   return (uint16_t)ret;
 }
 //--------------------------------------------------------------------------
 /**
- * @brief Check if the W5500 client socket is connected.
+ * @brief Check if a W5500 client connection is established.
  * 
- * This function checks the status of socket number 1 and returns whether
- * it is currently in the established (connected) state.
+ * This function checks the status of the connection socket and returns whether
+ * it is currently in the established (connected) state. A connection found
+ * lost (e.g. by keep-alive timeout) is reported to the disconnect hook here.
  * 
+ * @param[in] h Connection handle.
+ *
  * @return true if the socket is connected, false otherwise.
  */
-bool w5500_client_is_connected (void) {
-  // check socket 1 status
-  uint8_t status = getSn_SR(1);  
-  return (status == SOCK_ESTABLISHED);
+bool w5500_client_is_connected (W5500_Handle_t h) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  return (c != NULL && w5500_link_isUp() && socket_check(c->reconn.sn) == SOCK_ESTABLISHED);
 }
 //--------------------------------------------------------------------------
 /**
- * @brief Attempt to reconnect the W5500 client socket to the server.
+ * @brief Keep a W5500 client connection up without blocking.
  *
- * This function checks the LAN cable status, socket status, and if not connected,
- * closes the socket if needed, recreates it, and tries to reconnect to the server
- * specified in the given network configuration.
+ * Advances the reconnect state machine by one step: a lost connection is
+ * retried with exponential backoff and jitter, immediately when the LAN
+ * cable comes back. The CONNECT handshake is checked on the following
+ * calls, so other sockets keep being served meanwhile. A connection opened
+ * by host name is held down until the name resolves. A connection with a
+ * server list moves to the best other server after W5500_FAILOVER_FAILS
+ * failures in a row, or to its standby at once.
  *
- * @param[in] INFO Pointer to a W5500_Cnf_t structure with network configuration.
- *                 If `W5500_USER_NETWORK_CONFIG` is set to `NO`, this parameter is ignored.
+ * @param[in] h Connection handle.
  *
- * @return true if the socket is already connected or reconnect was successful.
- * @return false if any step fails (cable disconnected, socket creation failure, or connection failure).
- *
- * @note Uses socket number 1 for connection.
- * @warning Ensure valid network configuration is provided if `W5500_USER_NETWORK_CONFIG` is enabled.
+ * @return true if the connection is established.
+ * @return false while it is down or being established, or if the handle is not open.
  */
-bool w5500_client_reconnect (const W5500_Cnf_t* INFO) {
-  #if (W5500_USER_NETWORK_CONFIG==NO)
-  INFO = &STATIC_INFO;
-  #else 
-  if (INFO == NULL) {
-    LOG_ERROR("W5500 :: NULL config");
+bool w5500_client_reconnect (W5500_Handle_t h) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
     return false;
   }
-  #endif
-  if (!w5500_cable_getStatus(1, 0)) {
-    LOG_ERROR("W5500 :: Cable disconnect");
+  if (c->restart) {
+    c->restart = false;
+    w5500_reconn_restart(&c->reconn);
+  }
+  W5500_ReconnState_t prev = c->reconn.state;
+  #if (W5500_DHCP_ENABLE==YES)
+  // No address to connect from yet
+  if (prev == W5500_RECONN_DOWN && w5500_dhcp_getState() != W5500_DHCP_STOPPED && !w5500_dhcp_isBound()) {
     return false;
   }
-  uint8_t status = getSn_SR(1);
-  if (status == SOCK_ESTABLISHED) {
-    // Already connected
-    return true;
+  #endif
+  #if (W5500_DNS_ENABLE==YES)
+  // Answered by the cache within the TTL, so a reconnect storm asks the server once
+  if (prev == W5500_RECONN_DOWN && c->host != NULL && w5500_dns_resolve(c->host, c->reconn.dest_ip) != W5500_DNS_OK) {
+    return false;
   }
-  // If socket is not closed, close it first
-  if (status != SOCK_CLOSED) {
-    close(1);
+  #endif
+  #if (W5500_FAILOVER_ENABLE==YES)
+  uint32_t fails = c->reconn.stat.failures;
+  #endif
+  W5500_ReconnState_t st = w5500_reconn_process(&c->reconn);
+  #if (W5500_FAILOVER_ENABLE==YES)
+  if (c->fo.cnt != 0) {
+    st = __w5500_client_failover(c, prev, fails);
   }
-  // Create socket again
-  if (socket(1, Sn_MR_TCP, 0, 0) != 1) {
-    LOG_ERROR("W5500 :: Failed to create socket");
+  #endif
+  if (st != W5500_RECONN_UP) {
     return false;
   }
-  // Attempt to connect to the server
-  if (connect(1, (uint8_t*)INFO->dest_ip, INFO->port) != SOCK_OK) {
-    LOG_ERROR("W5500 :: Connect attempt failed");
-    return false;
+  if (prev != W5500_RECONN_UP) {
+    #if (W5500_RETX_ADAPTIVE==YES)
+    // The handshake is checked once per call, so it bounds the RTT from above
+    if (prev == W5500_RECONN_CONNECTING) {
+      w5500_retx_sample(c->reconn.stat.last_handshake_us, false);
+    }
+    #endif
+    __w5500_client_keepalive(c->reconn.sn);
+    if (boot.first_conn_ms == 0) {
+      boot.first_conn_ms = (W5500_GetMicros() - boot_ts) / 1000;
+      LOG_INFO("W5500 :: First connection %lu ms after the start", boot.first_conn_ms);
+    }
+    LOG_TRACE("W5500 :: Connection %d established", h);
   }
-  LOG_TRACE("W5500 :: Connected successfully");
   return true;
 }
 //--------------------------------------------------------------------------
 /**
- * @brief Disconnect and close the W5500 client socket with a timeout.
+ * @brief Disconnect a W5500 client connection with a timeout.
  *
- * This function attempts to gracefully disconnect the socket number 1 and waits
- * until the socket status changes to closed or the specified timeout expires.
- * If the socket does not close within the timeout, it forces the socket to close.
+ * This function gracefully shuts down the socket of the connection (pending data is
+ * delivered, then FIN is sent) and waits until it is closed. If the socket
+ * does not close within the timeout, it forces the socket to close.
+ * The handle stays open, w5500_client_reconnect() connects it again.
  *
+ * @param[in] h          Connection handle.
  * @param[in] timeout_ms Maximum time in milliseconds to wait for the socket to close.
  *
  * @return true if the socket is closed successfully; false otherwise.
  *
  */
-bool w5500_client_disconnect (uint32_t timeout_ms) {
-  uint8_t status = getSn_SR(1);
-  // Already closed
-  if (status == SOCK_CLOSED) {
-      return true;
+bool w5500_client_disconnect (W5500_Handle_t h, uint32_t timeout_ms) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c == NULL) {
+    return false;
   }
-  disconnect(1);
-  uint32_t elapsed = 0;
-  while (getSn_SR(1) != SOCK_CLOSED && elapsed < timeout_ms) {
-    W5500_Delay(10);
-    elapsed += 10;
+  if (disconnect_async(c->reconn.sn, timeout_ms) == SOCK_BUSY) {
+    // Every shutdown in progress ends by its linger deadline at the latest
+    while (disconnect_process() > 0) {
+      W5500_Delay(1);
+    }
+  }
+  return (getSn_SR(c->reconn.sn) == SOCK_CLOSED);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Start a graceful shutdown of a W5500 client connection and return at once.
+ *
+ * The shutdown is advanced by disconnect_process() from the service loop and
+ * falls back to close() after W5500_SHUTDOWN_LINGER_MS.
+ *
+ * @param[in] h Connection handle.
+ *
+ * @return true if the socket is already closed; false while the shutdown is in progress.
+ */
+bool w5500_client_shutdown (W5500_Handle_t h) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  return (c == NULL || disconnect_async(c->reconn.sn, W5500_SHUTDOWN_LINGER_MS) == SOCK_OK);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the connection loss statistics of a client connection.
+ *
+ * @param[in]  h   Connection handle.
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_client_getDisconStat (W5500_Handle_t h, W5500_DisconStat_t* out) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c != NULL && out != NULL) {
+    *out = c->discon;
   }
-  // If still not closed, force close
-  if (getSn_SR(1) != SOCK_CLOSED) {
-    close(1);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the reconnect statistics of a client connection.
+ *
+ * @param[in]  h   Connection handle.
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_client_getReconnStat (W5500_Handle_t h, W5500_ReconnStat_t* out) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c != NULL) {
+    w5500_reconn_getStat(&c->reconn, out);
+  }
+}
+#if (W5500_FAILOVER_ENABLE==YES)
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the failover statistics of a client connection.
+ *
+ * @param[in]  h   Connection handle.
+ * @param[out] out Pointer to the structure to fill, zero without a server list.
+ */
+void w5500_client_getFailoverStat (W5500_Handle_t h, W5500_FailoverStat_t* out) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  if (c != NULL) {
+    w5500_failover_getStat(&c->fo, out);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the health of a server of a client connection.
+ *
+ * @param[in]  h   Connection handle.
+ * @param[in]  idx Server index in the list given to w5500_client_open().
+ * @param[out] out Pointer to the structure to fill.
+ *
+ * @return false if the handle is not open or there is no such server.
+ */
+bool w5500_client_getServerHealth (W5500_Handle_t h, uint8_t idx, W5500_ServerHealth_t* out) {
+  W5500_Conn_t* c = __w5500_client_conn(h);
+  return (c != NULL && w5500_failover_getHealth(&c->fo, idx, out));
+}
+#endif
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the start-up timing of the client.
+ *
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_client_getBootStat (W5500_BootStat_t* out) {
+  if (out != NULL) {
+    *out = boot;
   }
-  return (getSn_SR(1) == SOCK_CLOSED);
 }
 //--------------------------------------------------------------------------
@@ -0,0 +1,701 @@
+/**
+ * @file w5500_dhcp.c
+ * @brief Non-blocking DHCP client of the W5500.
+ *
+ * RFC 2131 client on a UDP socket (port 68), run as a state machine by
+ * w5500_dhcp_process() from the service loop: it never waits for a reply,
+ * each call reads what arrived and sends what is due. DISCOVER and REQUEST
+ * are retransmitted after W5500_DHCP_RETRY_MS, doubling up to
+ * W5500_DHCP_RETRY_MAX_MS, +/- 1 s. A lease is renewed with the server at
+ * T1 and with any server at T2, and given up when it expires.
+ *
+ * The lease is handed to an optional store (W5500_DhcpStore_t). On the next
+ * start the stored lease is confirmed with INIT-REBOOT, one REQUEST and its
+ * ACK, instead of the DISCOVER/OFFER/REQUEST/ACK cycle. The same is done
+ * when the link comes back, since the cable may now be in another network.
+ *
+ * Requests leave in the asynchronous send mode on a socket context of the
+ * client's own, so a renewal to a server gone from the LAN never blocks.
+ * Lease timers run on a seconds clock built from W5500_GetMicros(), which
+ * only has to be called more often than the microsecond counter wraps.
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_dhcp.h"
+#include "w5500_link.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_DHCP_ENABLE==YES)
+
+#if (W5500_DHCP_RETRY_MS < 2000) || (W5500_DHCP_RETRY_MS > W5500_DHCP_RETRY_MAX_MS)
+#error "W5500_DHCP_RETRY_MS/W5500_DHCP_RETRY_MAX_MS invalid"
+#endif
+
+#define DHCP_SERVER_PORT              67
+#define DHCP_CLIENT_PORT              68
+#define DHCP_BOOTREQUEST              1
+#define DHCP_BOOTREPLY                2
+#define DHCP_HTYPE_ETHERNET           1
+#define DHCP_FLAG_BROADCAST           0x80
+#define DHCP_COOKIE_OFFSET            236     // Fixed fields before the magic cookie
+#define DHCP_OPTIONS_OFFSET           240
+#define DHCP_MSG_SIZE                 548     // Largest message a client must accept (576 - IP/UDP headers)
+#define DHCP_REQUEST_TRIES            4       // REQUEST for an OFFER before starting over
+#define DHCP_REBOOT_TRIES             2       // INIT-REBOOT REQUEST before falling back
+#define DHCP_RENEW_MIN_S              60      // Shortest wait between two REQUEST when renewing
+#define DHCP_JITTER_MS                1000
+#define DHCP_INFINITE                 0xFFFFFFFF
+
+#define DHCP_DISCOVER                 1
+#define DHCP_OFFER                    2
+#define DHCP_REQUEST                  3
+#define DHCP_ACK                      5
+#define DHCP_NAK                      6
+
+#define DHCP_OPT_PAD                  0
+#define DHCP_OPT_SUBNET               1
+#define DHCP_OPT_ROUTER               3
+#define DHCP_OPT_DNS                  6
+#define DHCP_OPT_HOSTNAME             12
+#define DHCP_OPT_REQUESTED_IP         50
+#define DHCP_OPT_LEASE_TIME           51
+#define DHCP_OPT_MSG_TYPE             53
+#define DHCP_OPT_SERVER_ID            54
+#define DHCP_OPT_PARAM_LIST           55
+#define DHCP_OPT_T1                   58
+#define DHCP_OPT_T2                   59
+#define DHCP_OPT_CLIENT_ID            61
+#define DHCP_OPT_END                  255
+
+static const uint8_t cookie[4] = {99, 130, 83, 99};
+static const uint8_t broadcast[4] = {255, 255, 255, 255};
+
+static wiz_SockCtx dhcp_ctx;
+static uint8_t dhcp_sn;
+static bool opened = false;
+static bool applied;                  // The lease address is on the chip
+static bool link;
+static const W5500_DhcpStore_t* store = NULL;
+static void (*callback)(W5500_DhcpEvent_t ev, const W5500_DhcpLease_t* lease) = NULL;
+static W5500_DhcpState_t state = W5500_DHCP_STOPPED;
+static W5500_DhcpLease_t lease;       // Lease in use, or the one being requested
+static W5500_DhcpStat_t stat;
+static uint8_t msg[DHCP_MSG_SIZE];
+static uint32_t xid;
+static uint8_t tries;
+static uint32_t retry_ms;
+static uint32_t next_ts;              // Next transmission of DISCOVER/REQUEST (us)
+static uint32_t acquire_ts;           // Start of the acquisition (us)
+static uint32_t clock_s;              // Seconds clock of the lease timers
+static uint32_t clock_us;
+static uint32_t clock_ts;
+static uint32_t start_s;              // Start of the exchange, for the secs field
+static uint32_t request_s;            // Last REQUEST sent, the lease counts from it
+static uint32_t bound_s;              // REQUEST the lease in use was granted for
+static uint32_t next_s;               // Next REQUEST when renewing or rebinding
+static uint32_t rand_state;
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Next value of a xorshift32 generator.
+ */
+static uint32_t __w5500_dhcp_rand (void) {
+  rand_state ^= rand_state << 13;
+  rand_state ^= rand_state >> 17;
+  rand_state ^= rand_state << 5;
+  return rand_state;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Read a big-endian 32-bit value.
+ */
+static uint32_t __w5500_dhcp_get32 (const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Copy n bytes.
+ */
+static void __w5500_dhcp_copy (uint8_t* dst, const uint8_t* src, uint8_t n) {
+  while (n-- > 0) {
+    *dst++ = *src++;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Compare n bytes.
+ *
+ * @return true if they are equal.
+ */
+static bool __w5500_dhcp_equal (const uint8_t* a, const uint8_t* b, uint8_t n) {
+  while (n-- > 0) {
+    if (*a++ != *b++) {
+      return false;
+    }
+  }
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Advance the seconds clock.
+ *
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_dhcp_tick (uint32_t now) {
+  clock_us += now - clock_ts;
+  clock_ts = now;
+  while (clock_us >= 1000000) {
+    clock_us -= 1000000;
+    clock_s++;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Write the address of the lease to the chip, or clear it.
+ *
+ * Only what changed is written, a renewal of the same lease writes nothing.
+ * The connections a new address or route breaks are aborted.
+ *
+ * @param[in] on true to apply the lease, false to clear the address.
+ */
+static void __w5500_dhcp_apply (bool on) {
+  wiz_NetInfo prev;
+  wiz_NetInfo info;
+  ctlnetwork(CN_GET_NETINFO, (void*)&prev);
+  info = prev;
+  for (uint8_t i = 0; i < 4; i++) {
+    info.ip[i] = on ? lease.ip[i] : 0;
+    if (on) {
+      info.sn[i] = lease.sn[i];
+      info.gw[i] = lease.gw[i];
+    }
+  }
+  if (on && (lease.dns[0] | lease.dns[1] | lease.dns[2] | lease.dns[3]) != 0) {
+    __w5500_dhcp_copy(info.dns, lease.dns, 4);
+  }
+  info.dhcp = NETINFO_DHCP;
+  uint8_t chg = (uint8_t)ctlnetwork(CN_UPDATE_NETINFO, (void*)&info);
+  if (chg & (NETINFO_CHG_GW | NETINFO_CHG_SN | NETINFO_CHG_IP)) {
+    socket_netchange(&prev, &info);
+  }
+  applied = on;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Enter a state that exchanges messages with the server.
+ *
+ * The first message is sent by the next step.
+ *
+ * @param[in] st  SELECTING, REQUESTING or REBOOTING.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_dhcp_start (W5500_DhcpState_t st, uint32_t now) {
+  if (st != W5500_DHCP_REQUESTING) {
+    // REQUEST for an OFFER keeps the transaction of the DISCOVER
+    xid = __w5500_dhcp_rand();
+    start_s = clock_s;
+    acquire_ts = now;
+  }
+  state = st;
+  tries = 0;
+  retry_ms = W5500_DHCP_RETRY_MS;
+  next_ts = now;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Give the lease up and start over.
+ *
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_dhcp_lose (uint32_t now) {
+  __w5500_dhcp_start(W5500_DHCP_SELECTING, now);
+  if (!applied) {
+    return;
+  }
+  stat.losses++;
+  __w5500_dhcp_apply(false);
+  LOG_WARNING("W5500 :: DHCP lease lost");
+  if (callback != NULL) {
+    callback(W5500_DHCP_EV_LOST, &lease);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Build and send a DISCOVER or REQUEST for the current state.
+ *
+ * The address is requested (option 50) when selecting and rebooting, and
+ * carried in ciaddr when renewing and rebinding, as RFC 2131 4.3.2 asks.
+ *
+ * @param[in] type DHCP_DISCOVER or DHCP_REQUEST.
+ *
+ * @return true if the message left or failed for good, false if the socket is busy.
+ */
+static bool __w5500_dhcp_send (uint8_t type) {
+  static const uint8_t params[] = {DHCP_OPT_SUBNET, DHCP_OPT_ROUTER, DHCP_OPT_DNS,
+                                   DHCP_OPT_LEASE_TIME, DHCP_OPT_T1, DHCP_OPT_T2};
+  const char* host = W5500_DHCP_HOSTNAME;
+  bool own = (state == W5500_DHCP_RENEWING || state == W5500_DHCP_REBINDING);
+  uint32_t secs = clock_s - start_s;
+  uint16_t p;
+  for (p = 0; p < DHCP_OPTIONS_OFFSET; p++) {
+    msg[p] = 0;
+  }
+  msg[0] = DHCP_BOOTREQUEST;
+  msg[1] = DHCP_HTYPE_ETHERNET;
+  msg[2] = 6;
+  msg[4] = (uint8_t)(xid >> 24);
+  msg[5] = (uint8_t)(xid >> 16);
+  msg[6] = (uint8_t)(xid >> 8);
+  msg[7] = (uint8_t)xid;
+  msg[8] = (secs > 0xFFFF) ? 0xFF : (uint8_t)(secs >> 8);
+  msg[9] = (secs > 0xFFFF) ? 0xFF : (uint8_t)secs;
+  // Without an address the chip only takes the broadcast reply
+  msg[10] = own ? 0 : DHCP_FLAG_BROADCAST;
+  if (own) {
+    __w5500_dhcp_copy(&msg[12], lease.ip, 4);
+  }
+  __w5500_dhcp_copy(&msg[28], lease.mac, 6);
+  __w5500_dhcp_copy(&msg[DHCP_COOKIE_OFFSET], cookie, 4);
+  msg[p++] = DHCP_OPT_MSG_TYPE;
+  msg[p++] = 1;
+  msg[p++] = type;
+  msg[p++] = DHCP_OPT_CLIENT_ID;
+  msg[p++] = 7;
+  msg[p++] = DHCP_HTYPE_ETHERNET;
+  __w5500_dhcp_copy(&msg[p], lease.mac, 6);
+  p += 6;
+  if (type == DHCP_REQUEST && !own) {
+    msg[p++] = DHCP_OPT_REQUESTED_IP;
+    msg[p++] = 4;
+    __w5500_dhcp_copy(&msg[p], lease.ip, 4);
+    p += 4;
+  }
+  if (type == DHCP_REQUEST && state == W5500_DHCP_REQUESTING) {
+    msg[p++] = DHCP_OPT_SERVER_ID;
+    msg[p++] = 4;
+    __w5500_dhcp_copy(&msg[p], lease.server, 4);
+    p += 4;
+  }
+  if (host[0] != '\0') {
+    uint8_t n = 0;
+    while (host[n] != '\0' && n < 32) {
+      n++;
+    }
+    msg[p++] = DHCP_OPT_HOSTNAME;
+    msg[p++] = n;
+    __w5500_dhcp_copy(&msg[p], (const uint8_t*)host, n);
+    p += n;
+  }
+  msg[p++] = DHCP_OPT_PARAM_LIST;
+  msg[p++] = sizeof(params);
+  __w5500_dhcp_copy(&msg[p], params, sizeof(params));
+  p += sizeof(params);
+  msg[p++] = DHCP_OPT_END;
+  uint8_t* dst = (state == W5500_DHCP_RENEWING) ? lease.server : (uint8_t*)broadcast;
+  int32_t ret = sendto_ctx(&dhcp_ctx, dhcp_sn, msg, p, dst, DHCP_SERVER_PORT, 4);
+  if (ret == SOCK_BUSY) {
+    return false;
+  }
+  if (ret < 0) {
+    // Left nothing on the wire (e.g. server cached unreachable), the retransmission covers it
+    LOG_WARNING("W5500 :: DHCP send failed (%ld)", ret);
+  }
+  if (type == DHCP_DISCOVER) {
+    stat.discovers++;
+  }
+  else {
+    stat.requests++;
+    request_s = clock_s;
+  }
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Send the message of an acquisition state when it is due.
+ *
+ * @param[in] type DHCP_DISCOVER or DHCP_REQUEST.
+ * @param[in] now  Current time in microseconds.
+ */
+static void __w5500_dhcp_retransmit (uint8_t type, uint32_t now) {
+  if (!__w5500_dhcp_send(type)) {
+    return;
+  }
+  if (tries > 0) {
+    stat.timeouts++;
+  }
+  tries++;
+  next_ts = now + (retry_ms - DHCP_JITTER_MS + __w5500_dhcp_rand() % (2 * DHCP_JITTER_MS + 1)) * 1000;
+  retry_ms = (retry_ms > W5500_DHCP_RETRY_MAX_MS / 2) ? W5500_DHCP_RETRY_MAX_MS : (retry_ms << 1);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Take the lease of an ACK into use.
+ *
+ * @param[in] l   Lease granted.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_dhcp_bind (const W5500_DhcpLease_t* l, uint32_t now) {
+  bool renewed = applied && __w5500_dhcp_equal(l->ip, lease.ip, 4);
+  bool changed = !__w5500_dhcp_equal((const uint8_t*)l, (const uint8_t*)&lease, sizeof(lease));
+  stat.acks++;
+  if (state == W5500_DHCP_REBOOTING) {
+    stat.reboots++;
+  }
+  if (!renewed) {
+    stat.last_acquire_ms = (now - acquire_ts) / 1000;
+  }
+  lease = *l;
+  bound_s = request_s;
+  state = W5500_DHCP_BOUND;
+  __w5500_dhcp_apply(true);
+  if (changed && store != NULL && store->save != NULL) {
+    store->save(&lease);
+  }
+  if (renewed) {
+    LOG_TRACE("W5500 :: DHCP lease renewed for %lu s", lease.lease_s);
+  }
+  else {
+    LOG_INFO("W5500 :: DHCP address %u.%u.%u.%u for %lu s, in %lu ms", lease.ip[0], lease.ip[1],
+             lease.ip[2], lease.ip[3], lease.lease_s, stat.last_acquire_ms);
+  }
+  if (callback != NULL) {
+    callback(renewed ? W5500_DHCP_EV_RENEWED : W5500_DHCP_EV_BOUND, &lease);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Handle a reply of a server, sitting in msg.
+ *
+ * @param[in] len Length of the reply.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_dhcp_input (uint16_t len, uint32_t now) {
+  W5500_DhcpLease_t l = {0};
+  uint8_t type = 0;
+  if (len < DHCP_OPTIONS_OFFSET || msg[0] != DHCP_BOOTREPLY || __w5500_dhcp_get32(&msg[4]) != xid ||
+      !__w5500_dhcp_equal(&msg[28], lease.mac, 6) || !__w5500_dhcp_equal(&msg[DHCP_COOKIE_OFFSET], cookie, 4)) {
+    return;
+  }
+  __w5500_dhcp_copy(l.mac, lease.mac, 6);
+  __w5500_dhcp_copy(l.ip, &msg[16], 4);
+  for (uint16_t p = DHCP_OPTIONS_OFFSET; p < len; ) {
+    uint8_t code = msg[p];
+    if (code == DHCP_OPT_PAD) {
+      p++;
+      continue;
+    }
+    if (code == DHCP_OPT_END || p + 2 > len || p + 2 + msg[p + 1] > len) {
+      break;
+    }
+    uint8_t n = msg[p + 1];
+    const uint8_t* v = &msg[p + 2];
+    switch (code) {
+      case DHCP_OPT_MSG_TYPE:   if (n >= 1) type = v[0];                                break;
+      case DHCP_OPT_SUBNET:     if (n >= 4) __w5500_dhcp_copy(l.sn, v, 4);              break;
+      case DHCP_OPT_ROUTER:     if (n >= 4) __w5500_dhcp_copy(l.gw, v, 4);              break;
+      case DHCP_OPT_DNS:        if (n >= 4) __w5500_dhcp_copy(l.dns, v, 4);             break;
+      case DHCP_OPT_SERVER_ID:  if (n >= 4) __w5500_dhcp_copy(l.server, v, 4);          break;
+      case DHCP_OPT_LEASE_TIME: if (n >= 4) l.lease_s = __w5500_dhcp_get32(v);          break;
+      case DHCP_OPT_T1:         if (n >= 4) l.t1_s = __w5500_dhcp_get32(v);             break;
+      case DHCP_OPT_T2:         if (n >= 4) l.t2_s = __w5500_dhcp_get32(v);             break;
+      default:                                                                          break;
+    }
+    p += 2 + n;
+  }
+  switch (type) {
+    case DHCP_OFFER:
+      if (state != W5500_DHCP_SELECTING || (l.ip[0] | l.ip[1] | l.ip[2] | l.ip[3]) == 0) {
+        break;
+      }
+      stat.offers++;
+      __w5500_dhcp_copy(lease.ip, l.ip, 4);
+      __w5500_dhcp_copy(lease.server, l.server, 4);
+      __w5500_dhcp_start(W5500_DHCP_REQUESTING, now);
+      break;
+    case DHCP_ACK:
+      if (state < W5500_DHCP_REQUESTING || state == W5500_DHCP_BOUND || l.lease_s == 0) {
+        break;
+      }
+      if ((l.server[0] | l.server[1] | l.server[2] | l.server[3]) == 0) {
+        __w5500_dhcp_copy(l.server, lease.server, 4);
+      }
+      if (l.lease_s != DHCP_INFINITE && (l.t2_s == 0 || l.t2_s > l.lease_s)) {
+        l.t2_s = l.lease_s - (l.lease_s >> 3);
+      }
+      if (l.lease_s != DHCP_INFINITE && (l.t1_s == 0 || l.t1_s > l.t2_s)) {
+        l.t1_s = l.lease_s >> 1;
+      }
+      __w5500_dhcp_bind(&l, now);
+      break;
+    case DHCP_NAK:
+      if (state < W5500_DHCP_REQUESTING || state == W5500_DHCP_BOUND) {
+        break;
+      }
+      stat.naks++;
+      LOG_WARNING("W5500 :: DHCP request refused");
+      __w5500_dhcp_lose(now);
+      break;
+    default:
+      break;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Read all pending replies.
+ *
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_dhcp_receive (uint32_t now) {
+  uint8_t ip[4];
+  uint16_t port;
+  uint8_t alen;
+  uint16_t rem;
+  int32_t ret;
+  while ((ret = recvfrom_ctx(&dhcp_ctx, dhcp_sn, msg, sizeof(msg), ip, &port, &alen)) > 0) {
+    // Drop the rest of a longer packet, the options past DHCP_MSG_SIZE with it
+    uint16_t len = (uint16_t)ret;
+    while (getsockopt_ctx(&dhcp_ctx, dhcp_sn, SO_REMAINSIZE, &rem) == SOCK_OK && rem != 0) {
+      uint8_t tmp[16];
+      recvfrom_ctx(&dhcp_ctx, dhcp_sn, tmp, sizeof(tmp), ip, &port, &alen);
+    }
+    if (port == DHCP_SERVER_PORT) {
+      __w5500_dhcp_input(len, now);
+    }
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Set the non-volatile store of the lease.
+ *
+ * Call before w5500_dhcp_init() for the stored lease to be tried first.
+ *
+ * @param[in] s Store, NULL for none. It must stay valid.
+ */
+void w5500_dhcp_setStore (const W5500_DhcpStore_t* s) {
+  store = s;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Open the DHCP socket and start acquiring an address.
+ *
+ * The address of the chip is cleared until a lease is granted. A lease
+ * found in the store for the same MAC is confirmed with INIT-REBOOT.
+ *
+ * @param[in] sn  Free socket for the client.
+ * @param[in] mac MAC address of the chip.
+ *
+ * @return true if the socket is open.
+ */
+bool w5500_dhcp_init (uint8_t sn, const uint8_t mac[6]) {
+  uint8_t mode = SOCK_SEND_ASYNC;
+  uint32_t now = W5500_GetMicros();
+  W5500_DhcpLease_t stored;
+  socket_ctx_init(&dhcp_ctx, socket_ctx_default()->chip);
+  dhcp_ctx.poll_wait = socket_ctx_default()->poll_wait;
+  opened = false;
+  state = W5500_DHCP_STOPPED;
+  stat = (W5500_DhcpStat_t){0};
+  lease = (W5500_DhcpLease_t){0};
+  __w5500_dhcp_copy(lease.mac, mac, 6);
+  // Devices powered up together draw different transaction IDs
+  rand_state = now ^ __w5500_dhcp_get32(&mac[2]);
+  if (rand_state == 0) {
+    rand_state = 1;
+  }
+  clock_s = 0;
+  clock_us = 0;
+  clock_ts = now;
+  link = w5500_link_isUp();
+  __w5500_dhcp_apply(false);
+  if (socket_ctx(&dhcp_ctx, sn, Sn_MR_UDP, DHCP_CLIENT_PORT, SF_IO_NONBLOCK) != sn) {
+    LOG_ERROR("W5500 :: Failed to open the DHCP socket");
+    return false;
+  }
+  ctlsocket_ctx(&dhcp_ctx, sn, CS_SET_SENDMODE, &mode);
+  dhcp_sn = sn;
+  opened = true;
+  if (store != NULL && store->load != NULL && store->load(&stored) &&
+      __w5500_dhcp_equal(stored.mac, mac, 6) && (stored.ip[0] | stored.ip[1] | stored.ip[2] | stored.ip[3]) != 0) {
+    lease = stored;
+    __w5500_dhcp_start(W5500_DHCP_REBOOTING, now);
+  }
+  else {
+    __w5500_dhcp_start(W5500_DHCP_SELECTING, now);
+  }
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Stop the client and close its socket.
+ *
+ * The address in use stays on the chip, the lease is not renewed any more.
+ */
+void w5500_dhcp_stop (void) {
+  if (opened) {
+    close_ctx(&dhcp_ctx, dhcp_sn);
+  }
+  opened = false;
+  state = W5500_DHCP_STOPPED;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Run the client: handle the replies and send what is due.
+ *
+ * Never blocks. Call it from the service loop after w5500_link_process();
+ * the call rate bounds the reply handling delay.
+ */
+void w5500_dhcp_process (void) {
+  wiz_SendEvent ev;
+  if (!opened) {
+    return;
+  }
+  uint32_t now = W5500_GetMicros();
+  __w5500_dhcp_tick(now);
+  while (sendcompletion_ctx(&dhcp_ctx, &ev) == SOCK_OK) {
+  }
+  bool up = w5500_link_isUp();
+  if (up && !link && applied) {
+    // The cable may be in another network now: confirm the address, it stays in use meanwhile
+    __w5500_dhcp_start(W5500_DHCP_REBOOTING, now);
+  }
+  link = up;
+  uint32_t held = clock_s - bound_s;
+  if (applied && lease.lease_s != DHCP_INFINITE && held >= lease.lease_s) {
+    LOG_WARNING("W5500 :: DHCP lease expired");
+    __w5500_dhcp_lose(now);
+  }
+  if (!up) {
+    return;
+  }
+  __w5500_dhcp_receive(now);
+  bool due = (int32_t)(now - next_ts) >= 0;
+  switch (state) {
+    case W5500_DHCP_SELECTING:
+      if (due) {
+        __w5500_dhcp_retransmit(DHCP_DISCOVER, now);
+      }
+      break;
+    case W5500_DHCP_REQUESTING:
+      if (due && tries >= DHCP_REQUEST_TRIES) {
+        __w5500_dhcp_start(W5500_DHCP_SELECTING, now);
+      }
+      else if (due) {
+        __w5500_dhcp_retransmit(DHCP_REQUEST, now);
+      }
+      break;
+    case W5500_DHCP_REBOOTING:
+      if (due && tries >= DHCP_REBOOT_TRIES) {
+        // No answer is no refusal: keep a lease in use, else ask for a new one
+        if (applied) {
+          state = W5500_DHCP_BOUND;
+        }
+        else {
+          __w5500_dhcp_start(W5500_DHCP_SELECTING, now);
+        }
+      }
+      else if (due) {
+        __w5500_dhcp_retransmit(DHCP_REQUEST, now);
+      }
+      break;
+    case W5500_DHCP_BOUND:
+      if (lease.lease_s != DHCP_INFINITE && held >= lease.t1_s) {
+        xid = __w5500_dhcp_rand();
+        start_s = clock_s;
+        next_s = clock_s;
+        state = W5500_DHCP_RENEWING;
+        LOG_TRACE("W5500 :: DHCP renewing");
+      }
+      break;
+    case W5500_DHCP_RENEWING:
+    case W5500_DHCP_REBINDING: {
+      if (state == W5500_DHCP_RENEWING && held >= lease.t2_s) {
+        next_s = clock_s;
+        state = W5500_DHCP_REBINDING;
+        LOG_WARNING("W5500 :: DHCP server silent, rebinding");
+      }
+      if ((int32_t)(clock_s - next_s) < 0 || !__w5500_dhcp_send(DHCP_REQUEST)) {
+        break;
+      }
+      // RFC 2131 4.4.5: half the time left, down to DHCP_RENEW_MIN_S
+      uint32_t left = ((state == W5500_DHCP_RENEWING) ? lease.t2_s : lease.lease_s) - held;
+      next_s = clock_s + ((left / 2 > DHCP_RENEW_MIN_S) ? left / 2 : DHCP_RENEW_MIN_S);
+      break;
+    }
+    default:
+      break;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Check if a leased address is on the chip.
+ *
+ * @return true while the address can be used, including during renewal.
+ */
+bool w5500_dhcp_isBound (void) {
+  return opened && applied;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the state of the client.
+ *
+ * @return Current state, W5500_DHCP_STOPPED if it is not running.
+ */
+W5500_DhcpState_t w5500_dhcp_getState (void) {
+  return state;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the lease in use.
+ *
+ * @param[out] out Pointer to the structure to fill.
+ *
+ * @return true if a lease is in use.
+ */
+bool w5500_dhcp_getLease (W5500_DhcpLease_t* out) {
+  if (out == NULL || !applied) {
+    return false;
+  }
+  *out = lease;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the client statistics.
+ *
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_dhcp_getStat (W5500_DhcpStat_t* out) {
+  if (out != NULL) {
+    *out = stat;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Register a callback for lease changes.
+ *
+ * @param[in] cb Callback function, NULL unregisters it.
+ */
+void w5500_dhcp_regCallback (void (*cb)(W5500_DhcpEvent_t ev, const W5500_DhcpLease_t* lease)) {
+  callback = cb;
+}
+//--------------------------------------------------------------------------
+#endif
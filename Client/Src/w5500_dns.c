@@ -0,0 +1,697 @@
+/**
+ * @file w5500_dns.c
+ * @brief Asynchronous DNS resolver of the W5500.
+ *
+ * A-record resolver on a UDP socket, asking the server of wiz_NetInfo.dns
+ * (set statically or by DHCP). Up to W5500_DNS_QUERIES names are resolved
+ * side by side, each question with its own ID; w5500_dns_process() reads
+ * the answers and retransmits the silent ones every W5500_DNS_TIMEOUT_MS.
+ * IDs and source ports are random, so a forged answer has to guess both.
+ *
+ * A CNAME chain is followed inside the answer; when the server returns the
+ * alias without its address, the target is asked in turn, up to
+ * W5500_DNS_CNAME_DEPTH hops. Answers are cached for the smallest TTL of
+ * the chain, capped at W5500_DNS_TTL_MAX_S. Names that don't resolve are
+ * cached for W5500_DNS_NEG_TTL_S, so a caller retrying in a loop does not
+ * flood the server.
+ *
+ * w5500_dns_resolve() never waits: it answers from the cache or starts a
+ * query and is called again until the answer is in.
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_dns.h"
+#include "w5500_link.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_DNS_ENABLE==YES)
+
+#if (W5500_DNS_NAME_MAX < 16) || (W5500_DNS_NAME_MAX > 255)
+#error "W5500_DNS_NAME_MAX must be 16 to 255"
+#endif
+#if (W5500_DNS_QUERIES < 1) || (W5500_DNS_CACHE < 1)
+#error "W5500_DNS_QUERIES/W5500_DNS_CACHE must be at least 1"
+#endif
+
+#define DNS_PORT                      53
+#define DNS_MSG_SIZE                  512     // Largest message over UDP without EDNS
+#define DNS_HEADER                    12
+#define DNS_RR_FIXED                  10      // TYPE, CLASS, TTL and RDLENGTH of a resource record
+#define DNS_FLAG_QR                   0x8000
+#define DNS_FLAG_RD                   0x0100
+#define DNS_RCODE_MASK                0x000F
+#define DNS_TYPE_A                    1
+#define DNS_TYPE_CNAME                5
+#define DNS_CLASS_IN                  1
+#define DNS_LABEL_MAX                 63
+#define DNS_PTR_MAX                   16      // Compression pointers followed in one name
+#define DNS_SRC_PORT_MIN              49152   // Dynamic port range of the source ports
+#define DNS_SRC_PORT_NUM              16384
+
+typedef struct __W5500_DnsQuery_s {
+  bool      active;
+  bool      sent;                             // Waiting for the answer, else the question is due
+  uint8_t   tries;
+  uint8_t   depth;                            // CNAME hops followed
+  uint16_t  id;
+  uint32_t  start_ts;                         // First question
+  uint32_t  sent_ts;                          // Last question
+  uint32_t  ttl_s;                            // Smallest TTL along the CNAME chain
+  char      name[W5500_DNS_NAME_MAX];         // Name asked by the caller, the cache key
+  char      qname[W5500_DNS_NAME_MAX];        // Name in the question, the alias target after a CNAME
+} W5500_DnsQuery_t;
+
+typedef struct __W5500_DnsEntry_s {
+  bool      used;
+  bool      ok;                               // false for a name that does not resolve
+  uint8_t   ip[4];
+  uint32_t  expires_s;
+  char      name[W5500_DNS_NAME_MAX];
+} W5500_DnsEntry_t;
+
+static wiz_SockCtx dns_ctx;
+static uint8_t dns_sn;
+static bool opened = false;
+static W5500_DnsQuery_t queries[W5500_DNS_QUERIES];
+static W5500_DnsEntry_t cache[W5500_DNS_CACHE];
+static W5500_DnsStat_t stat;
+static uint8_t msg[DNS_MSG_SIZE];
+static uint32_t rand_state;
+static uint32_t clock_s;                      // Seconds clock of the TTLs
+static uint32_t clock_us;
+static uint32_t clock_ts;
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Next value of a xorshift32 generator, seeded from the clock and the MAC on first use.
+ */
+static uint32_t __w5500_dns_rand (void) {
+  if (rand_state == 0) {
+    // Devices powered up together read the same clock, their MACs differ
+    uint8_t mac[6];
+    getSHAR(mac);
+    rand_state = W5500_GetMicros() ^ (((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5]);
+    rand_state |= 1;
+  }
+  rand_state ^= rand_state << 13;
+  rand_state ^= rand_state >> 17;
+  rand_state ^= rand_state << 5;
+  return rand_state;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Pick a random question ID not used by another active query.
+ *
+ * A sequential ID lets a forged answer guess the next one.
+ */
+static uint16_t __w5500_dns_newId (void) {
+  uint16_t id;
+  bool used;
+  do {
+    id = (uint16_t)__w5500_dns_rand();
+    used = false;
+    for (uint8_t i = 0; i < W5500_DNS_QUERIES; i++) {
+      used = used || (queries[i].active && queries[i].id == id);
+    }
+  } while (used);
+  return id;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief (Re)open the socket of the resolver on a random source port.
+ *
+ * @return true if the socket is open.
+ */
+static bool __w5500_dns_bind (void) {
+  uint8_t mode = SOCK_SEND_ASYNC;
+  uint16_t port = DNS_SRC_PORT_MIN + (uint16_t)(__w5500_dns_rand() % DNS_SRC_PORT_NUM);
+  // socket() closes the socket first, answers to the previous port are dropped with it
+  if (socket_ctx(&dns_ctx, dns_sn, Sn_MR_UDP, port, SF_IO_NONBLOCK) != dns_sn) {
+    return false;
+  }
+  ctlsocket_ctx(&dns_ctx, dns_sn, CS_SET_SENDMODE, &mode);
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Read a big-endian 16-bit value.
+ */
+static uint16_t __w5500_dns_get16 (const uint8_t* p) {
+  return ((uint16_t)p[0] << 8) | p[1];
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Lower-case an ASCII character.
+ */
+static char __w5500_dns_lower (char c) {
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Compare two names, ignoring the case.
+ *
+ * @return true if they are equal.
+ */
+static bool __w5500_dns_nameEq (const char* a, const char* b) {
+  while (*a != '\0' && __w5500_dns_lower(*a) == __w5500_dns_lower(*b)) {
+    a++;
+    b++;
+  }
+  return (__w5500_dns_lower(*a) == __w5500_dns_lower(*b));
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Copy a name, lower-cased.
+ *
+ * @return false if it does not fit in W5500_DNS_NAME_MAX.
+ */
+static bool __w5500_dns_nameCopy (char* dst, const char* src) {
+  uint16_t n = 0;
+  while (src[n] != '\0') {
+    if (n >= W5500_DNS_NAME_MAX - 1) {
+      return false;
+    }
+    dst[n] = __w5500_dns_lower(src[n]);
+    n++;
+  }
+  dst[n] = '\0';
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Parse a dotted IPv4 literal.
+ *
+ * @return true if name is one, with the address in ip.
+ */
+static bool __w5500_dns_literal (const char* name, uint8_t ip[4]) {
+  for (uint8_t i = 0; i < 4; i++) {
+    uint16_t v = 0;
+    uint8_t digits = 0;
+    while (*name >= '0' && *name <= '9' && digits < 3) {
+      v = v * 10 + (uint16_t)(*name++ - '0');
+      digits++;
+    }
+    if (digits == 0 || v > 255 || *name != ((i < 3) ? '.' : '\0')) {
+      return false;
+    }
+    ip[i] = (uint8_t)v;
+    name++;
+  }
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Advance the seconds clock.
+ */
+static void __w5500_dns_tick (void) {
+  uint32_t now = W5500_GetMicros();
+  clock_us += now - clock_ts;
+  clock_ts = now;
+  while (clock_us >= 1000000) {
+    clock_us -= 1000000;
+    clock_s++;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Skip a name in msg.
+ *
+ * @return Offset right after the name, 0 if it is malformed.
+ */
+static uint16_t __w5500_dns_skipName (uint16_t len, uint16_t off) {
+  while (off < len) {
+    uint8_t l = msg[off];
+    if ((l & 0xC0) == 0xC0) {
+      return (off + 2 <= len) ? off + 2 : 0;
+    }
+    if (l == 0) {
+      return off + 1;
+    }
+    off += 1 + l;
+  }
+  return 0;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Decode a possibly compressed name of msg into dotted form.
+ *
+ * @param[in]  len Length of the message.
+ * @param[in]  off Offset of the name.
+ * @param[out] out Name, W5500_DNS_NAME_MAX bytes.
+ *
+ * @return false if it is malformed or longer than W5500_DNS_NAME_MAX.
+ */
+static bool __w5500_dns_readName (uint16_t len, uint16_t off, char* out) {
+  uint16_t n = 0;
+  uint8_t jumps = 0;
+  while (off < len) {
+    uint8_t l = msg[off];
+    if ((l & 0xC0) == 0xC0) {
+      if (off + 2 > len || ++jumps > DNS_PTR_MAX) {
+        return false;
+      }
+      off = ((uint16_t)(l & 0x3F) << 8) | msg[off + 1];
+      continue;
+    }
+    if (l == 0) {
+      out[n] = '\0';
+      return true;
+    }
+    if (l > DNS_LABEL_MAX || off + 1 + l > len || n + l + 1 >= W5500_DNS_NAME_MAX) {
+      return false;
+    }
+    if (n != 0) {
+      out[n++] = '.';
+    }
+    for (uint8_t i = 0; i < l; i++) {
+      out[n++] = __w5500_dns_lower((char)msg[off + 1 + i]);
+    }
+    off += 1 + l;
+  }
+  return false;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Find the cache entry of a name.
+ *
+ * @return The entry, or NULL if the name is not cached or its entry expired.
+ */
+static W5500_DnsEntry_t* __w5500_dns_lookup (const char* name) {
+  for (uint8_t i = 0; i < W5500_DNS_CACHE; i++) {
+    W5500_DnsEntry_t* e = &cache[i];
+    if (!e->used) {
+      continue;
+    }
+    if ((int32_t)(clock_s - e->expires_s) >= 0) {
+      e->used = false;
+      continue;
+    }
+    if (__w5500_dns_nameEq(e->name, name)) {
+      return e;
+    }
+  }
+  return NULL;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Cache the outcome of a query and end it.
+ *
+ * The entry of the same name, else a free one, else the one expiring first is used.
+ *
+ * @param[in] q   Query.
+ * @param[in] ip  Address, NULL if the name does not resolve.
+ * @param[in] ttl Time to live of the answer in seconds.
+ */
+static void __w5500_dns_finish (W5500_DnsQuery_t* q, const uint8_t* ip, uint32_t ttl) {
+  W5500_DnsEntry_t* e = __w5500_dns_lookup(q->name);
+  for (uint8_t i = 0; i < W5500_DNS_CACHE && e == NULL; i++) {
+    if (!cache[i].used) {
+      e = &cache[i];
+    }
+  }
+  if (e == NULL) {
+    e = &cache[0];
+    for (uint8_t i = 1; i < W5500_DNS_CACHE; i++) {
+      if ((int32_t)(cache[i].expires_s - e->expires_s) < 0) {
+        e = &cache[i];
+      }
+    }
+  }
+  if (ttl > W5500_DNS_TTL_MAX_S) {
+    ttl = W5500_DNS_TTL_MAX_S;
+  }
+  // A zero TTL still has to outlive the caller's next poll
+  e->used = true;
+  e->ok = (ip != NULL);
+  e->expires_s = clock_s + ((ttl == 0) ? 1 : ttl);
+  __w5500_dns_nameCopy(e->name, q->name);
+  if (ip != NULL) {
+    for (uint8_t i = 0; i < 4; i++) {
+      e->ip[i] = ip[i];
+    }
+    stat.answers++;
+    stat.last_rtt_us = W5500_GetMicros() - q->start_ts;
+    LOG_TRACE("W5500 :: DNS %s is %u.%u.%u.%u, TTL %lu s", q->name, ip[0], ip[1], ip[2], ip[3], ttl);
+  }
+  else {
+    stat.failures++;
+    LOG_WARNING("W5500 :: DNS %s does not resolve", q->name);
+  }
+  q->active = false;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Send the question of a query.
+ *
+ * @param[in] q Query.
+ *
+ * @return false if the socket is busy, the question is then sent on the next step.
+ */
+static bool __w5500_dns_send (W5500_DnsQuery_t* q) {
+  wiz_NetInfo info;
+  const char* s = q->qname;
+  uint16_t p = DNS_HEADER;
+  ctlnetwork(CN_GET_NETINFO, (void*)&info);
+  if ((info.dns[0] | info.dns[1] | info.dns[2] | info.dns[3]) == 0) {
+    LOG_ERROR("W5500 :: No DNS server");
+    __w5500_dns_finish(q, NULL, W5500_DNS_NEG_TTL_S);
+    return true;
+  }
+  msg[0] = (uint8_t)(q->id >> 8);
+  msg[1] = (uint8_t)q->id;
+  msg[2] = (uint8_t)(DNS_FLAG_RD >> 8);
+  msg[3] = (uint8_t)DNS_FLAG_RD;
+  for (uint8_t i = 4; i < DNS_HEADER; i++) {
+    msg[i] = 0;
+  }
+  msg[5] = 1;
+  while (*s != '\0') {
+    uint16_t lp = p++;
+    uint8_t n = 0;
+    while (*s != '\0' && *s != '.') {
+      msg[p++] = (uint8_t)*s++;
+      n++;
+    }
+    if (n == 0 || n > DNS_LABEL_MAX) {
+      __w5500_dns_finish(q, NULL, W5500_DNS_NEG_TTL_S);
+      return true;
+    }
+    msg[lp] = n;
+    if (*s == '.') {
+      s++;
+    }
+  }
+  msg[p++] = 0;
+  msg[p++] = 0;
+  msg[p++] = DNS_TYPE_A;
+  msg[p++] = 0;
+  msg[p++] = DNS_CLASS_IN;
+  int32_t ret = sendto_ctx(&dns_ctx, dns_sn, msg, p, info.dns, DNS_PORT, 4);
+  if (ret == SOCK_BUSY) {
+    return false;
+  }
+  // A question that failed to leave is retransmitted on its timeout like a lost one
+  stat.queries++;
+  q->tries++;
+  q->sent = true;
+  q->sent_ts = W5500_GetMicros();
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Handle an answer, sitting in msg.
+ *
+ * @param[in] len Length of the answer.
+ */
+static void __w5500_dns_input (uint16_t len) {
+  W5500_DnsQuery_t* q = NULL;
+  char cur[W5500_DNS_NAME_MAX];
+  char owner[W5500_DNS_NAME_MAX];
+  uint8_t ip[4];
+  bool found = false;
+  if (len < DNS_HEADER) {
+    return;
+  }
+  uint16_t id = __w5500_dns_get16(&msg[0]);
+  uint16_t flags = __w5500_dns_get16(&msg[2]);
+  uint16_t an = __w5500_dns_get16(&msg[6]);
+  for (uint8_t i = 0; i < W5500_DNS_QUERIES; i++) {
+    if (queries[i].active && queries[i].sent && queries[i].id == id) {
+      q = &queries[i];
+    }
+  }
+  // The question must be ours: an ID alone is easy to hit with a forged answer
+  if (q == NULL || !(flags & DNS_FLAG_QR) || __w5500_dns_get16(&msg[4]) != 1 ||
+      !__w5500_dns_readName(len, DNS_HEADER, cur) || !__w5500_dns_nameEq(cur, q->qname)) {
+    return;
+  }
+  uint16_t ans = __w5500_dns_skipName(len, DNS_HEADER);
+  if (ans == 0 || ans + 4 > len) {
+    return;
+  }
+  ans += 4;
+  if ((flags & DNS_RCODE_MASK) != 0) {
+    // NXDOMAIN, SERVFAIL, REFUSED...: nothing better is coming
+    __w5500_dns_finish(q, NULL, W5500_DNS_NEG_TTL_S);
+    return;
+  }
+  // The chain is usually in order, a second pass covers an alias listed after its target
+  uint32_t ttl = q->ttl_s;
+  bool moved = false;
+  for (uint8_t pass = 0; pass < 2 && !found; pass++) {
+    uint16_t off = ans;
+    for (uint16_t i = 0; i < an && !found; i++) {
+      bool named = __w5500_dns_readName(len, off, owner);
+      off = __w5500_dns_skipName(len, off);
+      if (off == 0 || off + DNS_RR_FIXED > len) {
+        break;
+      }
+      uint16_t type = __w5500_dns_get16(&msg[off]);
+      uint16_t cls = __w5500_dns_get16(&msg[off + 2]);
+      uint32_t rttl = ((uint32_t)__w5500_dns_get16(&msg[off + 4]) << 16) | __w5500_dns_get16(&msg[off + 6]);
+      uint16_t rdlen = __w5500_dns_get16(&msg[off + 8]);
+      off += DNS_RR_FIXED;
+      if (off + rdlen > len) {
+        break;
+      }
+      if (named && cls == DNS_CLASS_IN && __w5500_dns_nameEq(owner, cur)) {
+        if (type == DNS_TYPE_A && rdlen == 4) {
+          for (uint8_t k = 0; k < 4; k++) {
+            ip[k] = msg[off + k];
+          }
+          ttl = (rttl < ttl) ? rttl : ttl;
+          found = true;
+        }
+        else if (type == DNS_TYPE_CNAME && __w5500_dns_readName(len, off, owner)) {
+          if (++q->depth > W5500_DNS_CNAME_DEPTH) {
+            __w5500_dns_finish(q, NULL, W5500_DNS_NEG_TTL_S);
+            return;
+          }
+          __w5500_dns_nameCopy(cur, owner);
+          ttl = (rttl < ttl) ? rttl : ttl;
+          stat.cnames++;
+          moved = true;
+        }
+      }
+      off += rdlen;
+    }
+  }
+  if (found) {
+    __w5500_dns_finish(q, ip, ttl);
+  }
+  else if (moved) {
+    // Alias without its address: ask for the target
+    __w5500_dns_nameCopy(q->qname, cur);
+    q->ttl_s = ttl;
+    q->id = __w5500_dns_newId();
+    q->tries = 0;
+    q->sent = false;
+  }
+  else {
+    __w5500_dns_finish(q, NULL, W5500_DNS_NEG_TTL_S);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Read all pending answers.
+ */
+static void __w5500_dns_receive (void) {
+  uint8_t ip[4];
+  uint16_t port;
+  uint8_t alen;
+  uint16_t rem;
+  int32_t ret;
+  while ((ret = recvfrom_ctx(&dns_ctx, dns_sn, msg, sizeof(msg), ip, &port, &alen)) > 0) {
+    // Drop the rest of a longer answer, the records past DNS_MSG_SIZE with it
+    uint16_t len = (uint16_t)ret;
+    while (getsockopt_ctx(&dns_ctx, dns_sn, SO_REMAINSIZE, &rem) == SOCK_OK && rem != 0) {
+      uint8_t tmp[16];
+      recvfrom_ctx(&dns_ctx, dns_sn, tmp, sizeof(tmp), ip, &port, &alen);
+    }
+    if (port == DNS_PORT) {
+      __w5500_dns_input(len);
+    }
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Open the socket of the resolver and clear the cache.
+ *
+ * @param[in] sn Free socket for the resolver.
+ *
+ * @return true if the socket is open.
+ */
+bool w5500_dns_init (uint8_t sn) {
+  socket_ctx_init(&dns_ctx, socket_ctx_default()->chip);
+  dns_ctx.poll_wait = socket_ctx_default()->poll_wait;
+  opened = false;
+  stat = (W5500_DnsStat_t){0};
+  for (uint8_t i = 0; i < W5500_DNS_QUERIES; i++) {
+    queries[i].active = false;
+  }
+  w5500_dns_flush();
+  clock_ts = W5500_GetMicros();
+  dns_sn = sn;
+  if (!__w5500_dns_bind()) {
+    LOG_ERROR("W5500 :: Failed to open the DNS socket");
+    return false;
+  }
+  opened = true;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Resolve a host name to an IPv4 address without blocking.
+ *
+ * Answers from the cache when it can, else starts a query; call it again
+ * (e.g. on the next service step) until it stops returning W5500_DNS_PENDING.
+ *
+ * @param[in]  name Host name or dotted IPv4 literal.
+ * @param[out] ip   Address, written only on W5500_DNS_OK.
+ *
+ * @return W5500_DNS_OK, W5500_DNS_PENDING or W5500_DNS_FAIL.
+ */
+W5500_DnsResult_t w5500_dns_resolve (const char* name, uint8_t ip[4]) {
+  uint8_t lit[4];
+  if (name == NULL || ip == NULL) {
+    return W5500_DNS_FAIL;
+  }
+  if (__w5500_dns_literal(name, lit)) {
+    for (uint8_t i = 0; i < 4; i++) {
+      ip[i] = lit[i];
+    }
+    return W5500_DNS_OK;
+  }
+  if (!opened) {
+    return W5500_DNS_FAIL;
+  }
+  __w5500_dns_tick();
+  W5500_DnsEntry_t* e = __w5500_dns_lookup(name);
+  if (e != NULL) {
+    stat.hits++;
+    if (!e->ok) {
+      return W5500_DNS_FAIL;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+      ip[i] = e->ip[i];
+    }
+    return W5500_DNS_OK;
+  }
+  W5500_DnsQuery_t* q = NULL;
+  bool idle = true;
+  for (uint8_t i = 0; i < W5500_DNS_QUERIES; i++) {
+    if (queries[i].active && __w5500_dns_nameEq(queries[i].name, name)) {
+      return W5500_DNS_PENDING;
+    }
+    if (!queries[i].active && q == NULL) {
+      q = &queries[i];
+    }
+    idle = idle && !queries[i].active;
+  }
+  if (q == NULL) {
+    // All slots busy, the name is asked once one frees
+    return W5500_DNS_PENDING;
+  }
+  if (!__w5500_dns_nameCopy(q->name, name)) {
+    return W5500_DNS_FAIL;
+  }
+  // A fresh source port per query; queries side by side share the port of the first one
+  if (idle && !__w5500_dns_bind()) {
+    opened = false;
+    LOG_ERROR("W5500 :: Failed to reopen the DNS socket");
+    return W5500_DNS_FAIL;
+  }
+  stat.misses++;
+  __w5500_dns_nameCopy(q->qname, q->name);
+  q->id = __w5500_dns_newId();
+  q->tries = 0;
+  q->depth = 0;
+  q->ttl_s = UINT32_MAX;
+  q->sent = false;
+  q->start_ts = W5500_GetMicros();
+  q->active = true;
+  if (w5500_link_isUp()) {
+    __w5500_dns_send(q);
+  }
+  // Ended at once only when there is no server to ask
+  return q->active ? W5500_DNS_PENDING : W5500_DNS_FAIL;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Run the resolver: read the answers, retransmit and send what is due.
+ *
+ * Never blocks. Call it from the service loop.
+ */
+void w5500_dns_process (void) {
+  wiz_SendEvent ev;
+  if (!opened) {
+    return;
+  }
+  __w5500_dns_tick();
+  while (sendcompletion_ctx(&dns_ctx, &ev) == SOCK_OK) {
+  }
+  __w5500_dns_receive();
+  if (!w5500_link_isUp()) {
+    return;
+  }
+  uint32_t now = W5500_GetMicros();
+  for (uint8_t i = 0; i < W5500_DNS_QUERIES; i++) {
+    W5500_DnsQuery_t* q = &queries[i];
+    if (!q->active) {
+      continue;
+    }
+    if (q->sent && (now - q->sent_ts) >= (uint32_t)W5500_DNS_TIMEOUT_MS * 1000) {
+      stat.timeouts++;
+      if (q->tries >= W5500_DNS_RETRIES) {
+        __w5500_dns_finish(q, NULL, W5500_DNS_NEG_TTL_S);
+        continue;
+      }
+      // Same ID: a late answer to the previous question still counts
+      q->sent = false;
+    }
+    if (!q->sent && !__w5500_dns_send(q)) {
+      break;
+    }
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Drop every cached answer, e.g. after the network changed.
+ */
+void w5500_dns_flush (void) {
+  for (uint8_t i = 0; i < W5500_DNS_CACHE; i++) {
+    cache[i].used = false;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the resolver statistics.
+ *
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_dns_getStat (W5500_DnsStat_t* out) {
+  if (out != NULL) {
+    *out = stat;
+  }
+}
+//--------------------------------------------------------------------------
+#endif
@@ -0,0 +1,271 @@
+/**
+ * @file w5500_failover.c
+ * @brief Server list with health scoring for the W5500 client connections.
+ *
+ * A connection may be given several servers, each with a priority. Every
+ * server keeps a health record: connections, failures, the smoothed
+ * handshake time and the smoothed SEND to SEND_OK time of its traffic.
+ * They add up to a score in milliseconds, lower is better:
+ *
+ *   priority * W5500_FAILOVER_PRIO_MS + connect + RTT
+ *   + failures in a row * W5500_FAILOVER_FAIL_MS (for W5500_FAILOVER_HOLD_S after the last one)
+ *
+ * After W5500_FAILOVER_FAILS failures in a row of the server in use, a lost
+ * connection counting as one, w5500_failover_next() moves to the best other
+ * server instead of backing off on the dead one. The server in use is kept
+ * while it works: a recovered server of better priority is taken again on
+ * the next failover only, so the connection does not flap.
+ *
+ * With W5500_FAILOVER_STANDBY the client keeps a second connection to the
+ * best other server; a loss of the one in use is then taken over at once.
+ * The failover latency runs from the first failure of the server in use
+ * to the connection being in use on another one.
+ *
+ * The module only keeps the books, the client drives the sockets.
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_failover.h"
+#include "w5500_config.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_FAILOVER_ENABLE==YES)
+
+#if (W5500_FAILOVER_SERVERS < 1) || (W5500_FAILOVER_SERVERS > 127)
+#error "W5500_FAILOVER_SERVERS must be 1 to 127"
+#endif
+#if (W5500_FAILOVER_FAILS < 1)
+#error "W5500_FAILOVER_FAILS must be at least 1"
+#endif
+#if (W5500_FAILOVER_HOLD_S > 2000)
+#error "W5500_FAILOVER_HOLD_S can't exceed 2000 (microsecond clock wrap)"
+#endif
+
+#define FAILOVER_EWMA_SHIFT           2       // Smoothing gain of 1/4
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Fold a sample into a smoothed value, the first sample taken as is.
+ */
+static void __w5500_failover_smooth (uint32_t* avg, uint32_t sample) {
+  if (*avg == 0) {
+    *avg = sample;
+  }
+  else if (sample > *avg) {
+    *avg += (sample - *avg) >> FAILOVER_EWMA_SHIFT;
+  }
+  else {
+    *avg -= (*avg - sample) >> FAILOVER_EWMA_SHIFT;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Score of a server, lower is better.
+ */
+static uint32_t __w5500_failover_score (const W5500_Failover_t* fo, uint8_t idx) {
+  const W5500_ServerHealth_t* hs = &fo->health[idx];
+  uint32_t score = (uint32_t)fo->list[idx].priority * W5500_FAILOVER_PRIO_MS;
+  score += hs->connect_us / 1000 + hs->rtt_us / 1000;
+  // Failures are forgiven after a while, so a server that came back is tried again
+  if (hs->streak != 0 && (W5500_GetMicros() - hs->fail_ts) < (uint32_t)W5500_FAILOVER_HOLD_S * 1000000) {
+    score += (uint32_t)hs->streak * W5500_FAILOVER_FAIL_MS;
+  }
+  return score;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Initialize the servers of a connection.
+ *
+ * @param[out] fo   Failover state.
+ * @param[in]  list Servers, must stay valid while the connection is open.
+ * @param[in]  cnt  Number of servers, up to W5500_FAILOVER_SERVERS.
+ *
+ * @return false if the list is empty or too long. The best priority is used first.
+ */
+bool w5500_failover_init (W5500_Failover_t* fo, const W5500_Server_t* list, uint8_t cnt) {
+  if (fo == NULL || list == NULL || cnt == 0 || cnt > W5500_FAILOVER_SERVERS) {
+    return false;
+  }
+  *fo = (W5500_Failover_t){0};
+  fo->list = list;
+  fo->cnt = cnt;
+  fo->cur = (uint8_t)w5500_failover_best(fo, -1);
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Find the best scoring server.
+ *
+ * @param[in] fo   Failover state.
+ * @param[in] skip Server left out, -1 for none.
+ *
+ * @return The server index, -1 if there is no other.
+ */
+int8_t w5500_failover_best (const W5500_Failover_t* fo, int8_t skip) {
+  int8_t best = -1;
+  uint32_t best_score = 0;
+  for (uint8_t i = 0; i < fo->cnt; i++) {
+    if ((int8_t)i == skip) {
+      continue;
+    }
+    uint32_t score = __w5500_failover_score(fo, i);
+    if (best < 0 || score < best_score) {
+      best = (int8_t)i;
+      best_score = score;
+    }
+  }
+  return best;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Move to the best other server once the one in use failed W5500_FAILOVER_FAILS times in a row.
+ *
+ * @param[in] fo Failover state.
+ *
+ * @return true if the server in use changed.
+ */
+bool w5500_failover_next (W5500_Failover_t* fo) {
+  if (fo->health[fo->cur].streak < W5500_FAILOVER_FAILS) {
+    return false;
+  }
+  int8_t next = w5500_failover_best(fo, (int8_t)fo->cur);
+  if (next < 0) {
+    return false;
+  }
+  LOG_WARNING("W5500 :: Server %u failed %u times, moving to server %d", fo->cur, fo->health[fo->cur].streak, next);
+  fo->cur = (uint8_t)next;
+  fo->stat.switches++;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Account an established connection, in use or standby.
+ *
+ * @param[in] fo           Failover state.
+ * @param[in] idx          Server.
+ * @param[in] handshake_us CONNECT to established time.
+ */
+void w5500_failover_onConnect (W5500_Failover_t* fo, uint8_t idx, uint32_t handshake_us) {
+  W5500_ServerHealth_t* hs = &fo->health[idx];
+  hs->connects++;
+  hs->streak = 0;
+  __w5500_failover_smooth(&hs->connect_us, handshake_us);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Make an established connection the one in use.
+ *
+ * Ends the outage in progress; if it ended on another server, its length is
+ * the failover latency.
+ *
+ * @param[in] fo  Failover state.
+ * @param[in] idx Server.
+ */
+void w5500_failover_onUse (W5500_Failover_t* fo, uint8_t idx) {
+  if (fo->lost && idx != fo->lost_idx) {
+    uint32_t ms = (W5500_GetMicros() - fo->lost_ts) / 1000;
+    fo->stat.failovers++;
+    fo->stat.last_latency_ms = ms;
+    fo->stat.total_latency_ms += ms;
+    if (ms > fo->stat.max_latency_ms) {
+      fo->stat.max_latency_ms = ms;
+    }
+    LOG_INFO("W5500 :: Failed over from server %u to %u in %lu ms", fo->lost_idx, idx, ms);
+  }
+  fo->lost = false;
+  fo->cur = idx;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Account a failed attempt.
+ *
+ * A failure of the server in use starts the outage clock if it is not running.
+ *
+ * @param[in] fo  Failover state.
+ * @param[in] idx Server.
+ */
+void w5500_failover_onFail (W5500_Failover_t* fo, uint8_t idx) {
+  W5500_ServerHealth_t* hs = &fo->health[idx];
+  uint32_t now = W5500_GetMicros();
+  hs->failures++;
+  if (hs->streak < UINT8_MAX) {
+    hs->streak++;
+  }
+  hs->fail_ts = now;
+  if (idx == fo->cur && !fo->lost) {
+    fo->lost = true;
+    fo->lost_idx = idx;
+    fo->lost_ts = now;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Account the loss of the established connection, as a failure of its server.
+ *
+ * @param[in] fo Failover state.
+ */
+void w5500_failover_onLoss (W5500_Failover_t* fo) {
+  w5500_failover_onFail(fo, fo->cur);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Fold a round trip sample of a server's traffic into its health.
+ *
+ * @param[in] fo     Failover state.
+ * @param[in] idx    Server.
+ * @param[in] rtt_us SEND to SEND_OK time.
+ */
+void w5500_failover_onRtt (W5500_Failover_t* fo, uint8_t idx, uint32_t rtt_us) {
+  if (idx < fo->cnt) {
+    __w5500_failover_smooth(&fo->health[idx].rtt_us, rtt_us);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the health of a server.
+ *
+ * @param[in]  fo  Failover state.
+ * @param[in]  idx Server.
+ * @param[out] out Pointer to the structure to fill, score included.
+ *
+ * @return false if there is no such server.
+ */
+bool w5500_failover_getHealth (const W5500_Failover_t* fo, uint8_t idx, W5500_ServerHealth_t* out) {
+  if (fo == NULL || out == NULL || idx >= fo->cnt) {
+    return false;
+  }
+  *out = fo->health[idx];
+  out->score = __w5500_failover_score(fo, idx);
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the failover statistics.
+ *
+ * @param[in]  fo  Failover state.
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_failover_getStat (const W5500_Failover_t* fo, W5500_FailoverStat_t* out) {
+  if (fo != NULL && out != NULL) {
+    *out = fo->stat;
+  }
+}
+//--------------------------------------------------------------------------
+#endif
@@ -0,0 +1,360 @@
+/**
+ * @file w5500_frame.c
+ * @brief Length-prefixed message framing over the W5500 client connections.
+ *
+ * Each message goes on the wire as a 1, 2 or 4 byte length prefix, little
+ * or big endian, the payload and optionally a CRC-16 of it. A framer turns
+ * the byte stream of a connection back into whole messages.
+ *
+ * The received data is parsed where it lies, in the socket RX memory of the
+ * chip: a message that arrived in part stays there until the rest follows,
+ * so no reassembly buffer is kept in MCU RAM. Every complete message found
+ * in one pass is delivered and all of them are released with a single RECV
+ * command, so small messages don't pay a RECV each.
+ *
+ * Two delivery modes:
+ * - With a buffer, the waiting data is copied once into it, in bursts as
+ *   large as the buffer, and each message is handed over in place there.
+ *   Required for the CRC.
+ * - Without, only the prefixes are read; the handler reads the payload with
+ *   w5500_frame_read() straight into its destination, or skips it.
+ *
+ * A message must fit the socket RX memory, else it could never arrive
+ * whole; a prefix beyond max_len or that size is a sync error.
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_frame.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_FRAME_ENABLE==YES)
+
+#define FRAME_CRC_LEN                 2
+#define FRAME_CRC_INIT                0xFFFF
+
+// CRC-16/CCITT-FALSE (poly 0x1021) by nibble, a compromise between a bit loop and a 512-byte table
+static const uint16_t crc_nibble[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+//--------------------------------------------------------------------------
+/**
+ * @brief CRC-16/CCITT-FALSE of a buffer.
+ */
+static uint16_t __w5500_frame_crc (const uint8_t* p, uint16_t len) {
+  uint16_t crc = FRAME_CRC_INIT;
+  while (len--) {
+    crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*p >> 4)];
+    crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*p & 0x0F)];
+    p++;
+  }
+  return crc;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Decode an unsigned value of n bytes.
+ */
+static uint32_t __w5500_frame_get (const uint8_t* p, uint8_t n, bool be) {
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    v |= (uint32_t)p[be ? i : (n - 1 - i)] << (8 * (n - 1 - i));
+  }
+  return v;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Encode an unsigned value on n bytes.
+ */
+static void __w5500_frame_put (uint8_t* p, uint8_t n, bool be, uint32_t v) {
+  for (uint8_t i = 0; i < n; i++) {
+    p[be ? (n - 1 - i) : i] = (uint8_t)(v >> (8 * i));
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Check the length of a frame.
+ *
+ * @param[in] f    Framer.
+ * @param[in] len  Payload length of the prefix.
+ * @param[in] need Prefix, payload and CRC.
+ *
+ * @return false on a sync error, recorded in the framer.
+ */
+static bool __w5500_frame_check (W5500_Framer_t* f, uint32_t len, uint32_t need) {
+  if (len <= f->cnf.max_len && need <= f->rx_max) {
+    return true;
+  }
+  f->stat.sync_errors++;
+  f->err = W5500_FRAME_ERR_SYNC;
+  LOG_ERROR("W5500 :: Frame of %lu bytes out of range", len);
+  return false;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Hand a frame to the handler.
+ *
+ * @param[in] f     Framer.
+ * @param[in] frame Frame, data set in buffer mode.
+ */
+static void __w5500_frame_deliver (W5500_Framer_t* f, W5500_Frame_t* frame) {
+  if (f->cnf.crc) {
+    const uint8_t* t = frame->data + frame->len;
+    if ((uint16_t)__w5500_frame_get(t, FRAME_CRC_LEN, f->cnf.big_endian) != __w5500_frame_crc(frame->data, frame->len)) {
+      // The length was sound, so the stream is still in step: drop just this one
+      f->stat.crc_errors++;
+      LOG_WARNING("W5500 :: Frame CRC mismatch");
+      return;
+    }
+  }
+  f->stat.frames++;
+  f->stat.bytes += frame->len;
+  f->count++;
+  f->on_frame(frame, f->arg);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Parse the data waiting in the chip, callback of w5500_client_receive_view().
+ *
+ * @return Bytes of the complete frames, released with one RECV.
+ */
+static uint16_t __w5500_frame_parse (wiz_StreamView* view, void* arg) {
+  W5500_Framer_t* f = (W5500_Framer_t*)arg;
+  W5500_Frame_t frame;
+  uint8_t hdr = f->cnf.prefix;
+  uint8_t trl = f->cnf.crc ? FRAME_CRC_LEN : 0;
+  uint16_t done = 0;
+  frame.view = view;
+  while (view->len - done >= hdr) {
+    if (f->buf != NULL) {
+      // One burst of as much as fits, then every frame whole in it
+      uint16_t left = view->len - done;
+      uint16_t chunk = (left < f->size) ? left : f->size;
+      uint16_t p = 0;
+      stream_read(view, done, f->buf, chunk);
+      f->stat.bursts++;
+      while (chunk - p >= hdr) {
+        uint32_t len = __w5500_frame_get(&f->buf[p], hdr, f->cnf.big_endian);
+        uint32_t need = hdr + len + trl;
+        if (!__w5500_frame_check(f, len, need)) {
+          return done + p;
+        }
+        if (need > (uint32_t)(chunk - p)) {
+          break;
+        }
+        frame.len = (uint16_t)len;
+        frame.data = &f->buf[p + hdr];
+        frame.offset = done + p + hdr;
+        __w5500_frame_deliver(f, &frame);
+        p += need;
+      }
+      done += p;
+      // Nothing whole yet, or all the data seen: the tail waits in the chip
+      if (p == 0 || chunk == left) {
+        break;
+      }
+    }
+    else {
+      uint8_t head[4];
+      stream_read(view, done, head, hdr);
+      f->stat.bursts++;
+      uint32_t len = __w5500_frame_get(head, hdr, f->cnf.big_endian);
+      uint32_t need = hdr + len;
+      if (!__w5500_frame_check(f, len, need)) {
+        break;
+      }
+      if (need > (uint32_t)(view->len - done)) {
+        break;
+      }
+      frame.len = (uint16_t)len;
+      frame.data = NULL;
+      frame.offset = done + hdr;
+      __w5500_frame_deliver(f, &frame);
+      done += need;
+    }
+  }
+  return done;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Initialize a framer.
+ *
+ * @param[out] f        Framer.
+ * @param[in]  cnf      Prefix, byte order, CRC and largest payload.
+ * @param[in]  buf      Copy buffer, at least max_len plus the prefix and CRC;
+ *                      NULL to leave the payloads in the chip (no CRC then).
+ * @param[in]  size     Size of buf; the larger, the fewer bursts.
+ * @param[in]  on_frame Handler of each frame. The frame is valid only inside it.
+ * @param[in]  arg      User argument passed to on_frame.
+ *
+ * @return false if the configuration is not usable.
+ */
+bool w5500_frame_init (W5500_Framer_t* f, const W5500_FrameCnf_t* cnf, uint8_t* buf, uint16_t size,
+                       void (*on_frame)(const W5500_Frame_t* frame, void* arg), void* arg) {
+  if (f == NULL || cnf == NULL || on_frame == NULL) {
+    return false;
+  }
+  if (cnf->prefix != 1 && cnf->prefix != 2 && cnf->prefix != 4) {
+    LOG_ERROR("W5500 :: Frame prefix must be 1, 2 or 4 bytes");
+    return false;
+  }
+  if (cnf->prefix == 1 && cnf->max_len > 0xFF) {
+    LOG_ERROR("W5500 :: Frame max_len exceeds the prefix");
+    return false;
+  }
+  uint32_t whole = (uint32_t)cnf->prefix + cnf->max_len + (cnf->crc ? FRAME_CRC_LEN : 0);
+  if ((buf == NULL && cnf->crc) || (buf != NULL && size < whole)) {
+    LOG_ERROR("W5500 :: Frame buffer too small");
+    return false;
+  }
+  *f = (W5500_Framer_t){0};
+  f->cnf = *cnf;
+  f->buf = buf;
+  f->size = size;
+  f->on_frame = on_frame;
+  f->arg = arg;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Deliver every complete frame received by a connection.
+ *
+ * Never waits. Call it from the service loop in place of w5500_client_receive().
+ *
+ * @param[in] f Framer.
+ * @param[in] h Connection handle.
+ *
+ * @return The number of frames delivered, 0 if none is complete yet.
+ * @return W5500_FRAME_ERR_SOCK if the receive failed or the handle is not open.
+ * @return W5500_FRAME_ERR_SYNC on a length out of range; the frames before it
+ *         are delivered, the connection should be reset.
+ */
+int32_t w5500_frame_process (W5500_Framer_t* f, W5500_Handle_t h) {
+  int8_t sn = w5500_client_getSocket(h);
+  if (f == NULL || sn < 0) {
+    return W5500_FRAME_ERR_SOCK;
+  }
+  if (f->rx_max == 0) {
+    f->rx_max = getSn_RxMAX(sn);
+  }
+  f->count = 0;
+  f->err = 0;
+  int32_t ret = w5500_client_receive_view(h, __w5500_frame_parse, f);
+  if (ret < 0) {
+    return W5500_FRAME_ERR_SOCK;
+  }
+  if (ret > 0) {
+    f->stat.recvs++;
+  }
+  return (f->err != 0) ? f->err : f->count;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Read a range of the payload of a frame left in the chip.
+ *
+ * Only from the frame handler. In buffer mode the payload is at frame->data.
+ *
+ * @param[in]  frame  Frame given to the handler.
+ * @param[in]  offset Payload offset to read from.
+ * @param[out] buf    Destination buffer.
+ * @param[in]  len    Bytes to read, trimmed to the end of the payload.
+ *
+ * @return Bytes read, 0 beyond the payload, or -1.
+ */
+int32_t w5500_frame_read (const W5500_Frame_t* frame, uint16_t offset, uint8_t* buf, uint16_t len) {
+  if (frame == NULL || buf == NULL) {
+    return -1;
+  }
+  if (offset >= frame->len) {
+    return 0;
+  }
+  if (len > frame->len - offset) {
+    len = frame->len - offset;
+  }
+  if (frame->data != NULL) {
+    for (uint16_t i = 0; i < len; i++) {
+      buf[i] = frame->data[offset + i];
+    }
+    return len;
+  }
+  return stream_read(frame->view, frame->offset + offset, buf, len);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Send one frame.
+ *
+ * The prefix, the payload and the CRC leave with a single SEND, without
+ * being put together in MCU RAM.
+ *
+ * @param[in] f   Framer.
+ * @param[in] h   Connection handle.
+ * @param[in] buf Payload.
+ * @param[in] len Payload length, up to max_len.
+ *
+ * @return The payload length on success.
+ * @return W5500_FRAME_ERR_BUSY if the frame does not fit in the TX memory yet; nothing was sent.
+ * @return W5500_FRAME_ERR_SOCK otherwise.
+ */
+int32_t w5500_frame_send (W5500_Framer_t* f, W5500_Handle_t h, uint8_t* buf, uint16_t len) {
+  uint8_t head[4];
+  uint8_t tail[FRAME_CRC_LEN];
+  wiz_IOVec iov[3];
+  uint8_t cnt = 0;
+  if (f == NULL || len > f->cnf.max_len || (buf == NULL && len != 0)) {
+    return W5500_FRAME_ERR_SOCK;
+  }
+  __w5500_frame_put(head, f->cnf.prefix, f->cnf.big_endian, len);
+  iov[cnt].buf = head;
+  iov[cnt++].len = f->cnf.prefix;
+  if (len != 0) {
+    iov[cnt].buf = buf;
+    iov[cnt++].len = len;
+  }
+  if (f->cnf.crc) {
+    __w5500_frame_put(tail, FRAME_CRC_LEN, f->cnf.big_endian, __w5500_frame_crc(buf, len));
+    iov[cnt].buf = tail;
+    iov[cnt++].len = FRAME_CRC_LEN;
+  }
+  int32_t ret = w5500_client_transmitv(h, iov, cnt);
+  if (ret < 0) {
+    return W5500_FRAME_ERR_SOCK;
+  }
+  // Non-block sockets: the frame goes whole or not at all
+  if (ret == 0) {
+    return W5500_FRAME_ERR_BUSY;
+  }
+  return len;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the statistics of a framer.
+ *
+ * @param[in]  f   Framer.
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_frame_getStat (const W5500_Framer_t* f, W5500_FrameStat_t* out) {
+  if (f != NULL && out != NULL) {
+    *out = f->stat;
+  }
+}
+//--------------------------------------------------------------------------
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file w5500_link.c
+ * @brief PHY link monitor of the W5500.
+ *
+ * The link, speed and duplex are sampled from PHYCFGR in one register read
+ * every W5500_LINK_SAMPLE_MS, or on the next w5500_link_process() after
+ * w5500_link_notify() (e.g. from the INTn or a PHY LED interrupt), and
+ * kept in a cache. Hot paths ask the cache with w5500_link_isUp() instead
+ * of going to the chip.
+ *
+ * On link loss every TCP connection is aborted at once by socket_linkdown():
+ * a pending connect or a queued send can't complete without the wire, and
+ * waiting for the retransmission timeout only delays the recovery. The
+ * registered callbacks are then told about the change.
+ *
+ * @note The W5500 has no link change interrupt, the sampling period bounds
+ *       the detection delay when nothing calls w5500_link_notify().
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_link.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_LINK_SAMPLE_MS == 0)
+#error "W5500_LINK_SAMPLE_MS can't be zero"
+#endif
+#if (W5500_LINK_CALLBACKS < 1)
+#error "W5500_LINK_CALLBACKS must be at least 1"
+#endif
+
+static W5500_LinkState_t state;
+static uint32_t sample_ts;
+static volatile bool notified;
+static void (*callbacks[W5500_LINK_CALLBACKS])(const W5500_LinkState_t* st);
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Read PHYCFGR and update the cache.
+ *
+ * @param[in] now Current time in microseconds.
+ *
+ * @return true if the link, speed or duplex changed.
+ */
+static bool __w5500_link_sample (uint32_t now) {
+  uint8_t phycfgr = getPHYCFGR();
+  bool up = (phycfgr & PHYCFGR_LNK_ON) != 0;
+  uint8_t speed = (phycfgr & PHYCFGR_SPD_100) ? PHY_SPEED_100 : PHY_SPEED_10;
+  uint8_t duplex = (phycfgr & PHYCFGR_DPX_FULL) ? PHY_DUPLEX_FULL : PHY_DUPLEX_HALF;
+  sample_ts = now;
+  state.samples++;
+  if (up == state.up && (!up || (speed == state.speed && duplex == state.duplex))) {
+    return false;
+  }
+  if (up != state.up) {
+    if (up) {
+      state.last_down_ms = (now - state.change_ts) / 1000;
+    }
+    state.changes++;
+    state.change_ts = now;
+  }
+  state.up = up;
+  state.speed = speed;
+  state.duplex = duplex;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Initialize the link monitor with a first read of PHYCFGR.
+ *
+ * Never waits for the link: a cable plugged in later is picked up by
+ * w5500_link_process(). The registered callbacks are kept.
+ */
+void w5500_link_init (void) {
+  uint32_t now = W5500_GetMicros();
+  state = (W5500_LinkState_t){0};
+  state.change_ts = now;
+  notified = false;
+  __w5500_link_sample(now);
+  state.changes = 0;
+  if (state.up) {
+    LOG_INFO("W5500 :: Link up, %s %s duplex", (state.speed == PHY_SPEED_100) ? "100M" : "10M",
+             (state.duplex == PHY_DUPLEX_FULL) ? "full" : "half");
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Refresh the cached link state when it is due.
+ *
+ * Call it periodically from the service loop. PHYCFGR is read once per
+ * W5500_LINK_SAMPLE_MS, or at once after w5500_link_notify(). On link loss
+ * the TCP sockets are aborted before the callbacks run.
+ *
+ * @return true if the link is up.
+ */
+bool w5500_link_process (void) {
+  uint32_t now = W5500_GetMicros();
+  if (!notified && (now - sample_ts) / 1000 < W5500_LINK_SAMPLE_MS) {
+    return state.up;
+  }
+  notified = false;
+  if (!__w5500_link_sample(now)) {
+    return state.up;
+  }
+  if (state.up) {
+    LOG_INFO("W5500 :: Link up, %s %s duplex, down for %lu ms", (state.speed == PHY_SPEED_100) ? "100M" : "10M",
+             (state.duplex == PHY_DUPLEX_FULL) ? "full" : "half", state.last_down_ms);
+  }
+  else {
+    int8_t n = socket_linkdown();
+    state.aborted += (uint32_t)n;
+    LOG_WARNING("W5500 :: Link down, %d connection(s) aborted", n);
+  }
+  for (uint8_t i = 0; i < W5500_LINK_CALLBACKS; i++) {
+    if (callbacks[i] != NULL) {
+      callbacks[i](&state);
+    }
+  }
+  return state.up;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Request a PHYCFGR read on the next w5500_link_process().
+ *
+ * Safe to call from an interrupt, it only sets a flag.
+ */
+void w5500_link_notify (void) {
+  notified = true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the cached link status without accessing the chip.
+ *
+ * @return true if the link was up at the last sample.
+ */
+bool w5500_link_isUp (void) {
+  return state.up;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the cached link state and statistics.
+ *
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_link_get (W5500_LinkState_t* out) {
+  if (out != NULL) {
+    *out = state;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Register a callback for link up/down and speed/duplex changes.
+ *
+ * It is called from w5500_link_process() with the new state. On link
+ * loss the TCP sockets are already aborted when it runs.
+ *
+ * @param[in] cb Callback function.
+ *
+ * @return true if registered, false if all W5500_LINK_CALLBACKS slots are taken.
+ */
+bool w5500_link_regCallback (void (*cb)(const W5500_LinkState_t* st)) {
+  for (uint8_t i = 0; i < W5500_LINK_CALLBACKS; i++) {
+    if (callbacks[i] == cb) {
+      return true;
+    }
+  }
+  for (uint8_t i = 0; i < W5500_LINK_CALLBACKS; i++) {
+    if (callbacks[i] == NULL) {
+      callbacks[i] = cb;
+      return true;
+    }
+  }
+  return false;
+}
+//--------------------------------------------------------------------------
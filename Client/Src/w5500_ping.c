@@ -0,0 +1,375 @@
+/**
+ * @file w5500_ping.c
+ * @brief ICMP echo engine on an IPRAW socket of the W5500.
+ *
+ * One IPRAW socket (W5500_PING_SOCKET, protocol ICMP) is shared by up to
+ * W5500_PING_TARGETS targets. Each target gets an echo request every
+ * W5500_PING_PERIOD_MS; replies are matched by identifier (one per target),
+ * sequence number and source address. RTT min/avg/max, the RFC 3550 jitter
+ * and log2 histograms of both are kept per target.
+ *
+ * Requests leave in the asynchronous send mode, so an ARP resolution that
+ * never completes does not block the caller. The engine runs on its own
+ * socket context to keep those completions out of the application queue.
+ *
+ * The RTT is measured from the SEND command to the reply being read, so its
+ * resolution is the rate w5500_ping_process() runs at, at best W5500_GetMicros().
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_ping.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_PING_ENABLE==YES)
+
+#if (W5500_PING_TIMEOUT_MS > W5500_PING_PERIOD_MS)
+#error "W5500_PING_TIMEOUT_MS can't exceed W5500_PING_PERIOD_MS"
+#endif
+#if (W5500_PING_TARGETS > 16) || (W5500_PING_HIST_BINS < 2)
+#error "W5500_PING_TARGETS/W5500_PING_HIST_BINS invalid"
+#endif
+
+#define PING_ICMP_ECHO_REPLY          0
+#define PING_ICMP_ECHO_REQUEST        8
+#define PING_ICMP_HEADER              8
+#define PING_ID_BASE                  0x5750
+#define PING_DUMMY_PORT               1       // sendto() needs a port, ICMP has none
+
+typedef struct __W5500_PingTarget_s {
+  bool              active;
+  bool              pending;       // Request in flight, waiting for its reply
+  uint16_t          seq;
+  uint32_t          sent_ts;
+  uint32_t          next_ts;
+  uint64_t          rtt_sum_us;
+  W5500_PingStat_t  stat;
+} W5500_PingTarget_t;
+
+static wiz_SockCtx ping_ctx;
+static W5500_PingTarget_t targets[W5500_PING_TARGETS];
+static uint8_t payload[W5500_PING_PAYLOAD];
+static uint32_t payload_sum;
+static int8_t inflight = -1;   // Target of the request the chip is sending
+static bool opened = false;
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Histogram bin of a time value.
+ *
+ * @param[in] us Time in microseconds.
+ *
+ * @return 0 below W5500_PING_HIST_BASE_US, n for [2^(n-1), 2^n) x base, clamped to the last bin.
+ */
+static uint8_t __w5500_ping_bin (uint32_t us) {
+  uint8_t bin = 0;
+  us /= W5500_PING_HIST_BASE_US;
+  while (us != 0 && bin < W5500_PING_HIST_BINS - 1) {
+    us >>= 1;
+    bin++;
+  }
+  return bin;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Reset the statistics of a target, keeping its address.
+ *
+ * @param[in] t Target.
+ */
+static void __w5500_ping_clear (W5500_PingTarget_t* t) {
+  uint8_t ip[4] = {t->stat.ip[0], t->stat.ip[1], t->stat.ip[2], t->stat.ip[3]};
+  t->stat = (W5500_PingStat_t){0};
+  for (uint8_t i = 0; i < 4; i++) {
+    t->stat.ip[i] = ip[i];
+  }
+  t->stat.rtt_min_us = UINT32_MAX;
+  t->rtt_sum_us = 0;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Account the reply of the request in flight of a target.
+ *
+ * @param[in] t   Target.
+ * @param[in] rtt RTT of the reply in microseconds.
+ */
+static void __w5500_ping_sample (W5500_PingTarget_t* t, uint32_t rtt) {
+  W5500_PingStat_t* st = &t->stat;
+  if (st->received != 0) {
+    uint32_t d = (rtt > st->rtt_last_us) ? (rtt - st->rtt_last_us) : (st->rtt_last_us - rtt);
+    // J += (|D| - J) / 16
+    st->jitter_us = st->jitter_us + (d >> 4) - (st->jitter_us >> 4);
+    st->jitter_hist[__w5500_ping_bin(d)]++;
+  }
+  st->received++;
+  st->rtt_last_us = rtt;
+  t->rtt_sum_us += rtt;
+  if (rtt < st->rtt_min_us) {
+    st->rtt_min_us = rtt;
+  }
+  if (rtt > st->rtt_max_us) {
+    st->rtt_max_us = rtt;
+  }
+  st->rtt_hist[__w5500_ping_bin(rtt)]++;
+  t->pending = false;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Send the next echo request of a target.
+ *
+ * The checksum is the precomputed payload sum plus the three header words.
+ *
+ * @param[in] idx Target index.
+ *
+ * @return true if the request left, false if the socket is still busy.
+ */
+static bool __w5500_ping_send (uint8_t idx) {
+  W5500_PingTarget_t* t = &targets[idx];
+  uint8_t head[PING_ICMP_HEADER];
+  uint16_t id = PING_ID_BASE + idx;
+  uint16_t seq = t->seq + 1;
+  uint32_t sum = payload_sum + ((uint32_t)PING_ICMP_ECHO_REQUEST << 8) + id + seq;
+  while (sum >> 16) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  sum = ~sum & 0xFFFF;
+  head[0] = PING_ICMP_ECHO_REQUEST;
+  head[1] = 0;
+  head[2] = (uint8_t)(sum >> 8);
+  head[3] = (uint8_t)sum;
+  head[4] = (uint8_t)(id >> 8);
+  head[5] = (uint8_t)id;
+  head[6] = (uint8_t)(seq >> 8);
+  head[7] = (uint8_t)seq;
+  wiz_IOVec iov[2] = {
+    { .buf = head,    .len = PING_ICMP_HEADER },
+    { .buf = payload, .len = W5500_PING_PAYLOAD },
+  };
+  int32_t ret = sendtov_ctx(&ping_ctx, W5500_PING_SOCKET, iov, 2, t->stat.ip, PING_DUMMY_PORT);
+  if (ret == SOCK_BUSY) {
+    return false;
+  }
+  t->seq = seq;
+  t->stat.sent++;
+  if (ret < 0) {
+    // Failed without leaving (e.g. unreachable destination cached): lost right away
+    t->stat.lost++;
+    return true;
+  }
+  t->sent_ts = W5500_GetMicros();
+  t->pending = true;
+  inflight = (int8_t)idx;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Read all pending ICMP packets and match the echo replies.
+ */
+static void __w5500_ping_receive (void) {
+  uint8_t buf[PING_ICMP_HEADER + W5500_PING_PAYLOAD];
+  uint8_t ip[4];
+  uint16_t port;
+  uint8_t alen;
+  uint16_t rem;
+  int32_t ret;
+  while ((ret = recvfrom_ctx(&ping_ctx, W5500_PING_SOCKET, buf, sizeof(buf), ip, &port, &alen)) > 0) {
+    uint32_t now = W5500_GetMicros();
+    // Drop the rest of a longer packet, the header already in buf is kept
+    while (getsockopt_ctx(&ping_ctx, W5500_PING_SOCKET, SO_REMAINSIZE, &rem) == SOCK_OK && rem != 0) {
+      uint8_t tmp[16];
+      uint8_t from[4];
+      recvfrom_ctx(&ping_ctx, W5500_PING_SOCKET, tmp, sizeof(tmp), from, &port, &alen);
+    }
+    if (ret < PING_ICMP_HEADER || buf[0] != PING_ICMP_ECHO_REPLY) {
+      continue;
+    }
+    uint16_t id = ((uint16_t)buf[4] << 8) | buf[5];
+    uint16_t seq = ((uint16_t)buf[6] << 8) | buf[7];
+    uint8_t idx = (uint8_t)(id - PING_ID_BASE);
+    if (id < PING_ID_BASE || idx >= W5500_PING_TARGETS) {
+      continue;
+    }
+    W5500_PingTarget_t* t = &targets[idx];
+    if (!t->active || !t->pending || seq != t->seq ||
+        ip[0] != t->stat.ip[0] || ip[1] != t->stat.ip[1] || ip[2] != t->stat.ip[2] || ip[3] != t->stat.ip[3]) {
+      continue;
+    }
+    __w5500_ping_sample(t, now - t->sent_ts);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Open the ICMP socket of the engine.
+ *
+ * Call after the chip and the network are configured. The socket context of
+ * the engine uses the chip and the wait hook the application uses.
+ *
+ * @return true if the socket is open.
+ */
+bool w5500_ping_init (void) {
+  uint8_t mode = SOCK_SEND_ASYNC;
+  uint32_t sum = 0;
+  socket_ctx_init(&ping_ctx, socket_ctx_default()->chip);
+  ping_ctx.poll_wait = socket_ctx_default()->poll_wait;
+  for (uint16_t i = 0; i < W5500_PING_PAYLOAD; i++) {
+    payload[i] = (uint8_t)('a' + (i % 23));
+    sum += (i & 1) ? payload[i] : ((uint32_t)payload[i] << 8);
+  }
+  payload_sum = sum;
+  for (uint8_t i = 0; i < W5500_PING_TARGETS; i++) {
+    targets[i].active = false;
+  }
+  opened = false;
+  inflight = -1;
+  setSn_PROTO(W5500_PING_SOCKET, IPPROTO_ICMP);
+  if (socket_ctx(&ping_ctx, W5500_PING_SOCKET, Sn_MR_IPRAW, 0, SF_IO_NONBLOCK) != W5500_PING_SOCKET) {
+    LOG_ERROR("W5500 :: Failed to open the ICMP socket");
+    return false;
+  }
+  ctlsocket_ctx(&ping_ctx, W5500_PING_SOCKET, CS_SET_SENDMODE, &mode);
+  opened = true;
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Start pinging a target.
+ *
+ * @param[in] ip Target address.
+ *
+ * @return Target index, the one already used by ip if any, or -1 if the table is full.
+ */
+int8_t w5500_ping_addTarget (const uint8_t ip[4]) {
+  int8_t free_idx = -1;
+  for (uint8_t i = 0; i < W5500_PING_TARGETS; i++) {
+    W5500_PingTarget_t* t = &targets[i];
+    if (!t->active) {
+      if (free_idx < 0) {
+        free_idx = (int8_t)i;
+      }
+      continue;
+    }
+    if (t->stat.ip[0] == ip[0] && t->stat.ip[1] == ip[1] && t->stat.ip[2] == ip[2] && t->stat.ip[3] == ip[3]) {
+      return (int8_t)i;
+    }
+  }
+  if (free_idx < 0) {
+    LOG_WARNING("W5500 :: Ping target table full");
+    return -1;
+  }
+  W5500_PingTarget_t* t = &targets[free_idx];
+  for (uint8_t i = 0; i < 4; i++) {
+    t->stat.ip[i] = ip[i];
+  }
+  __w5500_ping_clear(t);
+  t->pending = false;
+  t->seq = 0;
+  t->next_ts = W5500_GetMicros();
+  t->active = true;
+  return free_idx;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Stop pinging a target.
+ *
+ * @param[in] idx Target index.
+ */
+void w5500_ping_removeTarget (uint8_t idx) {
+  if (idx < W5500_PING_TARGETS) {
+    targets[idx].active = false;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Run the engine: match replies, expire requests and send the due ones.
+ *
+ * Never blocks. Call it often; the call rate bounds the RTT resolution.
+ */
+void w5500_ping_process (void) {
+  wiz_SendEvent ev;
+  if (!opened) {
+    return;
+  }
+  // A request whose ARP resolution failed, or to an unreachable host, never gets a reply
+  while (sendcompletion_ctx(&ping_ctx, &ev) == SOCK_OK) {
+    if (ev.ir != Sn_IR_SENDOK && inflight >= 0 && targets[inflight].pending) {
+      targets[inflight].pending = false;
+      targets[inflight].stat.lost++;
+    }
+    inflight = -1;
+  }
+  __w5500_ping_receive();
+  uint32_t now = W5500_GetMicros();
+  for (uint8_t i = 0; i < W5500_PING_TARGETS; i++) {
+    W5500_PingTarget_t* t = &targets[i];
+    if (!t->active) {
+      continue;
+    }
+    if (t->pending && (now - t->sent_ts) >= (uint32_t)W5500_PING_TIMEOUT_MS * 1000) {
+      t->pending = false;
+      t->stat.lost++;
+    }
+    if ((int32_t)(now - t->next_ts) < 0 || t->pending) {
+      continue;
+    }
+    if (!__w5500_ping_send(i)) {
+      // One request in flight on the socket at a time, the others follow on the next calls
+      break;
+    }
+    t->next_ts += (uint32_t)W5500_PING_PERIOD_MS * 1000;
+    if ((int32_t)(now - t->next_ts) >= 0) {
+      t->next_ts = now + (uint32_t)W5500_PING_PERIOD_MS * 1000;
+    }
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the statistics of a target.
+ *
+ * @param[in]  idx Target index.
+ * @param[out] out Pointer to the structure to fill.
+ *
+ * @return false if idx is not an active target.
+ */
+bool w5500_ping_getStat (uint8_t idx, W5500_PingStat_t* out) {
+  if (idx >= W5500_PING_TARGETS || !targets[idx].active || out == NULL) {
+    return false;
+  }
+  *out = targets[idx].stat;
+  if (out->received == 0) {
+    out->rtt_min_us = 0;
+  }
+  else {
+    out->rtt_avg_us = (uint32_t)(targets[idx].rtt_sum_us / out->received);
+  }
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Reset the statistics of a target.
+ *
+ * @param[in] idx Target index.
+ */
+void w5500_ping_resetStat (uint8_t idx) {
+  if (idx < W5500_PING_TARGETS) {
+    __w5500_ping_clear(&targets[idx]);
+  }
+}
+//--------------------------------------------------------------------------
+#endif
@@ -0,0 +1,346 @@
+/**
+ * @file w5500_reconn.c
+ * @brief Non-blocking TCP reconnect manager for the W5500.
+ *
+ * Each call of w5500_reconn_process() does at most one step and never waits
+ * on the chip: CONNECT is issued in non-block mode and the handshake is
+ * checked on the following calls. A failed attempt doubles the delay before
+ * the next one, from W5500_RECONN_DELAY_MIN_MS up to W5500_RECONN_DELAY_MAX_MS,
+ * spread by +/- W5500_RECONN_JITTER_PERCENT so many devices recovering from
+ * the same outage do not retry in step.
+ *
+ * No attempt is made while the PHY link is down, as cached by the link
+ * monitor; a connection or attempt in progress is dropped when the link
+ * goes, without counting as a failure. When it comes back the backoff is
+ * reset and the next attempt starts at once.
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_reconn.h"
+#include "w5500_link.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if W5500_USE_FreeRTOS == YES
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#if (W5500_RECONN_DELAY_MIN_MS == 0) || (W5500_RECONN_DELAY_MIN_MS > W5500_RECONN_DELAY_MAX_MS)
+#error "W5500_RECONN_DELAY_MIN_MS/W5500_RECONN_DELAY_MAX_MS invalid"
+#endif
+#if (W5500_RECONN_JITTER_PERCENT > 100)
+#error "W5500_RECONN_JITTER_PERCENT can't exceed 100"
+#endif
+
+static uint32_t rand_state;
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Next value of a xorshift32 generator, seeded from the clock and the MAC on first use.
+ */
+static uint32_t __w5500_reconn_rand (void) {
+  if (rand_state == 0) {
+    // Devices powered up together read the same clock, their MACs differ
+    uint8_t mac[6];
+    getSHAR(mac);
+    rand_state = W5500_GetMicros() ^ (((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5]);
+    rand_state |= 1;
+  }
+  rand_state ^= rand_state << 13;
+  rand_state ^= rand_state >> 17;
+  rand_state ^= rand_state << 5;
+  return rand_state;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Spread a delay by +/- W5500_RECONN_JITTER_PERCENT.
+ *
+ * @param[in] delay_ms Nominal delay.
+ *
+ * @return Delay to wait in milliseconds.
+ */
+static uint32_t __w5500_reconn_jitter (uint32_t delay_ms) {
+  uint32_t spread = delay_ms * W5500_RECONN_JITTER_PERCENT / 100;
+  if (spread == 0) {
+    return delay_ms;
+  }
+  return delay_ms - spread + (__w5500_reconn_rand() % (2 * spread + 1));
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Account a failed attempt and schedule the next one.
+ *
+ * @param[in] rc  Reconnect manager.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_reconn_fail (W5500_Reconn_t* rc, uint32_t now) {
+  uint32_t wait = __w5500_reconn_jitter(rc->delay_ms);
+  rc->stat.failures++;
+  rc->failed = true;
+  rc->fail_ts = now;
+  rc->next_ts = now + wait * 1000;
+  rc->delay_ms = (rc->delay_ms > W5500_RECONN_DELAY_MAX_MS / 2) ? W5500_RECONN_DELAY_MAX_MS : (rc->delay_ms << 1);
+  rc->state = W5500_RECONN_DOWN;
+  LOG_WARNING("W5500 :: Socket %u connect failed, retry in %lu ms", rc->sn, wait);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Mark the connection lost and schedule an immediate first attempt.
+ *
+ * @param[in] rc  Reconnect manager.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_reconn_down (W5500_Reconn_t* rc, uint32_t now) {
+  rc->state = W5500_RECONN_DOWN;
+  rc->failed = false;
+  rc->down_ts = now;
+  rc->next_ts = now;
+  rc->delay_ms = W5500_RECONN_DELAY_MIN_MS;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Bring the socket back to SOCK_CLOSED without waiting.
+ *
+ * A connection on its way down gets a graceful shutdown, anything else is closed.
+ *
+ * @param[in] rc     Reconnect manager.
+ * @param[in] status Current Sn_SR of the socket.
+ *
+ * @return true once the socket is closed.
+ */
+static bool __w5500_reconn_release (W5500_Reconn_t* rc, uint8_t status) {
+  if (status == SOCK_CLOSED) {
+    return true;
+  }
+  if (status == SOCK_CLOSE_WAIT || status == SOCK_FIN_WAIT || status == SOCK_CLOSING ||
+      status == SOCK_TIME_WAIT || status == SOCK_LAST_ACK) {
+    return (disconnect_async(rc->sn, W5500_SHUTDOWN_LINGER_MS) != SOCK_BUSY);
+  }
+  close(rc->sn);
+  return true;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Open the socket and issue CONNECT in non-block mode.
+ *
+ * The socket is returned to block mode right after, only the CONNECT
+ * itself does not wait.
+ *
+ * @param[in] rc  Reconnect manager.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_reconn_attempt (W5500_Reconn_t* rc, uint32_t now) {
+  uint8_t mode = SOCK_IO_BLOCK;
+  if (socket(rc->sn, Sn_MR_TCP, 0, SF_IO_NONBLOCK) != rc->sn) {
+    LOG_ERROR("W5500 :: Failed to create socket %u", rc->sn);
+    __w5500_reconn_fail(rc, now);
+    return;
+  }
+  rc->stat.attempts++;
+  rc->attempt_ts = now;
+  int8_t ret = connect(rc->sn, rc->dest_ip, rc->port);
+  ctlsocket(rc->sn, CS_SET_IOMODE, &mode);
+  if (ret != SOCK_BUSY && ret != SOCK_OK) {
+    close(rc->sn);
+    __w5500_reconn_fail(rc, now);
+    return;
+  }
+  rc->state = W5500_RECONN_CONNECTING;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Account an established connection.
+ *
+ * @param[in] rc  Reconnect manager.
+ * @param[in] now Current time in microseconds.
+ */
+static void __w5500_reconn_up (W5500_Reconn_t* rc, uint32_t now) {
+  uint32_t ttr = (now - rc->down_ts) / 1000;
+  rc->stat.connects++;
+  if (rc->state == W5500_RECONN_CONNECTING) {
+    rc->stat.last_handshake_us = now - rc->attempt_ts;
+  }
+  rc->stat.last_ttr_ms = ttr;
+  rc->stat.total_ttr_ms += ttr;
+  if (ttr > rc->stat.max_ttr_ms) {
+    rc->stat.max_ttr_ms = ttr;
+  }
+  rc->stat.last_recovery_ms = rc->failed ? (now - rc->fail_ts) / 1000 : 0;
+  rc->state = W5500_RECONN_UP;
+  LOG_INFO("W5500 :: Socket %u connected, %lu ms after the loss", rc->sn, ttr);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Initialize a reconnect manager.
+ *
+ * The first attempt is made on the next w5500_reconn_process(). A socket
+ * connected meanwhile by a blocking connect() is taken over as established.
+ *
+ * @param[out] rc   Reconnect manager.
+ * @param[in]  sn   Socket of the connection.
+ * @param[in]  ip   Server address.
+ * @param[in]  port Server port.
+ */
+void w5500_reconn_init (W5500_Reconn_t* rc, uint8_t sn, const uint8_t ip[4], uint16_t port) {
+  uint32_t now = W5500_GetMicros();
+  *rc = (W5500_Reconn_t){0};
+  rc->sn = sn;
+  for (uint8_t i = 0; i < 4; i++) {
+    rc->dest_ip[i] = ip[i];
+  }
+  rc->port = port;
+  rc->link = true;
+  __w5500_reconn_down(rc, now);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Advance the reconnect state machine by one step.
+ *
+ * Call it periodically from the service loop, after w5500_link_process().
+ * It never blocks: a few register reads per call, plus the socket commands
+ * of an attempt when one is due.
+ *
+ * @param[in] rc Reconnect manager.
+ *
+ * @return Connection state after the step.
+ */
+W5500_ReconnState_t w5500_reconn_process (W5500_Reconn_t* rc) {
+  uint32_t now = W5500_GetMicros();
+  bool up = w5500_link_isUp();
+  // Link lost: whatever was in progress can't complete, start over once it is back
+  if (!up && rc->state != W5500_RECONN_DOWN) {
+    if (socket_check(rc->sn) != SOCK_CLOSED) {
+      close(rc->sn);
+    }
+    LOG_WARNING("W5500 :: Socket %u dropped on link loss", rc->sn);
+    __w5500_reconn_down(rc, now);
+  }
+  // Link just came back: the backoff built up while it was down is void
+  if (up && !rc->link && rc->state == W5500_RECONN_DOWN) {
+    rc->stat.link_ups++;
+    rc->next_ts = now;
+    rc->delay_ms = W5500_RECONN_DELAY_MIN_MS;
+  }
+  rc->link = up;
+
+  switch (rc->state) {
+    case W5500_RECONN_UP:
+      if (socket_check(rc->sn) == SOCK_ESTABLISHED) {
+        break;
+      }
+      LOG_WARNING("W5500 :: Socket %u connection lost", rc->sn);
+      __w5500_reconn_down(rc, now);
+      break;
+    case W5500_RECONN_DOWN: {
+      uint8_t status = (uint8_t)socket_check(rc->sn);
+      if (status == SOCK_ESTABLISHED) {
+        __w5500_reconn_up(rc, now);
+        break;
+      }
+      if (!up || (int32_t)(now - rc->next_ts) < 0) {
+        break;
+      }
+      if (__w5500_reconn_release(rc, status)) {
+        __w5500_reconn_attempt(rc, now);
+      }
+      break;
+    }
+    case W5500_RECONN_CONNECTING: {
+      uint8_t status = (uint8_t)socket_check(rc->sn);
+      if (status == SOCK_ESTABLISHED) {
+        __w5500_reconn_up(rc, now);
+      }
+      else if (status != SOCK_SYNSENT && status != SOCK_INIT) {
+        // Refused (RST) or Sn_IR_TIMEOUT: the chip closed the socket
+        close(rc->sn);
+        __w5500_reconn_fail(rc, now);
+      }
+      else if ((now - rc->attempt_ts) / 1000 >= W5500_RECONN_CONNECT_TIMEOUT_MS) {
+        close(rc->sn);
+        __w5500_reconn_fail(rc, now);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return rc->state;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Drop the pending backoff and attempt on the next step.
+ *
+ * For callers that know the server is back, e.g. from a ping reply.
+ *
+ * @param[in] rc Reconnect manager.
+ */
+void w5500_reconn_kick (W5500_Reconn_t* rc) {
+  if (rc->state == W5500_RECONN_DOWN) {
+    rc->next_ts = W5500_GetMicros();
+    rc->delay_ms = W5500_RECONN_DELAY_MIN_MS;
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Start the connection over at once, without counting a failure.
+ *
+ * For a connection the local side broke, e.g. by a new address: the server
+ * is fine, so the attempt is made on the next step with the backoff reset.
+ *
+ * @param[in] rc Reconnect manager.
+ */
+void w5500_reconn_restart (W5500_Reconn_t* rc) {
+  if (socket_check(rc->sn) != SOCK_CLOSED) {
+    close(rc->sn);
+  }
+  LOG_INFO("W5500 :: Socket %u restarted", rc->sn);
+  __w5500_reconn_down(rc, W5500_GetMicros());
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Change the server of the connection.
+ *
+ * Takes effect on the next attempt, made at once if the connection is down.
+ * The backoff is kept, so cycling through servers that are all down still
+ * slows down. An established connection or an attempt in progress is left alone.
+ *
+ * @param[in] rc   Reconnect manager.
+ * @param[in] ip   Server address.
+ * @param[in] port Server port.
+ */
+void w5500_reconn_setDest (W5500_Reconn_t* rc, const uint8_t ip[4], uint16_t port) {
+  for (uint8_t i = 0; i < 4; i++) {
+    rc->dest_ip[i] = ip[i];
+  }
+  rc->port = port;
+  if (rc->state == W5500_RECONN_DOWN) {
+    rc->next_ts = W5500_GetMicros();
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get the reconnect statistics.
+ *
+ * @param[in]  rc  Reconnect manager.
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_reconn_getStat (const W5500_Reconn_t* rc, W5500_ReconnStat_t* out) {
+  if (rc != NULL && out != NULL) {
+    *out = rc->stat;
+  }
+}
+//--------------------------------------------------------------------------
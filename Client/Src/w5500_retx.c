@@ -0,0 +1,231 @@
+/**
+ * @file w5500_retx.c
+ * @brief RTT-adaptive retransmission timer management for the W5500.
+ *
+ * The W5500 retransmits unacknowledged TCP segments after RTR (100us units)
+ * and gives up after RCR retries. Both registers are chip-global. This
+ * module estimates the connection RTT (RFC 6298 style SRTT/RTTVAR) from
+ * connect timing and SEND to SEND_OK intervals, derives RTR from it and
+ * picks the smallest RCR that still covers W5500_RETX_DEAD_PEER_MS.
+ *
+ * Samples reported as not exact are upper bounds of the real RTT. Below
+ * the RTO the late observation explains them, so they only seed the
+ * estimator or pull it down; one beyond the RTO means the timer no longer
+ * covers the path and it is taken as is. A SEND timeout doubles the RTO
+ * (RFC 6298 5.5) until the next sample.
+ *
+ * The samples need a microsecond W5500_GetMicros(). With the tick based
+ * one a LAN round trip reads as 0 or 1000 us, so W5500_RETX_ADAPTIVE
+ * follows W5500_MICROS_USE_DWT and RTR/RCR keep the chip defaults.
+ *
+ * @author AMIR HOSEIN BAGHERI (Whitewolf97@yahoo.com)
+ * @date 2025-08-12
+ */
+
+#include <stddef.h>
+#include "w5500_retx.h"
+#include "w5500_config.h"
+#include "socket.h"
+
+#if W5500_TRACE_ENABLE == YES
+  #include "serial_debugger.h"
+#else
+  #define LOG_TRACE(...)
+  #define LOG_INFO(...)
+  #define LOG_WARNING(...)
+  #define LOG_ERROR(...)
+  #define LOG_FATAL(...)
+#endif
+
+#if (W5500_RETX_ADAPTIVE==YES)
+
+#if (W5500_RETX_RTR_MAX_US > 6553500) || (W5500_RETX_RTR_MIN_US < 100)
+#error "W5500_RETX_RTR_MIN_US/W5500_RETX_RTR_MAX_US out of the RTR range"
+#endif
+#if (W5500_RETX_RCR_MIN > W5500_RETX_RCR_MAX) || (W5500_RETX_RCR_MAX > 255)
+#error "W5500_RETX_RCR_MIN/W5500_RETX_RCR_MAX invalid"
+#endif
+
+#define RETX_RTR_MAX                  0xFFFF
+#define RETX_CLOCK_GRANULARITY_US     100     // RTR unit, W5500_GetMicros() is finer
+
+static W5500_RetxStat_t stat;
+
+//--------------------------------------------------------------------------
+/**
+ * @brief Compute the TCP give-up time of the chip for a given RTR/RCR pair.
+ *
+ * Follows the W5500 datasheet: the retry time doubles on each retransmission
+ * until it would exceed 0xFFFF, then stays there.
+ *
+ * @param[in] rtr Retry time in 100us units.
+ * @param[in] rcr Retry count.
+ *
+ * @return Give-up time in milliseconds.
+ */
+static uint32_t __w5500_retx_deadPeerMs (uint16_t rtr, uint8_t rcr) {
+  uint32_t total = 0;
+  uint32_t t = rtr;
+  for (uint16_t n = 0; n <= rcr; n++) {
+    total += t;
+    if ((t << 1) <= RETX_RTR_MAX) {
+      t <<= 1;
+    }
+  }
+  return total / 10;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Estimate how many retransmissions a SEND needed before SEND_OK.
+ *
+ * @param[in] elapsed_us Time from SEND to SEND_OK.
+ *
+ * @return Number of retry periods that expired before the acknowledgement.
+ */
+static uint32_t __w5500_retx_countRetries (uint32_t elapsed_us) {
+  uint32_t n = 0;
+  uint32_t t = (uint32_t)stat.rtr * 100;
+  uint32_t total = t;
+  while (total < elapsed_us && n < stat.rcr) {
+    n++;
+    if ((t << 1) <= (uint32_t)RETX_RTR_MAX * 100) {
+      t <<= 1;
+    }
+    total += t;
+  }
+  return n;
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Write RTR/RCR to the chip and refresh the reported values.
+ *
+ * @param[in] rtr Retry time in 100us units.
+ * @param[in] rcr Retry count.
+ */
+static void __w5500_retx_apply (uint16_t rtr, uint8_t rcr) {
+  setRTR(rtr);
+  setRCR(rcr);
+  stat.rtr = rtr;
+  stat.rcr = rcr;
+  stat.dead_peer_ms = __w5500_retx_deadPeerMs(rtr, rcr);
+  stat.updates++;
+  LOG_INFO("W5500 :: RTR %u x100us, RCR %u, dead peer %lu ms", rtr, rcr, stat.dead_peer_ms);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Derive RTR/RCR from a retry time and reapply them on drift.
+ *
+ * @param[in] rto Retry time in microseconds.
+ */
+static void __w5500_retx_program (uint32_t rto) {
+  if (rto < W5500_RETX_RTR_MIN_US) {
+    rto = W5500_RETX_RTR_MIN_US;
+  }
+  else if (rto > W5500_RETX_RTR_MAX_US) {
+    rto = W5500_RETX_RTR_MAX_US;
+  }
+  stat.rto_us = rto;
+  uint16_t rtr = (uint16_t)(rto / 100);
+  uint8_t rcr = W5500_RETX_RCR_MIN;
+  while (rcr < W5500_RETX_RCR_MAX && __w5500_retx_deadPeerMs(rtr, rcr) < W5500_RETX_DEAD_PEER_MS) {
+    rcr++;
+  }
+  uint32_t diff = (rtr > stat.rtr) ? (rtr - stat.rtr) : (stat.rtr - rtr);
+  if (rcr != stat.rcr || diff * 100 > (uint32_t)stat.rtr * W5500_RETX_DRIFT_PERCENT) {
+    __w5500_retx_apply(rtr, rcr);
+  }
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Derive RTR/RCR from the current estimate.
+ */
+static void __w5500_retx_update (void) {
+  uint32_t var = stat.rttvar_us << 2;
+  if (var < RETX_CLOCK_GRANULARITY_US) {
+    var = RETX_CLOCK_GRANULARITY_US;
+  }
+  __w5500_retx_program(stat.srtt_us + var);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Initialize the retransmission manager and program the startup RTR/RCR.
+ *
+ * The starting point is the upper bound, so an unknown path is not hit
+ * with spurious retransmissions before the first RTT sample arrives.
+ * The SEND completion hook of the socket layer is registered here.
+ */
+void w5500_retx_init (void) {
+  uint8_t rcr = W5500_RETX_RCR_MIN;
+  uint16_t rtr = (uint16_t)(W5500_RETX_RTR_MAX_US / 100);
+  stat = (W5500_RetxStat_t){0};
+  while (rcr < W5500_RETX_RCR_MAX && __w5500_retx_deadPeerMs(rtr, rcr) < W5500_RETX_DEAD_PEER_MS) {
+    rcr++;
+  }
+  stat.rto_us = W5500_RETX_RTR_MAX_US;
+  __w5500_retx_apply(rtr, rcr);
+  stat.updates = 0;
+  reg_socket_sendok_cbfunc(w5500_retx_onSendDone);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Feed one RTT sample into the estimator.
+ *
+ * @param[in] rtt_us Measured round trip time in microseconds.
+ * @param[in] exact  false if rtt_us is only an upper bound of the real RTT
+ *                   (e.g. a completion noticed late); such samples are used
+ *                   to seed the estimator, when they lower it, or when they
+ *                   exceed the RTO.
+ */
+void w5500_retx_sample (uint32_t rtt_us, bool exact) {
+  if (stat.samples == 0) {
+    stat.srtt_us = rtt_us;
+    stat.rttvar_us = rtt_us >> 1;
+  }
+  else {
+    if (!exact && rtt_us >= stat.srtt_us && rtt_us <= stat.rto_us) {
+      return;
+    }
+    uint32_t err = (rtt_us > stat.srtt_us) ? (rtt_us - stat.srtt_us) : (stat.srtt_us - rtt_us);
+    stat.rttvar_us = stat.rttvar_us - (stat.rttvar_us >> 2) + (err >> 2);
+    stat.srtt_us = stat.srtt_us - (stat.srtt_us >> 3) + (rtt_us >> 3);
+  }
+  stat.samples++;
+  __w5500_retx_update();
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief SEND completion hook registered with the socket layer.
+ *
+ * @param[in] sn         Socket number.
+ * @param[in] ir         Sn_IR_SENDOK or Sn_IR_TIMEOUT.
+ * @param[in] elapsed_us Time from SEND to the observed completion.
+ * @param[in] exact      Non-zero if elapsed_us is a real RTT sample.
+ */
+void w5500_retx_onSendDone (uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact) {
+  (void)sn;
+  if (ir & Sn_IR_TIMEOUT) {
+    stat.timeouts++;
+    stat.retransmits += stat.rcr;
+    LOG_WARNING("W5500 :: Socket %u SEND timeout after %lu us", sn, elapsed_us);
+    // The timer did not cover the path: back off until a sample says otherwise
+    __w5500_retx_program(stat.rto_us << 1);
+    return;
+  }
+  if (exact) {
+    stat.retransmits += __w5500_retx_countRetries(elapsed_us);
+  }
+  w5500_retx_sample(elapsed_us, exact != 0);
+}
+//--------------------------------------------------------------------------
+/**
+ * @brief Get a snapshot of the retransmission manager state.
+ *
+ * @param[out] out Pointer to the structure to fill.
+ */
+void w5500_retx_getStat (W5500_RetxStat_t* out) {
+  if (out != NULL) {
+    *out = stat;
+  }
+}
+//--------------------------------------------------------------------------
+#endif
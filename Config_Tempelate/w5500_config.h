@@ -73,10 +73,19 @@
 #define W5500_TASK_STACK_SIZE_BYTES        1024
 #define W5500_TASK_PRIORITY                1
 #define W5500_TASK_FREQUENCY_PERIOD        100
+#define W5500_POLL_USE_INT                 YES     /// INTn wired, FreeRTOS_w5500_irqHandler() called from its falling edge interrupt
+#define W5500_POLL_PERIOD                  10      /// Longest sleep between readiness sweeps, also with INTn (ms)
 #else 
 #define W5500_GetTick                      HAL_GetTick
 #define W5500_Delay                        HAL_Delay
 #endif      
+#define W5500_MICROS_USE_DWT               YES     /// W5500_GetMicros() from the DWT cycle counter (w5500_micros()), NO for whole ticks
+#if (W5500_MICROS_USE_DWT==YES)
+#define W5500_GetMicros()                  w5500_micros()
+uint32_t w5500_micros (void);
+#else
+#define W5500_GetMicros()                  (W5500_GetTick() * 1000U)
+#endif
       
 #define W5500_USER_NETWORK_CONFIG          NO
 #if (W5500_USER_NETWORK_CONFIG==NO)
@@ -84,6 +93,7 @@
 #define W5500_PORT                         5000
 #define W5500_OWN_IP                       192,   168,    1,    4
 #define W5500_DESTINATION_IP               192,   168,    1,    2
+#define W5500_DESTINATION_HOST             NULL   /// Server host name, resolved on each reconnect instead of W5500_DESTINATION_IP; NULL for none
 #define W5500_SUBNET                       255,   255,  255,    0
 #define W5500_GATEWAY                      192,   168,    1,    1
 #define W5500_DNS                            8,     8,    8,    8
@@ -93,6 +103,78 @@
 #define W5500_RETRY_CONN_DELAY             5
 #define W5500_RETRY_COUNTS                 2  
 
+#define W5500_RETX_ADAPTIVE                W5500_MICROS_USE_DWT  /// Needs microsecond samples: tick based ones are 0 or 1000 us on a LAN
+#if (W5500_RETX_ADAPTIVE==YES)
+#define W5500_RETX_RTR_MIN_US              2000    /// Lower bound of the retry time (RTR)
+#define W5500_RETX_RTR_MAX_US              400000  /// Upper bound of the retry time (RTR), max 6553500
+#define W5500_RETX_RCR_MIN                 2       /// Lower bound of the retry count (RCR)
+#define W5500_RETX_RCR_MAX                 8       /// Upper bound of the retry count (RCR)
+#define W5500_RETX_DEAD_PEER_MS            3000    /// Target time to declare a silent peer dead
+#define W5500_RETX_DRIFT_PERCENT           25      /// Reapply RTR only when it drifts more than this
+#endif
+
+#define W5500_KEEPALIVE_ENABLE             YES
+#if (W5500_KEEPALIVE_ENABLE==YES)
+#define W5500_KEEPALIVE_INTERVAL_S         10      /// Idle time before a keep-alive probe (Sn_KPALVTR, 5s steps, max 1275)
+#endif
+
+#define W5500_READY_TIMEOUT_MS             50      /// Wait for the chip to answer VERSIONR after reset
+
+#define W5500_CLIENT_MAX_CONN              5       /// Client connections open at once, each on a free hardware socket.
+                                                   /// 8 sockets less the ping, DHCP and DNS ones, and one per failover standby
+
+#define W5500_SHUTDOWN_LINGER_MS           500     /// Time a graceful close (TX drain and FIN) may take before the socket is closed hard
+
+#define W5500_RECONN_DELAY_MIN_MS          100     /// Wait after the first failed connect attempt
+#define W5500_RECONN_DELAY_MAX_MS          30000   /// Backoff ceiling, the wait doubles on each failure up to it
+#define W5500_RECONN_JITTER_PERCENT        25      /// Random spread of each wait, +/- percent
+#define W5500_RECONN_CONNECT_TIMEOUT_MS    5000    /// Handshake wait before an attempt counts as failed
+
+#define W5500_FAILOVER_ENABLE              YES
+#if (W5500_FAILOVER_ENABLE==YES)
+#define W5500_FAILOVER_SERVERS             4       /// Servers per connection
+#define W5500_FAILOVER_FAILS               2       /// Failures in a row, a lost connection included, before moving to the next best server
+#define W5500_FAILOVER_PRIO_MS             1000    /// Score of one priority step, in ms of latency
+#define W5500_FAILOVER_FAIL_MS             2000    /// Score of each failure in a row
+#define W5500_FAILOVER_HOLD_S              30      /// Time the failures weigh on the score
+#define W5500_FAILOVER_STANDBY             NO      /// Keep a pre-connection to the next best server, one more socket per connection
+#endif
+
+#define W5500_LINK_SAMPLE_MS               100     /// PHYCFGR sampling period of the link monitor, bounds the link loss detection delay
+#define W5500_LINK_CALLBACKS               4       /// Link change callbacks that can be registered
+
+#define W5500_DHCP_ENABLE                  YES
+#if (W5500_DHCP_ENABLE==YES)
+#define W5500_DHCP_RETRY_MS                4000    /// First retransmission wait of DISCOVER/REQUEST, +/- 1 s (RFC 2131)
+#define W5500_DHCP_RETRY_MAX_MS            64000   /// Retransmission wait ceiling, the wait doubles up to it
+#define W5500_DHCP_HOSTNAME                "W5500" /// Host name option (12), "" for none
+#endif
+
+#define W5500_FRAME_ENABLE                 YES     /// Length-prefixed message framing over the client connections
+
+#define W5500_DNS_ENABLE                   YES
+#if (W5500_DNS_ENABLE==YES)
+#define W5500_DNS_QUERIES                  4       /// Names resolved at once
+#define W5500_DNS_CACHE                    4       /// Cached answers, positive and negative
+#define W5500_DNS_NAME_MAX                 64      /// Longest host name with its terminator
+#define W5500_DNS_TIMEOUT_MS               2000    /// Answer wait before the question is sent again
+#define W5500_DNS_RETRIES                  3       /// Questions sent before a name counts as not resolving
+#define W5500_DNS_CNAME_DEPTH              4       /// CNAME hops followed
+#define W5500_DNS_TTL_MAX_S                3600    /// Longest time an answer is cached, whatever its TTL
+#define W5500_DNS_NEG_TTL_S                30      /// Time a name that does not resolve is cached
+#endif
+
+#define W5500_PING_ENABLE                  YES
+#if (W5500_PING_ENABLE==YES)
+#define W5500_PING_SOCKET                  7       /// Socket reserved for the ICMP echo engine (IPRAW)
+#define W5500_PING_TARGETS                 4       /// Maximum number of targets sharing the socket
+#define W5500_PING_PERIOD_MS               1000    /// Echo request period of each target
+#define W5500_PING_TIMEOUT_MS              1000    /// Reply wait before a request is counted lost, <= W5500_PING_PERIOD_MS
+#define W5500_PING_PAYLOAD                 32      /// Echo data bytes
+#define W5500_PING_HIST_BINS               12      /// RTT/jitter histogram bins, bin n holds [2^(n-1), 2^n) x W5500_PING_HIST_BASE_US
+#define W5500_PING_HIST_BASE_US            250     /// Width of the first histogram bin
+#endif
+
 #ifdef __cplusplus
   }
 #endif   
@@ -10,12 +10,15 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "wizchip_conf.h"
 
 
 
 bool    w5500_spi_init (void);
 void    w5500_spi_ReceiveBurstDMA (uint8_t* buf, uint16_t len);
 void    w5500_spi_TransmitBurstDMA (uint8_t* buf, uint16_t len);
+void    w5500_spi_ReceiveBurstvDMA (wiz_IOVec* iov, uint8_t cnt);
+void    w5500_spi_TransmitBurstvDMA (wiz_IOVec* iov, uint8_t cnt);
 uint8_t w5500_spi_Receive1Byte (void);
 void    w5500_spi_Transmit1Byte (uint8_t data);
 void    w5500_cs_high (void);
@@ -28,6 +28,11 @@
 
 static uint8_t flag = 0;
 static uint8_t rxByte;
+#if W5500_SPI_USE_DMA == YES
+static wiz_IOVec* chainIov = NULL;     // Fragments still to be chained by the DMA RX ISR
+static uint8_t chainCnt = 0;
+static bool chainTx = false;
+#endif
 /* Private Macros */
 #define CS                           BB_GPIO_ODR(W5500_CS_GPIO, W5500_CS_PIN)
 #define RST                          BB_GPIO_ODR(W5500_RST_GPIO, W5500_RST_PIN)
@@ -233,6 +238,148 @@ static uint8_t __w5500_spi_TransmitReceive1Byte (uint8_t data) {
   return rxByte;
 }
 //-----------------------------------------------------------------------
+#if W5500_SPI_USE_DMA == YES
+/**
+ * @brief Program both DMA streams for one fragment and start them.
+ *
+ * Used to start a chain and, from the DMA RX ISR, to continue it with the
+ * next fragment while CS stays low.
+ *
+ * @param[in] buf Fragment buffer.
+ * @param[in] len Fragment length, must not be zero.
+ * @param[in] tx  true to send buf, false to receive into it.
+ */
+static void __w5500_dma_armFragment (uint8_t* buf, uint16_t len, bool tx) {
+  static const uint8_t dummy = 0x00;
+  LL_DMA_ClearFlag(TC, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(FE, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(TC, W5500_DMA_RX_STREAM)(DMARx);
+  LL_DMA_ClearFlag(FE, W5500_DMA_RX_STREAM)(DMARx);
+  if (tx) {
+    LL_DMA_SetMemoryIncMode(DMATx, LL_DMA_STREAM_Tx, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetMemoryIncMode(DMARx, LL_DMA_STREAM_Rx, LL_DMA_MEMORY_NOINCREMENT);
+    LL_DMA_SetMemoryAddress(DMATx, LL_DMA_STREAM_Tx, (uint32_t)buf);
+    LL_DMA_SetMemoryAddress(DMARx, LL_DMA_STREAM_Rx, (uint32_t)&rxByte);
+  }
+  else {
+    LL_DMA_SetMemoryIncMode(DMATx, LL_DMA_STREAM_Tx, LL_DMA_MEMORY_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(DMARx, LL_DMA_STREAM_Rx, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetMemoryAddress(DMATx, LL_DMA_STREAM_Tx, (uint32_t)(&dummy));
+    LL_DMA_SetMemoryAddress(DMARx, LL_DMA_STREAM_Rx, (uint32_t)buf);
+  }
+  LL_DMA_SetDataLength(DMATx, LL_DMA_STREAM_Tx, len);
+  LL_DMA_SetDataLength(DMARx, LL_DMA_STREAM_Rx, len);
+  LL_DMA_EnableStream(DMARx, LL_DMA_STREAM_Rx);
+  LL_DMA_EnableStream(DMATx, LL_DMA_STREAM_Tx);
+}
+//-----------------------------------------------------------------------
+/**
+ * @brief Stop a DMA transfer that timed out.
+ *
+ * Both streams are disabled with their TC/TE interrupts and flags cleared,
+ * so a late completion can neither re-arm a chain nor end the next
+ * transfer early. CS is released, the chip drops the cut frame.
+ */
+static void __w5500_dma_abort (void) {
+  chainCnt = 0;
+  LL_DMA_DisableIT_TC(DMARx, LL_DMA_STREAM_Rx);
+  LL_DMA_DisableIT_TE(DMARx, LL_DMA_STREAM_Rx);
+  LL_DMA_DisableIT_TE(DMATx, LL_DMA_STREAM_Tx);
+  LL_DMA_DisableStream(DMATx, LL_DMA_STREAM_Tx);
+  LL_DMA_DisableStream(DMARx, LL_DMA_STREAM_Rx);
+  // EN reads 1 until the current data item is done
+  for (uint16_t i = 0; i < 1000 && (LL_DMA_IsEnabledStream(DMATx, LL_DMA_STREAM_Tx) || LL_DMA_IsEnabledStream(DMARx, LL_DMA_STREAM_Rx)); i++) {
+  }
+  LL_DMA_ClearFlag(TC, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(HT, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(TE, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(FE, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(DME, W5500_DMA_TX_STREAM)(DMATx);
+  LL_DMA_ClearFlag(TC, W5500_DMA_RX_STREAM)(DMARx);
+  LL_DMA_ClearFlag(HT, W5500_DMA_RX_STREAM)(DMARx);
+  LL_DMA_ClearFlag(TE, W5500_DMA_RX_STREAM)(DMARx);
+  LL_DMA_ClearFlag(FE, W5500_DMA_RX_STREAM)(DMARx);
+  LL_DMA_ClearFlag(DME, W5500_DMA_RX_STREAM)(DMARx);
+  NVIC_ClearPendingIRQ(W5500_DMA_RX_IRQn);
+  CS = 1;
+}
+//-----------------------------------------------------------------------
+/**
+ * @brief Arm the next non-empty fragment of the current chain.
+ *
+ * @return false if the chain is exhausted.
+ */
+static bool __w5500_dma_chainNext (void) {
+  while (chainCnt > 0 && chainIov->len == 0) {
+    chainIov++;
+    chainCnt--;
+  }
+  if (chainCnt == 0) {
+    return false;
+  }
+  wiz_IOVec* frag = chainIov++;
+  chainCnt--;
+  __w5500_dma_armFragment(frag->buf, frag->len, chainTx);
+  return true;
+}
+//-----------------------------------------------------------------------
+/**
+ * @brief Run a list of fragments as one chained DMA sequence.
+ *
+ * The first fragment is started here, the following ones are armed by the
+ * DMA RX ISR as soon as the previous one completes, and the caller is woken
+ * up once after the last one. Each fragment gets W5500_SPI_TIMEOUT.
+ *
+ * @param[in] iov Fragments.
+ * @param[in] cnt Number of fragments.
+ * @param[in] tx  true to send the fragments, false to receive into them.
+ */
+static void __w5500_dma_runChain (wiz_IOVec* iov, uint8_t cnt, bool tx) {
+  uint32_t start = W5500_GetTick();
+  uint32_t timeout = (uint32_t)W5500_SPI_TIMEOUT * cnt;
+  while (LL_SPI_IsActiveFlag_BSY(SPI)) {
+    if (W5500_GetTick() - start > W5500_SPI_TIMEOUT) {
+      LOG_ERROR("W5500 :: spi chain :: busy flag timeout");
+      return;
+    }
+    #if W5500_USE_FreeRTOS == YES
+    taskYIELD();
+    #endif
+  }
+  LL_SPI_ClearFlag_OVR(SPI);
+  LL_DMA_DisableStream(DMATx, LL_DMA_STREAM_Tx);
+  LL_DMA_DisableStream(DMARx, LL_DMA_STREAM_Rx);
+  __DSB();
+  LL_DMA_EnableIT_TC(DMARx, LL_DMA_STREAM_Rx);
+  chainIov = iov;
+  chainCnt = cnt;
+  chainTx = tx;
+  #if W5500_USE_FreeRTOS == YES
+  xSemaphoreTake(hSemaphore, 0);
+  if (!__w5500_dma_chainNext()) {
+    return;
+  }
+  if (xSemaphoreTake(hSemaphore, timeout) != pdTRUE) {
+    LOG_ERROR("W5500 :: spi chain :: Failed to take the semaphore");
+    __w5500_dma_abort();
+  }
+  #else 
+  flag = 1;
+  if (!__w5500_dma_chainNext()) {
+    flag = 0;
+    return;
+  }
+  start = W5500_GetTick();
+  while (flag) {
+    if (W5500_GetTick() - start > timeout) {
+      __w5500_dma_abort();
+      break;
+    }
+  }
+  #endif
+}
+#endif
+//-----------------------------------------------------------------------
 // Public APIs 
 //-----------------------------------------------------------------------
 void w5500_cs_low (void) {
@@ -288,6 +435,7 @@ void w5500_spi_TransmitBurstDMA (uint8_t* buf, uint16_t len) {
   LL_DMA_EnableStream(DMATx, LL_DMA_STREAM_Tx);
   if (xSemaphoreTake(hSemaphore, W5500_SPI_TIMEOUT) != pdTRUE) {
     LOG_ERROR("W5500 :: spi tx :: Failed to take the semaphore");
+    __w5500_dma_abort();
   }
   #else 
   flag = 1;
@@ -295,6 +443,7 @@ void w5500_spi_TransmitBurstDMA (uint8_t* buf, uint16_t len) {
   LL_DMA_EnableStream(DMATx, LL_DMA_STREAM_Tx);
   while (flag) {
     if (W5500_GetTick() - start > W5500_SPI_TIMEOUT) {
+      __w5500_dma_abort();
       break;
     }
   }
@@ -337,6 +486,7 @@ void w5500_spi_ReceiveBurstDMA (uint8_t* buf, uint16_t len) {
   LL_DMA_EnableStream(DMATx, LL_DMA_STREAM_Tx);
   if (xSemaphoreTake(hSemaphore, W5500_SPI_TIMEOUT) != pdTRUE) {
     LOG_ERROR("W5500 :: spi rx :: Failed to take the semaphore");
+    __w5500_dma_abort();
   }
   #else 
   flag = 1;
@@ -344,6 +494,7 @@ void w5500_spi_ReceiveBurstDMA (uint8_t* buf, uint16_t len) {
   LL_DMA_EnableStream(DMATx, LL_DMA_STREAM_Tx);
   while (flag) {
     if (W5500_GetTick() - start > W5500_SPI_TIMEOUT) {
+      __w5500_dma_abort();
       break;
     }
   }
@@ -351,9 +502,33 @@ void w5500_spi_ReceiveBurstDMA (uint8_t* buf, uint16_t len) {
   #endif
 }
 //-----------------------------------------------------------------------
+void w5500_spi_TransmitBurstvDMA (wiz_IOVec* iov, uint8_t cnt) {
+  #if W5500_SPI_USE_DMA == NO
+  for (uint8_t n = 0; n < cnt; n++) {
+    w5500_spi_TransmitBurstDMA(iov[n].buf, iov[n].len);
+  }
+  #else 
+  __w5500_dma_runChain(iov, cnt, true);
+  #endif
+}
+//-----------------------------------------------------------------------
+void w5500_spi_ReceiveBurstvDMA (wiz_IOVec* iov, uint8_t cnt) {
+  #if W5500_SPI_USE_DMA == NO
+  for (uint8_t n = 0; n < cnt; n++) {
+    w5500_spi_ReceiveBurstDMA(iov[n].buf, iov[n].len);
+  }
+  #else 
+  __w5500_dma_runChain(iov, cnt, false);
+  #endif
+}
+//-----------------------------------------------------------------------
 #if W5500_SPI_USE_DMA == YES
 void W5500_DMA_RX_IRQHandler (void) {
   LL_DMA_ClearFlag(TC, W5500_DMA_RX_STREAM)(DMARx);
+  // Continue a chained transfer without waking the caller up
+  if (chainCnt > 0 && __w5500_dma_chainNext()) {
+    return;
+  }
   #if W5500_USE_FreeRTOS == YES
   xSemaphoreGiveFromISR(hSemaphore, NULL);
   #else 
@@ -362,12 +537,57 @@ void W5500_DMA_RX_IRQHandler (void) {
 }
 #endif 
 //-----------------------------------------------------------------------
+#if (W5500_MICROS_USE_DWT==YES)
+/**
+ * @brief Free-running microsecond counter behind W5500_GetMicros().
+ *
+ * Converts DWT->CYCCNT cycles into microseconds. CYCCNT wraps every 2^32
+ * cycles (25 s at 168 MHz); a gap between two calls long enough to hide a
+ * wrap is bridged with the tick count instead.
+ *
+ * @return Microseconds, wrapping at 2^32 like the tick based fallback.
+ */
+uint32_t w5500_micros (void) {
+  static uint32_t lastCyc = 0;
+  static uint32_t lastTick = 0;
+  static uint32_t rem = 0;
+  static uint32_t us = 0;
+  uint32_t perUs = SystemCoreClock / 1000000U;
+  uint32_t primask = __get_PRIMASK();
+  uint32_t cyc;
+  uint32_t tick;
+  uint32_t ret;
+  __disable_irq();
+  cyc = DWT->CYCCNT;
+  tick = W5500_GetTick();
+  if ((tick - lastTick) >= (0xFFFFFFFFU / perUs / 1000U) / 2) {
+    us += (tick - lastTick) * 1000U;
+    rem = 0;
+  }
+  else {
+    rem += cyc - lastCyc;
+    us += rem / perUs;
+    rem %= perUs;
+  }
+  lastCyc = cyc;
+  lastTick = tick;
+  ret = us;
+  __set_PRIMASK(primask);
+  return ret;
+}
+#endif
+//-----------------------------------------------------------------------
 bool w5500_spi_init (void) {
   bool status;
+#if (W5500_MICROS_USE_DWT==YES)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
   __w5500_gpio_init();
   CS = 1;
   RST = 0;
-  W5500_Delay(10);
+  // RSTn needs 500 us low; 2 ticks give at least one full tick. Readiness is polled on VERSIONR after
+  W5500_Delay(2);
   RST = 1;
   status = __w5500_spi_init();
   __w5500_dma_init();
@@ -9,11 +9,14 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "w5500_client.h"
+#include "socket.h"
 
 bool FreeRTOS_w5500_client_init (W5500_Cnf_t* cnf);
 uint32_t FreeRTOS_w5500_client_transmit (uint8_t* buf, uint16_t len, uint32_t ticksToWait);
 uint32_t FreeRTOS_w5500_client_receive (uint8_t* buf, uint8_t len, uint32_t ticksToWait);
 void FreeRTOS_w5500_client_disconnect (void);
+int16_t FreeRTOS_w5500_poll (wiz_PollFd* fds, uint8_t nfds, uint32_t ticksToWait);
+void FreeRTOS_w5500_irqHandler (void);
 
 #ifdef __cplusplus
   }
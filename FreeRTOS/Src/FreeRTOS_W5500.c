@@ -14,6 +14,10 @@
 #include "FreeRTOS_W5500.h"
 #include "w5500_config.h"
 #include "w5500_client.h"
+#include "w5500_ping.h"
+#include "w5500_link.h"
+#include "w5500_dhcp.h"
+#include "w5500_dns.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
@@ -37,15 +41,82 @@ static StreamBufferHandle_t hStreamTx = NULL;
 static StreamBufferHandle_t hStreamRx = NULL;
 static SemaphoreHandle_t hMutexTx = NULL;
 static SemaphoreHandle_t hMutexRx = NULL;
+static SemaphoreHandle_t hSemIrq = NULL;
+static SemaphoreHandle_t hMutexPoll = NULL;
+static SemaphoreHandle_t hMutexPollReq = NULL;
 static uint8_t __initialized = 0;
 static W5500_Cnf_t* info = NULL;
+static W5500_Handle_t hClient = -1;
 
+/**
+ * @brief Readiness wait of FreeRTOS_w5500_poll(), swept by the service task.
+ */
+typedef struct {
+  wiz_PollFd* fds;          /// Sockets and events of interest
+  uint8_t nfds;             /// Entries in fds
+  int16_t ret;              /// pollsocket() result handed back to the caller
+  TimeOut_t timeOut;        /// Start of the wait
+  TickType_t ticksToWait;   /// Wait limit, portMAX_DELAY for none
+  TaskHandle_t task;        /// Task notified with the result
+} W5500_PollReq_t;
+
+static W5500_PollReq_t* pollReq = NULL;
+
+//-------------------------------------------------------------------------------
+/**
+ * @brief Sweep the pending FreeRTOS_w5500_poll() request once.
+ *
+ * Runs in the service task, the only task that drives the chip. The caller is
+ * notified when a socket is ready, on error or once its wait limit is over.
+ */
+static void __FreeRTOS_w5500_pollServe (void) {
+  int16_t ret;
+  xSemaphoreTake(hMutexPollReq, portMAX_DELAY);
+  if (pollReq != NULL) {
+    ret = pollsocket(pollReq->fds, pollReq->nfds, 0);
+    if (ret != 0 || xTaskCheckForTimeOut(&pollReq->timeOut, &pollReq->ticksToWait) != pdFALSE) {
+      pollReq->ret = ret;
+      xTaskNotifyGive(pollReq->task);
+      pollReq = NULL;
+    }
+  }
+  xSemaphoreGive(hMutexPollReq);
+}
+//-------------------------------------------------------------------------------
+/**
+ * @brief Sleep until the next service period.
+ *
+ * While a poll request is pending the sleep is cut in W5500_POLL_PERIOD slices,
+ * or earlier on INTn, and the request is swept after each one. The slices bound
+ * the wait even when a pending interrupt of another socket holds INTn low.
+ *
+ * @param[in,out] lastWake Start of the current period, advanced by one period.
+ */
+static void __FreeRTOS_w5500_idle (TickType_t* lastWake) {
+  TickType_t slice = (pdMS_TO_TICKS(W5500_POLL_PERIOD) == 0) ? 1 : pdMS_TO_TICKS(W5500_POLL_PERIOD);
+  TickType_t elapsed;
+  TickType_t left;
+  while (1) {
+    elapsed = xTaskGetTickCount() - *lastWake;
+    if (elapsed >= W5500_TASK_FREQUENCY_PERIOD) {
+      break;
+    }
+    left = W5500_TASK_FREQUENCY_PERIOD - elapsed;
+    if (pollReq != NULL && left > slice) {
+      left = slice;
+    }
+    xSemaphoreTake(hSemIrq, left);
+    __FreeRTOS_w5500_pollServe();
+  }
+  *lastWake += W5500_TASK_FREQUENCY_PERIOD;
+}
 //-------------------------------------------------------------------------------
 /**
  * @brief FreeRTOS task function to service W5500 client communication.
  *
  * Periodically (W5500_TASK_FREQUENCY_PERIOD) runs to handle reconnect attempts, receive data from W5500,
  * push received data into the RX stream buffer, and transmit data from the TX stream buffer.
+ * Between periods it answers FreeRTOS_w5500_poll(), so no other task touches the chip.
  *
  * @param[in] pvParameters Pointer to task parameters (unused).
  */
@@ -58,25 +129,78 @@ static void serviceW5500 (void* const pvParameters) {
   xLastWakeTime = xTaskGetTickCount();
   
   while (1) {
-    vTaskDelayUntil(&xLastWakeTime, W5500_TASK_FREQUENCY_PERIOD);
-    if (w5500_client_reconnect(info)) {
+    __FreeRTOS_w5500_idle(&xLastWakeTime);
+    //Link state, aborts the connections on loss
+    w5500_link_process();
+#if (W5500_DHCP_ENABLE==YES)
+    //Address lease
+    w5500_dhcp_process();
+#endif
+#if (W5500_DNS_ENABLE==YES)
+    //Host name queries
+    w5500_dns_process();
+#endif
+    //Graceful shutdowns in progress
+    disconnect_process();
+    if (w5500_client_reconnect(hClient)) {
       //Receive
-      rxSize = w5500_client_receive(rxBuf, sizeof(rxBuf));
+      rxSize = w5500_client_receive(hClient, rxBuf, sizeof(rxBuf));
       if (rxSize > 0) {
         xStreamBufferSend(hStreamRx, rxBuf, rxSize, 0);
       }
       //Transmit
       txSize = xStreamBufferReceive(hStreamTx, txBuf, sizeof(txBuf), 0);
-      w5500_client_transmit(txBuf, txSize);
+      w5500_client_transmit(hClient, txBuf, txSize);
+      //Coalesced writes whose deadline passed
+      send_flush_expired();
     }
+#if (W5500_PING_ENABLE==YES)
+    w5500_ping_process();
+#endif
   }
 }
 //-------------------------------------------------------------------------------
+/**
+ * @brief Link change hook registered with the link monitor.
+ *
+ * Data queued while the link was up is meant for a connection that no
+ * longer exists; it is dropped instead of being sent on the next one.
+ *
+ * @param[in] st New link state.
+ */
+static void __FreeRTOS_w5500_onLink (const W5500_LinkState_t* st) {
+  if (!st->up) {
+    // Fails only if a writer is blocked on the buffer, its data then goes out after the reconnect
+    xStreamBufferReset(hStreamTx);
+  }
+}
+//-------------------------------------------------------------------------------
+/**
+ * @brief Wait hook of the socket library between readiness checks.
+ *
+ * The task sleeps at most W5500_POLL_PERIOD, with INTn wired it wakes earlier
+ * on the chip interrupt. The caller checks the socket again after each slice:
+ * INTn stays low while any socket has a pending bit and gives no new edge then.
+ *
+ * @param[in] timeout_ms Remaining wait, SOCK_POLL_FOREVER for none.
+ */
+static void __FreeRTOS_w5500_pollWait (uint32_t timeout_ms) {
+  if (timeout_ms > W5500_POLL_PERIOD) {
+    timeout_ms = W5500_POLL_PERIOD;
+  }
+#if (W5500_POLL_USE_INT==YES)
+  xSemaphoreTake(hSemIrq, (pdMS_TO_TICKS(timeout_ms) == 0) ? 1 : pdMS_TO_TICKS(timeout_ms));
+#else
+  vTaskDelay((pdMS_TO_TICKS(timeout_ms) == 0) ? 1 : pdMS_TO_TICKS(timeout_ms));
+#endif
+}
+//-------------------------------------------------------------------------------
 /**
  * @brief Initialize the FreeRTOS W5500 client driver.
  *
  * Creates RTOS synchronization primitives (mutexes, stream buffers),
- * initializes the W5500 client network stack, and starts the service task.
+ * initializes the W5500 client network stack, opens the client connection
+ * to the configured server and starts the service task.
  *
  * @param[in] cnf Pointer to the W5500_Cnf_t configuration structure.
  * @return true if initialization succeeded, false otherwise.
@@ -87,9 +211,19 @@ bool FreeRTOS_w5500_client_init (W5500_Cnf_t* cnf) {
   info = cnf;
   status = status && (hMutexTx = xSemaphoreCreateMutex()) != NULL;
   status = status && (hMutexRx = xSemaphoreCreateMutex()) != NULL;
+  status = status && (hSemIrq = xSemaphoreCreateBinary()) != NULL;
+  status = status && (hMutexPoll = xSemaphoreCreateMutex()) != NULL;
+  status = status && (hMutexPollReq = xSemaphoreCreateMutex()) != NULL;
   status = status && (hStreamTx = xStreamBufferCreate(W5500_STREAM_BUF_TX_SIZE, 1)) != NULL;
   status = status && (hStreamRx = xStreamBufferCreate(W5500_STREAM_BUF_RX_SIZE, 1)) != NULL;
   w5500_client_init(info);
+  status = status && (hClient = w5500_client_open(info)) >= 0;
+  status = status && w5500_link_regCallback(__FreeRTOS_w5500_onLink);
+  reg_socket_poll_wait_cbfunc(__FreeRTOS_w5500_pollWait);
+#if (W5500_POLL_USE_INT==YES)
+  // INTn is level: a socket with pending bits nobody clears holds it low, the waits then end by their W5500_POLL_PERIOD slices
+  setSIMR(0xFF);
+#endif
   status = status && xTaskCreate(&serviceW5500, "W5500", (W5500_TASK_STACK_SIZE_BYTES / 4), NULL, W5500_TASK_PRIORITY, &hTaskW5500) == pdTRUE;
   __initialized = status;
   if (!status) {
@@ -177,6 +311,72 @@ uint32_t FreeRTOS_w5500_client_receive (uint8_t* buf, uint8_t len, uint32_t tick
  * until reinitialized or the service task is resumed.
  */
 void FreeRTOS_w5500_client_disconnect (void) {
+  // A pending FreeRTOS_w5500_poll() returns 0 from now on
+  __initialized = 0;
   vTaskSuspend(hTaskW5500);
-  w5500_client_disconnect(10);
+  w5500_client_disconnect(hClient, 10);
+}
+//-------------------------------------------------------------------------------
+/**
+ * @brief Wait for readiness on a set of W5500 sockets.
+ *
+ * Hands the sockets to the service task, which sweeps them with pollsocket()
+ * every W5500_POLL_PERIOD or on INTn, and blocks the calling task until one
+ * of the requested events is ready or the timeout expires. One task polls at
+ * a time, others wait for their turn within ticksToWait.
+ *
+ * @param[in,out] fds Sockets and events of interest, revents filled on return.
+ * @param[in] nfds Number of entries in fds.
+ * @param[in] ticksToWait Maximum ticks to wait, portMAX_DELAY for no limit.
+ *
+ * @return Number of ready entries, 0 on timeout or a negative SOCKERR_ code.
+ */
+int16_t FreeRTOS_w5500_poll (wiz_PollFd* fds, uint8_t nfds, uint32_t ticksToWait) {
+  TickType_t slice = (pdMS_TO_TICKS(W5500_POLL_PERIOD) == 0) ? 1 : pdMS_TO_TICKS(W5500_POLL_PERIOD);
+  W5500_PollReq_t req;
+  if (!__initialized) {
+    return 0;
+  }
+  vTaskSetTimeOutState(&req.timeOut);
+  if (xSemaphoreTake(hMutexPoll, ticksToWait) != pdTRUE) {
+    return 0;
+  }
+  xTaskCheckForTimeOut(&req.timeOut, &ticksToWait);
+  req.fds = fds;
+  req.nfds = nfds;
+  req.ret = 0;
+  req.ticksToWait = ticksToWait;
+  req.task = xTaskGetCurrentTaskHandle();
+  // Drop an answer that came after its caller left
+  ulTaskNotifyTake(pdTRUE, 0);
+  xSemaphoreTake(hMutexPollReq, portMAX_DELAY);
+  pollReq = &req;
+  xSemaphoreGive(hMutexPollReq);
+  // First sweep now rather than at the end of the service period
+  xSemaphoreGive(hSemIrq);
+  while (ulTaskNotifyTake(pdTRUE, slice) == 0) {
+    if (!__initialized) {
+      // The service task is stopped and answers no more
+      pollReq = NULL;
+      break;
+    }
+  }
+  xSemaphoreGive(hMutexPoll);
+  return req.ret;
+}
+//-------------------------------------------------------------------------------
+/**
+ * @brief W5500 INTn interrupt handler.
+ *
+ * Call it from the EXTI interrupt of the INTn pin (falling edge).
+ * Wakes the service task to sweep a pending FreeRTOS_w5500_poll() and
+ * has the link sampled on the next service period.
+ */
+void FreeRTOS_w5500_irqHandler (void) {
+  BaseType_t woken = pdFALSE;
+  w5500_link_notify();
+  if (hSemIrq != NULL) {
+    xSemaphoreGiveFromISR(hSemIrq, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
 }
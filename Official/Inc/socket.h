@@ -110,6 +110,7 @@
 #define SOCKERR_TIMEOUT       (SOCK_ERROR - 13)    ///< Timeout occurred
 #define SOCKERR_DATALEN       (SOCK_ERROR - 14)    ///< Data length is zero or greater than buffer max size.
 #define SOCKERR_BUFFER        (SOCK_ERROR - 15)    ///< Socket buffer is not enough for data communication.
+#define SOCKERR_UNREACH       (SOCK_ERROR - 16)    ///< Destination reported unreachable, refer to @ref unreachable_check().
 
 #define SOCKFATAL_PACKLEN     (SOCK_FATAL - 1)     ///< Invalid packet length. Fatal Error.
 
@@ -244,6 +245,250 @@
 #define SOCK_IO_NONBLOCK      1  ///< Socket Non-block IO Mode in @ref setsockopt().
 #endif
 
+#define SOCK_SEND_SYNC        0  ///< Datagram send waits for SEND_OK in @ref ctlsocket() CS_SET_SENDMODE.
+#define SOCK_SEND_ASYNC       1  ///< Datagram send returns after SEND, the outcome is queued. Refer to @ref sendcompletion().
+
+/**
+ * @brief Depth of the datagram send completion queue of a socket context.
+ */
+#ifndef SOCK_SENDQ_SIZE
+#define SOCK_SENDQ_SIZE       8
+#endif
+
+/**
+ * @brief Unreachable destination negative cache.
+ * @details A destination reported by @ref IR_UNREACH fails datagram sends with @ref SOCKERR_UNREACH for
+ *          SOCK_UNREACH_TTL_MS. @ref IR is read at most every SOCK_UNREACH_CHECK_MS from the send paths.
+ *          SOCK_UNREACH_TTL_MS 0 disables the cache. The cache holds SOCK_UNREACH_SIZE entries and
+ *          belongs to the chip, so a report read by one socket context is seen by all of them.
+ */
+#ifndef SOCK_UNREACH_TTL_MS
+#define SOCK_UNREACH_TTL_MS   5000
+#endif
+#ifndef SOCK_UNREACH_CHECK_MS
+#define SOCK_UNREACH_CHECK_MS 10
+#endif
+
+/**
+ * @brief Sleep bounds of @ref recv_timeout() between checks of an idle socket.
+ * @details The sleep starts at SOCK_RECV_BACKOFF_MIN_MS and doubles on each empty check up to SOCK_RECV_BACKOFF_MAX_MS.
+ *          A wait hook woken by INTn (@ref reg_socket_poll_wait_cbfunc()) ends the sleep as soon as data arrives,
+ *          provided no other socket holds INTn low, refer to @ref recv_timeout().
+ */
+#ifndef SOCK_RECV_BACKOFF_MIN_MS
+#define SOCK_RECV_BACKOFF_MIN_MS  1
+#endif
+#ifndef SOCK_RECV_BACKOFF_MAX_MS
+#define SOCK_RECV_BACKOFF_MAX_MS  32
+#endif
+
+/////////////////////////////
+// SOCKET READINESS        //
+/////////////////////////////
+#define SOCK_POLL_IN          0x01         ///< Received data is pending. Refer to @ref pollsocket().
+#define SOCK_POLL_OUT         0x02         ///< A SEND can be issued without waiting for the previous one.
+#define SOCK_POLL_CONN        0x04         ///< TCP connection is established.
+#define SOCK_POLL_CLOSE       0x08         ///< Socket is closed or the peer closed the connection.
+#define SOCK_POLL_ERR         0x10         ///< @ref Sn_IR_TIMEOUT occurred since the last report.
+#define SOCK_POLL_FOREVER     0xFFFFFFFF   ///< Infinite timeout of @ref pollsocket().
+
+/////////////////////////////
+// TCP DISCONNECT EVENT    //
+/////////////////////////////
+#define SOCK_DISCON_LOCAL     0            ///< Connection ended by @ref disconnect() or @ref close(). Refer to @ref reg_socket_discon_cbfunc().
+#define SOCK_DISCON_PEER      1            ///< Peer sent FIN or RST.
+#define SOCK_DISCON_TIMEOUT   2            ///< Retransmission or keep-alive timeout, the peer is gone.
+#define SOCK_DISCON_LINK      3            ///< PHY link lost, the connection was aborted by @ref socket_linkdown().
+#define SOCK_DISCON_NETCHG    4            ///< Local address or route changed, the connection was aborted by @ref socket_netchange().
+
+/////////////////////////////
+// TCP SHUTDOWN EVENT      //
+/////////////////////////////
+#define SOCK_SHUT_CLOSED      0            ///< Data delivered, FIN exchanged and socket closed. Refer to @ref disconnect_async().
+#define SOCK_SHUT_LINGER      1            ///< Linger deadline passed, the socket was closed by @ref close().
+#define SOCK_SHUT_ABORT       2            ///< Peer reset or retransmission timeout, the socket was closed.
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Small-write coalescing setting of a TCP socket. Refer to @ref CS_SET_COALESCE.
+ * @details While enabled, @ref send() appends to the socket TX memory without issuing @ref Sn_CR_SEND.
+ *          SEND is issued when the pending data reaches <i>threshold</i>, the oldest pending byte is older than <i>deadline_us</i>,
+ *          or @ref send_flush() is called.
+ */
+typedef struct wiz_Coalesce_t
+{
+   uint8_t  enable;        ///< 1 to coalesce, 0 to issue SEND on every @ref send()
+   uint16_t threshold;     ///< Pending bytes that trigger SEND. 0 uses @ref Sn_MSSR.
+   uint32_t deadline_us;   ///< Maximum time data may stay pending. 0 means no deadline.
+}wiz_Coalesce;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Transmit statistics of a socket. Refer to @ref CS_GET_COALSTAT.
+ */
+typedef struct wiz_CoalStat_t
+{
+   uint32_t writes;           ///< Accepted @ref send() calls
+   uint32_t segments;         ///< Issued SEND commands
+   uint32_t bytes;            ///< Payload bytes covered by those SEND commands
+   uint32_t flush_full;       ///< SENDs triggered by the threshold
+   uint32_t flush_deadline;   ///< SENDs triggered by the deadline
+   uint32_t flush_explicit;   ///< SENDs triggered by @ref send_flush() or lack of TX memory
+   uint8_t  goodput_pct;      ///< Payload share of the transmitted bytes including Ethernet/IPv4/TCP headers. Filled on read.
+}wiz_CoalStat;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Receive wait statistics of a socket. Refer to @ref CS_GET_RECVWAIT.
+ */
+typedef struct wiz_RecvWait_t
+{
+   uint32_t waits;            ///< @ref recv_timeout() calls that found no data at first
+   uint32_t checks;           ///< Socket checks while waiting, one SPI burst each
+   uint32_t wasted;           ///< Checks that found no data
+   uint32_t timeouts;         ///< Waits ended by the timeout
+}wiz_RecvWait;
+
+#if _WIZCHIP_STATS_
+#define SOCK_STAT_ERRS        17   ///< Error slots of @ref wiz_SockStat. Slot n counts SOCK_ERROR - n, slot 0 any other error.
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Traffic and error statistics of a socket. Refer to @ref CS_GET_SOCKSTAT.
+ * @details Kept by the send and receive APIs, @ref connect() and @ref close().
+ *          Compiled out when @ref _WIZCHIP_STATS_ is 0.
+ */
+typedef struct wiz_SockStat_t
+{
+   uint32_t tx_bytes;                ///< Bytes accepted by the send APIs
+   uint32_t tx_ops;                  ///< Send calls that accepted data
+   uint32_t rx_bytes;                ///< Bytes returned by the receive APIs
+   uint32_t rx_ops;                  ///< Receive calls that returned data
+   uint32_t sends;                   ///< @ref Sn_CR_SEND commands
+   uint32_t connects;                ///< Successful @ref connect() calls
+   uint32_t closes;                  ///< @ref close() calls
+   uint32_t xfers;                   ///< SPI transactions spent in those calls
+   uint32_t stalls;                  ///< TX free space checks that found too little room
+   uint32_t busy;                    ///< @ref SOCK_BUSY returns
+   uint32_t sendok;                  ///< Timed SEND completions
+   uint32_t sendok_min_us;           ///< Fastest SEND to SEND_OK
+   uint32_t sendok_max_us;           ///< Slowest SEND to SEND_OK
+   uint32_t sendok_avg_us;           ///< Mean SEND to SEND_OK. Filled on read.
+   uint64_t sendok_sum_us;
+   uint32_t errors[SOCK_STAT_ERRS];  ///< Error returns by code
+}wiz_SockStat;
+#endif
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Received UDP datagram left in place in the SOCKET RX memory. Refer to @ref recvfrom_view().
+ */
+typedef struct wiz_DgramView_t
+{
+   uint8_t  sn;        ///< Socket number
+   uint8_t  addr[4];   ///< Source IPv4 address
+   uint16_t port;      ///< Source port number
+   uint16_t len;       ///< Payload length
+   uint16_t base;      ///< RX memory offset of the first payload byte
+}wiz_DgramView;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Received TCP data left in place in the SOCKET RX memory. Refer to @ref recv_view().
+ */
+typedef struct wiz_StreamView_t
+{
+   uint8_t  sn;        ///< Socket number
+   uint16_t len;       ///< Bytes received and not consumed yet
+   uint16_t base;      ///< RX memory offset of the first byte
+}wiz_StreamView;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Outcome of an asynchronous datagram send. Refer to @ref sendcompletion().
+ */
+typedef struct wiz_SendEvent_t
+{
+   uint8_t  sn;           ///< Socket number
+   uint8_t  ir;           ///< @ref Sn_IR_SENDOK, @ref Sn_IR_TIMEOUT when ARP to the destination failed,
+                          ///< or @ref IR_UNREACH when the destination was reported unreachable meanwhile
+   uint16_t len;          ///< Length of the datagram
+   uint32_t elapsed_us;   ///< Time from SEND to the observed outcome
+}wiz_SendEvent;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Socket and events of interest for @ref pollsocket().
+ */
+typedef struct wiz_PollFd_t
+{
+   uint8_t sn;        ///< Socket number
+   uint8_t events;    ///< Requested events, OR of @ref SOCK_POLL_IN, @ref SOCK_POLL_OUT, @ref SOCK_POLL_CONN and @ref SOCK_POLL_CLOSE
+   uint8_t revents;   ///< Returned events. @ref SOCK_POLL_ERR is reported even if not requested.
+}wiz_PollFd;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief State of the socket layer for one chip.
+ * @details Everything the socket APIs remember between calls lives here instead of in static variables,
+ *          so several chips can be driven side by side. Initialize it with @ref socket_ctx_init()
+ *          and pass it to the <i>xxx_ctx()</i> functions.
+ *          The APIs without context work on the context returned by @ref socket_ctx_default().
+ */
+typedef struct wiz_SockCtx_t
+{
+   _WIZCHIP* chip;                                 ///< Chip bound during each call. 0 uses the chip bound by the caller.
+   uint16_t  any_port;                             ///< Next local port for port 0 in @ref socket()
+   uint16_t  io_mode;                              ///< Non-block IO mode flags, one bit per socket
+   uint16_t  is_sending;                           ///< SEND in progress flags, one bit per socket
+   uint16_t  remained_size[_WIZCHIP_SOCK_NUM_];    ///< Unread bytes of the current datagram
+   uint8_t   pack_info[_WIZCHIP_SOCK_NUM_];        ///< Datagram receiving state, refer to @ref SO_PACKINFO
+#if _WIZCHIP_ == 5200
+   uint16_t  next_rd[_WIZCHIP_SOCK_NUM_];
+#endif
+#if _WIZCHIP_ == 5300
+   uint8_t   remained_byte[_WIZCHIP_SOCK_NUM_];    ///< Odd byte of a 16-bit FIFO read
+#endif
+   uint32_t  send_ts[_WIZCHIP_SOCK_NUM_];          ///< Time of the last SEND command
+   uint16_t  tx_reserved[_WIZCHIP_SOCK_NUM_];      ///< Length of the open @ref send_reserve() window
+   wiz_Coalesce coal_cfg[_WIZCHIP_SOCK_NUM_];
+   wiz_CoalStat coal_stat[_WIZCHIP_SOCK_NUM_];
+   uint16_t  coal_pending[_WIZCHIP_SOCK_NUM_];     ///< Bytes behind Sn_TX_WR not yet covered by SEND
+   uint16_t  coal_mss[_WIZCHIP_SOCK_NUM_];         ///< Resolved flush threshold, 0 until first use
+   uint32_t  coal_ts[_WIZCHIP_SOCK_NUM_];          ///< Time of the oldest pending write
+   uint16_t  poll_synced;                          ///< Readiness cache valid, one bit per socket
+   uint16_t  poll_rd;                              ///< Data pending in RX memory, one bit per socket
+   uint16_t  poll_err;                             ///< @ref Sn_IR_TIMEOUT not yet reported, one bit per socket
+   uint8_t   poll_sr[_WIZCHIP_SOCK_NUM_];          ///< @ref Sn_SR at the last readiness sweep
+   uint16_t  udp_conn;                             ///< Connected by @ref udp_connect(), one bit per socket
+   uint16_t  udp_dst_valid;                        ///< @ref Sn_DIPR/@ref Sn_DPORT hold udp_dip/udp_dport, one bit per socket
+   uint8_t   udp_dip[_WIZCHIP_SOCK_NUM_][4];       ///< Destination of a connected UDP socket
+   uint16_t  udp_dport[_WIZCHIP_SOCK_NUM_];
+   uint16_t  send_async;                           ///< Asynchronous datagram send, one bit per socket
+   uint16_t  send_async_len[_WIZCHIP_SOCK_NUM_];   ///< Length of the datagram in flight
+   wiz_SendEvent sendq[SOCK_SENDQ_SIZE];           ///< Completion queue of asynchronous datagram sends
+   uint8_t   sendq_head;
+   uint8_t   sendq_cnt;
+   uint16_t  sendq_lost;                           ///< Completions dropped on a full queue
+   uint8_t   dgram_dip[_WIZCHIP_SOCK_NUM_][4];     ///< Destination of the last datagram
+   uint16_t  dgram_dport[_WIZCHIP_SOCK_NUM_];
+   uint32_t  unreach_hits;                         ///< Sends failed fast by the cache
+   uint16_t  tcp_up;                               ///< TCP connection seen established and not reported down, one bit per socket
+   uint32_t  alive_ts[_WIZCHIP_SOCK_NUM_];         ///< Time the peer was last heard of: connection or received data
+   wiz_RecvWait recv_wait[_WIZCHIP_SOCK_NUM_];
+   uint16_t  shut_pend;                            ///< @ref disconnect_async() in progress, one bit per socket
+   uint16_t  shut_fin;                             ///< FIN of the shutdown sent, one bit per socket
+   uint32_t  shut_ts[_WIZCHIP_SOCK_NUM_];          ///< Time the shutdown started
+   uint32_t  shut_linger_ms[_WIZCHIP_SOCK_NUM_];   ///< Linger deadline of the shutdown
+#if _WIZCHIP_STATS_
+   wiz_SockStat stat[_WIZCHIP_SOCK_NUM_];
+#endif
+   void    (*sendok_cb)(uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact);
+   void    (*poll_wait)(uint32_t timeout_ms);
+   void    (*discon_cb)(uint8_t sn, uint8_t cause, uint32_t latency_ms);
+   void    (*shut_cb)(uint8_t sn, uint8_t how, uint32_t elapsed_ms);
+}wiz_SockCtx;
+
 /**
  * @ingroup WIZnet_socket_APIs
  * @brief Open a socket.
@@ -294,6 +539,7 @@ int8_t  listen(uint8_t sn);
   * @brief Try to connect to a <b>TCP SERVER</b>.
   * @details It sends a connection-reqeust message to the server with destination IP address and port number passed as parameter.\n
   *          SOCKET <i>sn</i> is used as active(<b>TCP CLIENT</b>) mode.
+  * @param ctx Socket context. Refer to @ref wiz_SockCtx.
   * @param sn SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
   * @param addr Pointer variable of destination IPv6 or IPv4 address. 
   * @param port Destination port number.
@@ -311,7 +557,7 @@ int8_t  listen(uint8_t sn);
   *       In block io mode, it does not return until connection is completed. \n
   *       In Non-block io mode(@ref SF_IO_NONBLOCK), it returns @ref SOCK_BUSY immediately.
   */
-static int8_t connect_IO_6(uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen );
+int8_t connect_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen );
 //int8_t connect(uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen);
 
 /**
@@ -331,6 +577,68 @@ static int8_t connect_IO_6(uint8_t sn, uint8_t * addr, uint16_t port, uint8_t ad
  */
 int8_t  disconnect(uint8_t sn);
 
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Start a graceful shutdown of a TCP connection without waiting for it.
+ * @details The data already written is sent and acknowledged first (@ref Sn_TX_FSR back to the TX memory size),
+ *          then FIN is sent. @ref disconnect_process() advances the shutdown and reports its end
+ *          to the callback of @ref reg_socket_shutdown_cbfunc(). If it is not over after <i>linger_ms</i>,
+ *          the socket is closed by @ref close() and @ref SOCK_SHUT_LINGER is reported.
+ * @note The shutdown is not reported if the socket is closed by @ref close() or reopened by @ref socket() meanwhile.
+ * @param sn        Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param linger_ms Time allowed for the drain and the FIN exchange. 0 closes the socket right away.
+ * @return @b Success :   @ref SOCK_OK   - Socket closed: it already was and nothing is reported, or the shutdown ended
+ *                                         at once (e.g. linger expired, connection gone) and was reported before this function returned \n
+ *                        @ref SOCK_BUSY - Shutdown in progress, its end is reported later by @ref disconnect_process(). \n
+ *         @b Fail    :\n @ref SOCKERR_SOCKNUM  - Invalid socket number \n
+ *                        @ref SOCKERR_SOCKMODE - Invalid operation in the socket
+ */
+int8_t  disconnect_async(uint8_t sn, uint32_t linger_ms);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Advance the shutdowns started by @ref disconnect_async().
+ * @details Call it periodically, e.g. from the network service loop. It never waits on the chip,
+ *          a few register reads per socket in shutdown.
+ * @return Number of shutdowns still in progress.
+ */
+int8_t  disconnect_process(void);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Abort every TCP connection after the PHY link went down.
+ * @details Connections being established, established or shutting down are closed at once
+ *          instead of waiting for the retransmission timeout, and their pending TX data is dropped.
+ *          They are reported as @ref SOCK_DISCON_LINK, shutdowns in progress as @ref SOCK_SHUT_ABORT.
+ *          Listening sockets and the other protocols are left as they are.
+ * @return Number of sockets aborted.
+ */
+int8_t  socket_linkdown(void);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Abort the TCP connections broken by a network reconfiguration.
+ * @details Call it after the chip took the new settings, e.g. with @ref CN_UPDATE_NETINFO.
+ *          A connection is aborted when the local MAC or IP changed, when its peer moved between
+ *          on-link and routed, or when it is routed and the gateway changed. The others go on
+ *          untouched, a new gateway does not drop the peers of the local subnet.
+ *          Aborted connections are reported as @ref SOCK_DISCON_NETCHG, shutdowns in progress as @ref SOCK_SHUT_ABORT.
+ * @param before Network information before the change.
+ * @param after  Network information after the change.
+ * @return Number of sockets aborted.
+ */
+int8_t  socket_netchange(wiz_NetInfo* before, wiz_NetInfo* after);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Close every socket at once.
+ * @details The CLOSE commands of all sockets are issued back to back and only then waited for,
+ *          so the chip runs them in parallel. Established connections are reset, not shut down,
+ *          and reported as @ref SOCK_DISCON_LOCAL. Meant for start-up and re-initialization.
+ * @return @ref SOCK_OK
+ */
+int8_t  close_all(void);
+
 /**
  * @ingroup WIZnet_socket_APIs
  * @brief	Send data to the connected peer in TCP socket.
@@ -351,6 +659,114 @@ int8_t  disconnect(uint8_t sn);
  */
 int32_t send(uint8_t sn, uint8_t * buf, uint16_t len);
 
+/**
+ * @ingroup DATA_TYPE
+ * @brief Window of the socket TX memory reserved by @ref send_reserve().
+ */
+typedef struct wiz_TxWindow_t
+{
+   uint16_t ptr;   ///< TX memory offset (@ref Sn_TX_WR) where the window starts
+   uint16_t len;   ///< Reserved length
+}wiz_TxWindow;
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Reserve a window in the socket TX memory to build outgoing data in place.
+ * @details The application writes the data straight into the chip with @ref send_write()
+ *          and hands it over with @ref send_commit(), without an intermediate RAM buffer.
+ *          Only one reservation per socket can be pending; @ref send() fails until it is committed.
+ * @note    It is valid only in TCP server or client mode. 
+
+ *          In block io mode, it waits until <i>len</i> bytes are free in the socket buffer. 
+
+ *          In non-block io mode, it returns @ref SOCK_BUSY immediately when the socket buffer is not enough.
+ * @param sn  Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param len Length to reserve. It is limited to the socket buffer size.
+ * @param win Reserved window.
+ * @return	@b Success : The reserved size \n
+ *          @b Fail    : \n @ref SOCKERR_SOCKSTATUS - Invalid socket status or a reservation is already pending \n
+ *                          @ref SOCKERR_SOCKMODE   - Invalid operation in the socket \n
+ *                          @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                          @ref SOCKERR_DATALEN    - zero data length \n
+ *                          @ref SOCKERR_ARG        - Invalid argument \n
+ *                          @ref SOCK_BUSY          - Socket is busy.
+ */
+int32_t send_reserve(uint8_t sn, uint16_t len, wiz_TxWindow* win);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Write data into a window reserved by @ref send_reserve().
+ * @details It can be called several times to fill the window piece by piece, in any order.
+ * @param sn     Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param win    Reserved window.
+ * @param offset Offset in the window.
+ * @param buf    Pointer buffer containing data to be written.
+ * @param len    The byte length of data in buf.
+ * @return	@b Success : The written data size \n
+ *          @b Fail    : \n @ref SOCKERR_SOCKSTATUS - No reservation pending \n
+ *                          @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                          @ref SOCKERR_DATALEN    - Out of the window \n
+ *                          @ref SOCKERR_ARG        - Invalid argument.
+ */
+int32_t send_write(uint8_t sn, wiz_TxWindow* win, uint16_t offset, uint8_t * buf, uint16_t len);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Send the first <i>len</i> bytes of a window reserved by @ref send_reserve().
+ * @details The rest of the window is released. <i>len</i> zero cancels the reservation.
+ * @param sn  Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param win Reserved window.
+ * @param len Length to send.
+ * @return	@b Success : The sent data size \n
+ *          @b Fail    : \n @ref SOCKERR_SOCKSTATUS - Invalid socket status or no reservation pending \n
+ *                          @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                          @ref SOCKERR_DATALEN    - Longer than the window \n
+ *                          @ref SOCKERR_ARG        - Invalid argument \n
+ *                          @ref SOCK_BUSY          - Previous SEND not completed yet (non-block io mode), the window is kept.
+ */
+int32_t send_commit(uint8_t sn, wiz_TxWindow* win, uint16_t len);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Send several buffers to the connected peer as one SEND.
+ * @details The fragments are written back-to-back into the socket TX memory in one SPI frame
+ *          and handed over with a single @ref Sn_CR_SEND, so they leave in as few TCP segments as the data allows.
+ * @note    It is valid only in TCP server or client mode. The total length can't exceed the socket buffer size. \n
+ *          In block io mode, it waits until the whole data fits in the socket buffer. \n
+ *          In non-block io mode, it returns @ref SOCK_BUSY immediately when the socket buffer is not enough.
+ * @param sn  Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param iov Buffers to send in order.
+ * @param cnt Number of buffers in iov.
+ * @return	@b Success : The sent data size \n
+ *          @b Fail    : \n @ref SOCKERR_SOCKSTATUS - Invalid socket status for socket operation \n
+ *                          @ref SOCKERR_SOCKMODE   - Invalid operation in the socket \n
+ *                          @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                          @ref SOCKERR_DATALEN    - zero data length or greater than the socket buffer \n
+ *                          @ref SOCKERR_ARG        - Invalid argument \n
+ *                          @ref SOCK_BUSY          - Socket is busy.
+ */
+int32_t sendv(uint8_t sn, wiz_IOVec* iov, uint8_t cnt);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Issue SEND for the data held back by small-write coalescing.
+ * @details Refer to @ref CS_SET_COALESCE. Nothing is done if no data is pending.
+ * @param sn Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @return	@b Success : @ref SOCK_OK \n
+ *          @b Fail    : \n @ref SOCKERR_SOCKSTATUS - Invalid socket status for socket operation \n
+ *                          @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                          @ref SOCK_BUSY          - Previous SEND not completed yet (non-block io mode), data stays pending.
+ */
+int32_t send_flush(uint8_t sn);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Issue SEND on every coalescing socket whose pending data passed its deadline.
+ * @details Call it periodically, e.g. from the network service loop, so that a last small write
+ *          is not held back until the next @ref send(). It never waits for a previous SEND to complete.
+ */
+void send_flush_expired(void);
+
 /**
  * @ingroup WIZnet_socket_APIs
  * @brief	Receive data from the connected peer.
@@ -373,10 +789,99 @@ int32_t send(uint8_t sn, uint8_t * buf, uint16_t len);
  */
 int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len);
 
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Receive data from the connected peer into several buffers.
+ * @details The received data is read in one SPI frame and split over the buffers in order,
+ *          each one filled completely before the next. Buffer lengths are not changed.
+ * @note    It is valid only in TCP server or client mode. \n
+ *          In block io mode, it waits until some data is received. \n
+ *          In non-block io mode, it returns @ref SOCK_BUSY immediately when no data is received.
+ * @param sn  Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param iov Buffers to fill in order.
+ * @param cnt Number of buffers in iov.
+ * @return	@b Success : The real received data size \n
+ *          @b Fail    :\n
+ *                     @ref SOCKERR_SOCKSTATUS - Invalid socket status for socket operation \n
+ *                     @ref SOCKERR_SOCKMODE   - Invalid operation in the socket \n
+ *                     @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                     @ref SOCKERR_DATALEN    - zero data length \n
+ *                     @ref SOCKERR_ARG        - Invalid argument \n
+ *                     @ref SOCK_BUSY          - Socket is busy.
+ */
+int32_t recvv(uint8_t sn, wiz_IOVec* iov, uint8_t cnt);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Receive data from the connected peer, waiting at most timeout_ms for it.
+ * @details Unlike the blocking @ref recv(), it does not spin on the SPI bus while the peer is silent.
+ *          Between checks it sleeps in the hook of @ref reg_socket_poll_wait_cbfunc(), woken by the socket
+ *          interrupt when INTn is wired, or for an adaptive backoff between SOCK_RECV_BACKOFF_MIN_MS and
+ *          SOCK_RECV_BACKOFF_MAX_MS otherwise. Each check is one burst read of @ref Sn_IR and @ref Sn_SR.
+ * @param sn         Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param buf        Pointer buffer to read incoming data.
+ * @param len        The max data length of data in buf.
+ * @param timeout_ms Deadline relative to the call. 0 checks once.
+ * @return Same as @ref recv(), plus @ref SOCKERR_TIMEOUT when no data arrived in time.
+ * @note It works the same in block and non-block io mode. Empty checks are counted in @ref CS_GET_RECVWAIT.\n
+ *       Only the bits of sn are cleared. INTn stays low while any unmasked @ref Sn_IR bit is pending, so a
+ *       socket whose interrupts nobody clears (e.g. the RECV of a datagram engine) leaves no edge to wake on
+ *       and the wait falls back to the backoff. Mask such sockets with @ref SIMR or @ref CS_SET_INTMASK.
+ */
+int32_t recv_timeout(uint8_t sn, uint8_t * buf, uint16_t len, uint32_t timeout_ms);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Receive the data already arrived from the connected peer, with the least SPI traffic.
+ * @details Never waits, in block and non-block io mode. On W5500 it takes four SPI transactions:
+ *          one burst of the socket registers from @ref Sn_MR to @ref Sn_RX_RD, one burst of the data,
+ *          the @ref Sn_RX_RD update and @ref Sn_CR_RECV. RECV is not waited for; a call that finds it
+ *          still pending in @ref Sn_CR returns @ref SOCK_BUSY.
+ * @param sn  Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param buf Pointer buffer to read incoming data.
+ * @param len The max data length of data in buf.
+ * @return Same as @ref recv(). @ref SOCK_BUSY when no data is waiting.
+ */
+int32_t recv_avail(uint8_t sn, uint8_t * buf, uint16_t len);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Look at the data received from the connected peer without copying it, and consume a part of it.
+ * @details Never waits, in block and non-block io mode. The socket registers are read in one burst as in
+ *          @ref recv_avail(); <i>cb</i> then gets a view of all the data waiting in the SOCKET RX memory,
+ *          reads the ranges it needs with @ref stream_read() (e.g. a length header first, then the body
+ *          straight into its destination) and returns how many bytes it consumed. Those are released with a
+ *          single @ref Sn_RX_RD update and @ref Sn_CR_RECV, however many messages they hold. Bytes not
+ *          consumed, e.g. a message not completely arrived, stay in place for the next call.
+ * @param sn  Socket number. It should be <b>0 ~ @ref \_WIZCHIP_SOCK_NUM_</b>.
+ * @param cb  Callback called once with the data. The view is valid only inside the callback.
+ * @param arg User argument passed to cb.
+ * @return Success : The number of bytes consumed, 0 if cb consumed nothing.\n
+ *         Fail    : @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                   @ref SOCKERR_SOCKMODE   - Not a @ref Sn_MR_TCP socket \n
+ *                   @ref SOCKERR_ARG        - cb is NULL \n
+ *                   @ref SOCKERR_SOCKSTATUS - Connection closed, the socket is closed \n
+ *                   @ref SOCK_BUSY          - No data is waiting, or the previous RECV is still pending.
+ */
+int32_t recv_view(uint8_t sn, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Read a range of the data of a stream view.
+ * @details It can be called any number of times and in any order from the callback of @ref recv_view().
+ * @param view   Stream view given to the callback.
+ * @param offset Offset to read from, relative to the first byte not consumed.
+ * @param buf    Destination buffer.
+ * @param len    Bytes to read. It is trimmed to the end of the data.
+ * @return Bytes read, 0 beyond the data, or @ref SOCKERR_ARG.
+ */
+int32_t stream_read(wiz_StreamView* view, uint16_t offset, uint8_t * buf, uint16_t len);
+
 /**
  * @ingroup WIZnet_socket_APIs
  * @brief Send datagram to the peer specifed by destination IP address and port number passed as parameter.
  * @details It sends datagram data by using UDP,IPRAW, or MACRAW mode SOCKET.
+ * @param ctx  Socket context. Refer to @ref wiz_SockCtx.
  * @param sn SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
  * @param buf Pointer of data buffer to be sent.
  * @param len The byte length of data in buf.
@@ -401,12 +906,30 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len);
  *       In non-block io mode(@ref SF_IO_NONBLOCK), It return @ref SOCK_BUSY immediately when SOCKET transimttable buffer size is not enough.
  */
 //int32_t sendto(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen);
-static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen);
+int32_t sendto_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Send several buffers as one datagram to the IPv4 peer specified by addr and port.
+ * @details Same as @ref sendto() but the datagram is gathered from <i>cnt</i> buffers
+ *          written back-to-back into the socket TX memory, with a single @ref Sn_CR_SEND.
+ * @param sn   SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
+ * @param iov  Buffers to send in order.
+ * @param cnt  Number of buffers in iov.
+ * @param addr Pointer variable of destination IPv4 address.
+ * @param port Destination port number.
+ * @return Success : The sent data size.\n
+ *         Fail    : Same as @ref sendto(), plus @ref SOCKERR_ARG - Invalid argument. \n
+ *                   @ref SOCKERR_DATALEN is returned when the total length exceeds the SOCKET TX buffer size,
+ *                   a fragment list is never truncated.
+ */
+int32_t sendtov(uint8_t sn, wiz_IOVec* iov, uint8_t cnt, uint8_t * addr, uint16_t port);
 
 /**
  * @ingroup WIZnet_socket_APIs
  * @brief Receive datagram from a peer 
  * @details It can read a data received from a peer by using UDP, IPRAW, or MACRAW mode SOCKET.
+ * @param ctx  Socket context. Refer to @ref wiz_SockCtx.
  * @param sn   SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
  * @param buf  Pointer buffer to be saved the received data.
  * @param len  The max read data length. \n
@@ -436,7 +959,7 @@ static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * ad
  *       In non-block io mode(@ref SF_IO_NONBLOCK), it return @ref SOCK_BUSY immediately when SOCKET RX buffer is empty. \n
  */
 //int32_t recvfrom(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port, uint8_t *addrlen);
-static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port ,uint8_t *addrlen);
+int32_t recvfrom_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port ,uint8_t *addrlen);
 
 
 /////////////////////////////
@@ -484,6 +1007,18 @@ typedef enum
    CS_SET_PREFER,          ///< set the preferred source IPv6 address of transmission packet.\n Refer to @ref SRCV6_PREFER_AUTO, @ref SRCV6_PREFER_LLA and @ref SRCV6_PREFER_GUA.
    CS_GET_PREFER,          ///< get the preferred source IPv6 address of transmission packet.\n Refer to @ref SRCV6_PREFER_AUTO, @ref SRCV6_PREFER_LLA and @ref SRCV6_PREFER_GUA.
 //#endif
+   CS_SET_COALESCE,        ///< set small-write coalescing with @ref wiz_Coalesce, valid only in TCP mode
+   CS_GET_COALESCE,        ///< get small-write coalescing setting, @ref wiz_Coalesce
+   CS_GET_COALSTAT,        ///< get transmit statistics, @ref wiz_CoalStat
+   CS_CLR_COALSTAT,        ///< clear transmit statistics
+   CS_SET_SENDMODE,        ///< set datagram send mode with @ref SOCK_SEND_SYNC or @ref SOCK_SEND_ASYNC, not valid in TCP mode
+   CS_GET_SENDMODE,        ///< get datagram send mode
+   CS_GET_RECVWAIT,        ///< get receive wait statistics, @ref wiz_RecvWait
+   CS_CLR_RECVWAIT,        ///< clear receive wait statistics
+#if _WIZCHIP_STATS_
+   CS_GET_SOCKSTAT,        ///< get traffic and error statistics, @ref wiz_SockStat
+   CS_CLR_SOCKSTAT,        ///< clear traffic and error statistics
+#endif
 #if _WIZCHIP_ >= 5100
    CS_SET_INTMASK,         ///< set the interrupt mask of socket with @ref sockint_kind, Not supported in W5100
    CS_GET_INTMASK          ///< get the masked interrupt of socket. refer to @ref sockint_kind, Not supported in W5100
@@ -535,9 +1070,18 @@ typedef enum
  *                  <tr> <td> @ref CS_SET_IOMODE \n @ref CS_GET_IOMODE </td> <td> uint8_t </td><td>@ref SOCK_IO_BLOCK @ref SOCK_IO_NONBLOCK</td></tr>
  *                  <tr> <td> @ref CS_GET_MAXTXBUF \n @ref CS_GET_MAXRXBUF </td> <td> uint16_t </td><td> 0 ~ 16K </td></tr>
  *                  <tr> <td> @ref CS_CLR_INTERRUPT \n @ref CS_GET_INTERRUPT \n @ref CS_SET_INTMASK \n @ref CS_GET_INTMASK </td> <td> @ref sockint_kind </td><td> @ref SIK_CONNECTED, etc.  </td></tr> 
+ *                  <tr> <td> @ref CS_SET_COALESCE \n @ref CS_GET_COALESCE </td> <td> @ref wiz_Coalesce </td><td> </td></tr>
+ *                  <tr> <td> @ref CS_GET_COALSTAT </td> <td> @ref wiz_CoalStat </td><td> </td></tr>
+ *                  <tr> <td> @ref CS_CLR_COALSTAT </td> <td> null </td><td> null </td></tr>
+ *                  <tr> <td> @ref CS_SET_SENDMODE \n @ref CS_GET_SENDMODE </td> <td> uint8_t </td><td>@ref SOCK_SEND_SYNC @ref SOCK_SEND_ASYNC</td></tr>
+ *                  <tr> <td> @ref CS_GET_RECVWAIT </td> <td> @ref wiz_RecvWait </td><td> </td></tr>
+ *                  <tr> <td> @ref CS_CLR_RECVWAIT </td> <td> null </td><td> null </td></tr>
+ *                  <tr> <td> @ref CS_GET_SOCKSTAT </td> <td> @ref wiz_SockStat </td><td> </td></tr>
+ *                  <tr> <td> @ref CS_CLR_SOCKSTAT </td> <td> null </td><td> null </td></tr>
  *             </table>
  *  @return @b Success @ref SOCK_OK \n
  *          @b fail    @ref SOCKERR_ARG         - Invalid argument\n
+ *                     @ref SOCKERR_SOCKMODE    - Coalescing enabled or send mode set in the wrong socket mode\n
  */
 int8_t  ctlsocket(uint8_t sn, ctlsock_type cstype, void* arg);
 
@@ -603,6 +1147,265 @@ int8_t  setsockopt(uint8_t sn, sockopt_type sotype, void* arg);
   */
 int8_t  getsockopt(uint8_t sn, sockopt_type sotype, void* arg);
 
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Register a callback for TCP SEND completion.
+ * @details It is called from @ref send() when the completion of the previous SEND command is observed.
+ * @param sendok_cb Callback function. NULL unregisters it. \n
+ *        <i>ir</i> is @ref Sn_IR_SENDOK or @ref Sn_IR_TIMEOUT. \n
+ *        <i>elapsed_us</i> is the time from issuing SEND to observing <i>ir</i>. \n
+ *        <i>exact</i> is 1 when the completion was caught while waiting on @ref Sn_IR,
+ *        0 when it was found later and <i>elapsed_us</i> is only an upper bound.
+ */
+void reg_socket_sendok_cbfunc(void (*sendok_cb)(uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Fix the destination of a UDP socket.
+ * @details The destination registers are programmed once here. @ref udp_send() then sends without
+ *          writing or checking them, and @ref sendto() to the same destination skips them as well.
+ *          A @ref sendto() to another destination still works, the next @ref udp_send() restores the registers.
+ * @param sn   SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
+ * @param addr Destination IPv4 address. NULL drops the destination.
+ * @param port Destination port number.
+ * @return Success : @ref SOCK_OK \n
+ *         Fail    : @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                   @ref SOCKERR_SOCKMODE   - Not a @ref Sn_MR_UDP socket \n
+ *                   @ref SOCKERR_IPINVALID  - Zero IP address \n
+ *                   @ref SOCKERR_PORTZERO   - Zero port number \n
+ *                   @ref SOCKERR_SOCKSTATUS - Socket is not opened
+ * @note The destination is dropped by @ref socket() and @ref close().
+ */
+int8_t  udp_connect(uint8_t sn, uint8_t * addr, uint16_t port);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Send a datagram to the destination of @ref udp_connect().
+ * @details The fast path: no destination check and no unreachable cache lookup. Call
+ *          @ref unreachable_check() or use @ref sendto() to have the destination checked.
+ * @param sn  SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
+ * @param buf Pointer buffer to send.
+ * @param len Data length.
+ * @return Same as @ref sendto() but never @ref SOCKERR_UNREACH, plus @ref SOCKERR_SOCKSTATUS when the socket is not connected.
+ */
+int32_t udp_send(uint8_t sn, uint8_t * buf, uint16_t len);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Check for an unreachable destination report.
+ * @details It reads @ref IR and, on @ref IR_UNREACH, the address in @ref UIPR and @ref UPORTR.
+ *          The destination enters the negative cache: @ref sendto() and @ref sendtov() to it
+ *          return @ref SOCKERR_UNREACH without any SPI transaction until SOCK_UNREACH_TTL_MS passes.
+ *          An asynchronous send in flight to it completes with @ref IR_UNREACH.\n
+ *          The send paths and @ref pollsocket() call it every SOCK_UNREACH_CHECK_MS. Call it from the
+ *          interrupt handling of the application to react sooner.
+ * @return 1 if a report was read, 0 otherwise.
+ */
+int8_t  unreachable_check(void);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Forget all unreachable destinations of the chip.
+ */
+void    unreachable_clear(void);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Get the outcome of an asynchronous datagram send.
+ * @details In @ref SOCK_SEND_ASYNC mode @ref sendto(), @ref sendtov() and @ref udp_send() return as soon as
+ *          the SEND command is accepted. The outcome is queued when it is noticed: by the next send on the socket,
+ *          by @ref pollsocket() or by this function, which checks the sockets with a SEND in flight when the queue is empty.
+ * @param ev Filled with the oldest queued outcome.
+ * @return @ref SOCK_OK - ev is filled \n
+ *         @ref SOCK_BUSY - No outcome yet \n
+ *         @ref SOCKERR_ARG - ev is NULL
+ * @note While a SEND is in flight, the next datagram send on the socket returns @ref SOCK_BUSY.
+ */
+int8_t  sendcompletion(wiz_SendEvent* ev);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Receive a UDP datagram without copying it.
+ * @details Only the 8-byte packet header (source IP, port, length) is read. <i>cb</i> gets a view
+ *          of the payload and reads the ranges it needs with @ref dgram_read(), straight into their
+ *          destination. On return the rest of the datagram is discarded by advancing @ref Sn_RX_RD.
+ *          A datagram still arriving is left unread until all of it is in RX memory.
+ * @param sn  SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
+ * @param cb  Callback called once with the datagram. The view is valid only inside the callback.
+ * @param arg User argument passed to cb.
+ * @return Success : The datagram payload length.\n
+ *         Fail    : @ref SOCKERR_SOCKNUM    - Invalid socket number \n
+ *                   @ref SOCKERR_SOCKMODE   - Not a @ref Sn_MR_UDP socket \n
+ *                   @ref SOCKERR_ARG        - cb is NULL \n
+ *                   @ref SOCKERR_SOCKSTATUS - A datagram is partly read by @ref recvfrom() \n
+ *                   @ref SOCKERR_SOCKCLOSED - Socket closed \n
+ *                   @ref SOCKERR_DATALEN    - Header length beyond the RX memory, the received data is dropped \n
+ *                   @ref SOCK_BUSY          - In non-block io mode, no complete datagram is pending.
+ */
+int32_t recvfrom_view(uint8_t sn, void (*cb)(wiz_DgramView* view, void* arg), void* arg);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Read a range of the payload of a datagram view.
+ * @details It can be called any number of times and in any order from the callback of @ref recvfrom_view().
+ * @param view   Datagram view given to the callback.
+ * @param offset Payload offset to read from.
+ * @param buf    Destination buffer.
+ * @param len    Bytes to read. It is trimmed to the end of the payload.
+ * @return Bytes read, 0 beyond the payload, or @ref SOCKERR_ARG.
+ */
+int32_t dgram_read(wiz_DgramView* view, uint16_t offset, uint8_t * buf, uint16_t len);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Wait for readiness on a set of sockets.
+ * @details The chip is swept with one @ref SIR read and, for each socket of fds with a pending interrupt,
+ *          one burst read of @ref Sn_IR and @ref Sn_SR. The other sockets are not touched. The socket state is cached between sweeps,
+ *          so idle sockets cost nothing. A socket touched by another API since the last sweep is
+ *          read once more completely.
+ * @param fds        Sockets and events of interest. <i>revents</i> is filled on return.
+ * @param nfds       Number of entries in fds.
+ * @param timeout_ms 0 to return immediately, @ref SOCK_POLL_FOREVER to wait without limit.
+ * @return Success : Number of entries with non-zero <i>revents</i>. 0 on timeout.\n
+ *         Fail    : @ref SOCKERR_ARG - Invalid argument\n
+ *                   @ref SOCKERR_SOCKNUM - Invalid socket number
+ * @note The interrupts of the swept sockets of fds are cleared, @ref Sn_IR_SENDOK included.
+ *       A pending TCP SEND is completed there, as @ref send() would do it.\n
+ *       Between sweeps the function registered by @ref reg_socket_poll_wait_cbfunc() is called.
+ */
+int16_t pollsocket(wiz_PollFd* fds, uint8_t nfds, uint32_t timeout_ms);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Register the function @ref pollsocket() waits with between sweeps.
+ * @param poll_wait Callback function. NULL makes @ref pollsocket() sweep continuously. \n
+ *        It should return at the latest after <i>timeout_ms</i>, or earlier when the INTn pin of the chip asserts.
+ *        For the latter, enable the socket interrupts with @ref setSIMR().
+ */
+void reg_socket_poll_wait_cbfunc(void (*poll_wait)(uint32_t timeout_ms));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Register a callback for the end of a TCP connection.
+ * @details It is called once per established connection, as soon as its end is noticed:
+ *          by @ref pollsocket(), @ref socket_check(), a failing @ref send() or @ref recv(), @ref disconnect() or @ref close().
+ *          A keep-alive timeout (@ref SO_KEEPALIVEAUTO) shows as @ref Sn_IR_TIMEOUT and is reported as @ref SOCK_DISCON_TIMEOUT.
+ * @param discon_cb Callback function. NULL unregisters it. \n
+ *        <i>cause</i> is @ref SOCK_DISCON_LOCAL, @ref SOCK_DISCON_PEER, @ref SOCK_DISCON_TIMEOUT, @ref SOCK_DISCON_LINK or @ref SOCK_DISCON_NETCHG. \n
+ *        <i>latency_ms</i> is the time since the peer was last heard of (connection or received data),
+ *        an upper bound of the time it took to detect the failure.
+ */
+void reg_socket_discon_cbfunc(void (*discon_cb)(uint8_t sn, uint8_t cause, uint32_t latency_ms));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Register a callback for the end of a shutdown started by @ref disconnect_async().
+ * @param shut_cb Callback function. NULL unregisters it. \n
+ *        <i>how</i> is @ref SOCK_SHUT_CLOSED, @ref SOCK_SHUT_LINGER or @ref SOCK_SHUT_ABORT. \n
+ *        <i>elapsed_ms</i> is the time since the shutdown started. The socket is closed when it is called.
+ */
+void reg_socket_shutdown_cbfunc(void (*shut_cb)(uint8_t sn, uint8_t how, uint32_t elapsed_ms));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Check the state of a socket and report a lost TCP connection right away.
+ * @details One burst read of @ref Sn_IR and @ref Sn_SR. Pending interrupts are folded into the
+ *          @ref pollsocket() cache and a connection found down is reported to the callback of
+ *          @ref reg_socket_discon_cbfunc(). @ref Sn_IR_SENDOK, and @ref Sn_IR_TIMEOUT of a datagram
+ *          socket, are cleared only when this context has a SEND in flight on the socket.
+ * @param sn SOCKET number. It should be <b>0 ~ @ref _WIZCHIP_SOCK_NUM_</b>.
+ * @return Success : @ref Sn_SR value \n
+ *         Fail    : @ref SOCKERR_SOCKNUM - Invalid socket number
+ */
+int16_t socket_check(uint8_t sn);
+
+/////////////////////////////
+// SOCKET CONTEXT          //
+/////////////////////////////
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Initialize a socket context.
+ * @details All sockets are marked unused and the dynamic port numbering restarts.
+ * @param ctx  Socket context to initialize.
+ * @param chip Chip the context works on. Prepare it with @ref wizchip_instance_init().
+ *             0 makes the context use the chip bound at each call, refer to @ref wizchip_bind().
+ */
+void socket_ctx_init(wiz_SockCtx* ctx, _WIZCHIP* chip);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Get the context used by the APIs without context argument.
+ */
+wiz_SockCtx* socket_ctx_default(void);
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Same as @ref reg_socket_sendok_cbfunc() on socket context ctx.
+ */
+void reg_socket_sendok_cbfunc_ctx(wiz_SockCtx* ctx, void (*sendok_cb)(uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Same as @ref reg_socket_poll_wait_cbfunc() on socket context ctx.
+ */
+void reg_socket_poll_wait_cbfunc_ctx(wiz_SockCtx* ctx, void (*poll_wait)(uint32_t timeout_ms));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Same as @ref reg_socket_discon_cbfunc() on socket context ctx.
+ */
+void reg_socket_discon_cbfunc_ctx(wiz_SockCtx* ctx, void (*discon_cb)(uint8_t sn, uint8_t cause, uint32_t latency_ms));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Same as @ref reg_socket_shutdown_cbfunc() on socket context ctx.
+ */
+void reg_socket_shutdown_cbfunc_ctx(wiz_SockCtx* ctx, void (*shut_cb)(uint8_t sn, uint8_t how, uint32_t elapsed_ms));
+
+/**
+ * @ingroup WIZnet_socket_APIs
+ * @brief Context variants of the socket APIs.
+ * @details Each one behaves as the API of the same name without <i>_ctx</i>,
+ *          with the state kept in <i>ctx</i> and the register access routed to <i>ctx->chip</i>.
+ *          Contexts bound to different chips may be used from different FreeRTOS tasks, the binding being
+ *          kept per task (@ref _WIZCHIP_TLS_INDEX_), or from different host threads when @ref WIZCHIP_TLS is defined.
+ *          Refer to @ref connect_ctx(), @ref sendto_ctx() and @ref recvfrom_ctx() for the address family variants.
+ */
+int8_t  socket_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag);
+int8_t  close_ctx(wiz_SockCtx* ctx, uint8_t sn);
+int8_t  listen_ctx(wiz_SockCtx* ctx, uint8_t sn);
+int8_t  disconnect_ctx(wiz_SockCtx* ctx, uint8_t sn);
+int8_t  disconnect_async_ctx(wiz_SockCtx* ctx, uint8_t sn, uint32_t linger_ms);
+int8_t  disconnect_process_ctx(wiz_SockCtx* ctx);
+int8_t  socket_linkdown_ctx(wiz_SockCtx* ctx);
+int8_t  socket_netchange_ctx(wiz_SockCtx* ctx, wiz_NetInfo* before, wiz_NetInfo* after);
+int8_t  close_all_ctx(wiz_SockCtx* ctx);
+int32_t send_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len);
+int32_t send_reserve_ctx(wiz_SockCtx* ctx, uint8_t sn, uint16_t len, wiz_TxWindow* win);
+int32_t send_write_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_TxWindow* win, uint16_t offset, uint8_t * buf, uint16_t len);
+int32_t send_commit_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_TxWindow* win, uint16_t len);
+int32_t sendv_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt);
+int32_t send_flush_ctx(wiz_SockCtx* ctx, uint8_t sn);
+void    send_flush_expired_ctx(wiz_SockCtx* ctx);
+int32_t recv_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len);
+int32_t recvv_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt);
+int32_t sendtov_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt, uint8_t * addr, uint16_t port);
+int8_t  ctlsocket_ctx(wiz_SockCtx* ctx, uint8_t sn, ctlsock_type cstype, void* arg);
+int8_t  setsockopt_ctx(wiz_SockCtx* ctx, uint8_t sn, sockopt_type sotype, void* arg);
+int8_t  getsockopt_ctx(wiz_SockCtx* ctx, uint8_t sn, sockopt_type sotype, void* arg);
+int16_t pollsocket_ctx(wiz_SockCtx* ctx, wiz_PollFd* fds, uint8_t nfds, uint32_t timeout_ms);
+int8_t  unreachable_check_ctx(wiz_SockCtx* ctx);
+void    unreachable_clear_ctx(wiz_SockCtx* ctx);
+int8_t  sendcompletion_ctx(wiz_SockCtx* ctx, wiz_SendEvent* ev);
+int8_t  udp_connect_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * addr, uint16_t port);
+int32_t udp_send_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len);
+int32_t recvfrom_view_ctx(wiz_SockCtx* ctx, uint8_t sn, void (*cb)(wiz_DgramView* view, void* arg), void* arg);
+int16_t socket_check_ctx(wiz_SockCtx* ctx, uint8_t sn);
+int32_t recv_timeout_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint32_t timeout_ms);
+int32_t recv_avail_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len);
+int32_t recv_view_ctx(wiz_SockCtx* ctx, uint8_t sn, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg);
+
 //teddy 240122
 #if _WIZCHIP_ == W6100 || _WIZCHIP_ == W6300
    /**
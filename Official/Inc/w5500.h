@@ -140,7 +140,7 @@ extern "C" {
  *      getSn_RX_RD(), setSn_RX_RD(), getSn_RX_WR() \n
  *      getSn_TX_FSR(), getSn_RX_RSR(), getSn_KPALVTR(), setSn_KPALVTR()
  *   -# <b> IP header field </b> \n
- *      getSn_FRAG(), setSn_FRAG(),  getSn_TOS(), setSn_TOS() \n
+ *      getSn_FRAG(), setSn_FRAG(),  getSn_TOS(), setSn_TOS(), getSn_PROTO(), setSn_PROTO() \n
  *      getSn_TTL(), setSn_TTL()
  */
 
@@ -543,7 +543,14 @@ extern "C" {
  */
 #define Sn_MSSR(N)         (_W5500_IO_BASE_ + (0x0012 << 8) + (WIZCHIP_SREG_BLOCK(N) << 3))
 
-// Reserved			         (_W5500_IO_BASE_ + (0x0014 << 8) + (WIZCHIP_SREG_BLOCK(N) << 3))
+/**
+ * @ingroup Socket_register_group
+ * @brief IP Protocol(PROTO) Register(R/W)
+ * @details @ref Sn_PROTO configures the protocol number of the IP header in @ref Sn_MR_IPRAW mode, e.g. @ref IPPROTO_ICMP.
+ * It is set before OPEN command.
+ * @note Not listed in the W5500 datasheet (reserved), it is the register the WIZnet ICMP examples use.
+ */
+#define Sn_PROTO(N)        (_W5500_IO_BASE_ + (0x0014 << 8) + (WIZCHIP_SREG_BLOCK(N) << 3))
 
 /**
  * @ingroup Socket_register_group
@@ -1239,6 +1246,24 @@ void     WIZCHIP_READ_BUF (uint32_t AddrSel, uint8_t* pBuf, uint16_t len);
  */
 void     WIZCHIP_WRITE_BUF(uint32_t AddrSel, uint8_t* pBuf, uint16_t len);
 
+/**
+ * @ingroup Basic_IO_function
+ * @brief It reads sequence data from registers into several buffers in one SPI frame.
+ * @param AddrSel Register address
+ * @param iov Buffers to fill in order
+ * @param cnt Number of buffers in iov
+ */
+void     WIZCHIP_READ_BUFV (uint32_t AddrSel, wiz_IOVec* iov, uint8_t cnt);
+
+/**
+ * @ingroup Basic_IO_function
+ * @brief It writes sequence data from several buffers to registers in one SPI frame.
+ * @param AddrSel Register address
+ * @param iov Buffers to write in order
+ * @param cnt Number of buffers in iov
+ */
+void     WIZCHIP_WRITE_BUFV(uint32_t AddrSel, wiz_IOVec* iov, uint8_t cnt);
+
 /////////////////////////////////
 // Common Register I/O function //
 /////////////////////////////////
@@ -1849,6 +1874,26 @@ void     WIZCHIP_WRITE_BUF(uint32_t AddrSel, uint8_t* pBuf, uint16_t len);
 #define getSn_MSSR(sn) \
 		(((uint16_t)WIZCHIP_READ(Sn_MSSR(sn)) << 8) + WIZCHIP_READ(WIZCHIP_OFFSET_INC(Sn_MSSR(sn),1)))		
 
+/**
+ * @ingroup Socket_register_access_function
+ * @brief Set @ref Sn_PROTO register
+ * @param (uint8_t)sn Socket number. It should be <b>0 ~ 7</b>.
+ * @param (uint8_t)proto Value to set @ref Sn_PROTO
+ * @sa getSn_PROTO()
+ */
+#define setSn_PROTO(sn, proto) \
+		WIZCHIP_WRITE(Sn_PROTO(sn), proto)
+
+/**
+ * @ingroup Socket_register_access_function
+ * @brief Get @ref Sn_PROTO register
+ * @param (uint8_t)sn Socket number. It should be <b>0 ~ 7</b>.
+ * @return uint8_t. Value of Sn_PROTO.
+ * @sa setSn_PROTO()
+ */
+#define getSn_PROTO(sn) \
+		WIZCHIP_READ(Sn_PROTO(sn))
+
 /**
  * @ingroup Socket_register_access_function
  * @brief Set @ref Sn_TOS register
@@ -2128,6 +2173,36 @@ uint16_t getSn_RX_RSR(uint8_t sn);
  */
 void wiz_send_data(uint8_t sn, uint8_t *wizdata, uint16_t len);
 
+/**
+ * @ingroup Basic_IO_function
+ * @brief It copies data to internal TX memory at a given TX pointer
+ *
+ * @details Unlike wiz_send_data(), it neither reads nor updates the Tx write pointer register.
+ * It is used to fill a window reserved by send_reserve() in place.
+ *
+ * @param (uint8_t)sn Socket number. It should be <b>0 ~ 7</b>.
+ * @param ptr TX memory offset to write at (same unit as Sn_TX_WR)
+ * @param wizdata Pointer buffer to write data
+ * @param len Data length
+ * @sa wiz_send_data()
+ */
+void wiz_send_data_at(uint8_t sn, uint16_t ptr, uint8_t *wizdata, uint16_t len);
+
+/**
+ * @ingroup Basic_IO_function
+ * @brief It copies several buffers back-to-back to internal TX memory
+ *
+ * @details Same as wiz_send_data() but gathers the data from <i>cnt</i> buffers in one SPI frame
+ * and updates the Tx write pointer register once.
+ * This function is being called by sendv() and sendtov().
+ *
+ * @param (uint8_t)sn Socket number. It should be <b>0 ~ 7</b>.
+ * @param iov Buffers to write
+ * @param cnt Number of buffers in iov
+ * @sa wiz_send_data(), wiz_recv_datav()
+ */
+void wiz_send_datav(uint8_t sn, wiz_IOVec* iov, uint8_t cnt);
+
 /**
  * @ingroup Basic_IO_function
  * @brief It copies data to your buffer from internal RX memory
@@ -2144,6 +2219,36 @@ void wiz_send_data(uint8_t sn, uint8_t *wizdata, uint16_t len);
  */
 void wiz_recv_data(uint8_t sn, uint8_t *wizdata, uint16_t len);
 
+/**
+ * @ingroup Basic_IO_function
+ * @brief It copies received data from internal RX memory at a given RX pointer
+ *
+ * @details Unlike wiz_recv_data(), it neither reads nor updates the Rx read pointer register.
+ * It is used to read ranges of a datagram in place, refer to recvfrom_view().
+ *
+ * @param (uint8_t)sn Socket number. It should be <b>0 ~ 7</b>.
+ * @param ptr RX memory offset to read from (same unit as Sn_RX_RD)
+ * @param wizdata Pointer buffer to read data
+ * @param len Data length
+ * @sa wiz_recv_data()
+ */
+void wiz_recv_data_at(uint8_t sn, uint16_t ptr, uint8_t *wizdata, uint16_t len);
+
+/**
+ * @ingroup Basic_IO_function
+ * @brief It copies received data from internal RX memory into several buffers
+ *
+ * @details Same as wiz_recv_data() but scatters the data over <i>cnt</i> buffers in one SPI frame,
+ * filling each buffer completely before the next one.
+ * This function is being called by recvv().
+ *
+ * @param (uint8_t)sn Socket number. It should be <b>0 ~ 7</b>.
+ * @param iov Buffers to fill
+ * @param cnt Number of buffers in iov
+ * @sa wiz_recv_data(), wiz_send_datav()
+ */
+void wiz_recv_datav(uint8_t sn, wiz_IOVec* iov, uint8_t cnt);
+
 /**
  * @ingroup Basic_IO_function
  * @brief It discard the received data in RX memory.
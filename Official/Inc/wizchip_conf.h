@@ -59,6 +59,35 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include "w5500_config.h"
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief One fragment of a scatter-gather buffer list.
+ * @sa sendv(), sendtov(), recvv(), reg_wizchip_spiburstv_cbfunc()
+ */
+typedef struct wiz_IOVec_t
+{
+   uint8_t*  buf;   ///< Fragment data
+   uint16_t  len;   ///< Fragment length
+}wiz_IOVec;
+
+/**
+ * @ingroup DATA_TYPE
+ * @brief Entry of the unreachable destination cache, decoded from @ref UIPR and @ref UPORTR.
+ */
+typedef struct wiz_Unreach_t
+{
+   uint8_t  ip[4];   ///< Unreachable IPv4 address
+   uint16_t port;    ///< Unreachable port number
+   uint32_t ts;      ///< Time the report was read, 0 for a free entry
+}wiz_Unreach;
+
+// Entries of the unreachable destination cache, refer to SOCK_UNREACH_TTL_MS in socket.h
+#ifndef SOCK_UNREACH_SIZE
+#define SOCK_UNREACH_SIZE     4
+#endif
+
 /**
  * @brief Select WIZCHIP.
  * @todo You should select one, \b W5100, \b W5100S, \b W5200, \b W5300, \b W5500 or etc. \n\n
@@ -352,6 +381,14 @@ typedef   int16_t   datasize_t;     ///< sent or received data size
    #define _WIZCHIP_SOCK_NUM_   4   ///< The count of independant socket of @b WIZCHIP
 #endif      
 
+/**
+ * @brief Count the SPI transactions of the chip and keep the per-socket statistics of @ref wiz_SockStat.
+ * @details Define it as 0 to compile both out.
+ */
+#ifndef _WIZCHIP_STATS_
+   #define _WIZCHIP_STATS_      1
+#endif
+
 
 /********************************************************
 * WIZCHIP BASIC IF functions for SPI, SDIO, I2C , ETC.
@@ -414,6 +451,8 @@ typedef struct __WIZCHIP
          void    (*_write_byte)  (uint8_t wb);
          void    (*_read_burst)  (uint8_t* pBuf, uint16_t len);
          void    (*_write_burst) (uint8_t* pBuf, uint16_t len);
+         void    (*_read_burstv) (wiz_IOVec* iov, uint8_t cnt);   ///< Optional. Read into several buffers in one burst
+         void    (*_write_burstv)(wiz_IOVec* iov, uint8_t cnt);   ///< Optional. Write several buffers in one burst
       }SPI;
 
       /**
@@ -428,9 +467,45 @@ typedef struct __WIZCHIP
       // To be added
       //
    }IF;
+   wiz_Unreach unreach[SOCK_UNREACH_SIZE];   ///< Unreachable destination cache, shared by all socket contexts of the chip
+   uint32_t  unreach_chk_ts;        ///< Time of the last @ref IR_UNREACH check
+   uint32_t  unreach_cnt;           ///< Unreachable reports read
+#if _WIZCHIP_STATS_
+   uint32_t  xfers;                 ///< SPI transactions (chip select cycles) so far
+#endif
 }_WIZCHIP;
 
-extern _WIZCHIP  WIZCHIP;
+/**
+ * @brief Storage class of the current @ref _WIZCHIP binding.
+ * @details Empty by default. Define it as <code>_Thread_local</code> (or <code>__thread</code>)
+ *          on a host with threads, so each thread can drive its own simulated chip.
+ *          With FreeRTOS the binding is kept per task instead, refer to @ref _WIZCHIP_TLS_INDEX_.
+ */
+#ifndef WIZCHIP_TLS
+#define WIZCHIP_TLS
+#endif
+
+/**
+ * @brief FreeRTOS thread local storage slot holding the @ref _WIZCHIP bound by each task.
+ * @details configNUM_THREAD_LOCAL_STORAGE_POINTERS must be above it. A task that never called
+ *          @ref wizchip_bind() works on @ref wizchip_default, so tasks on different chips never race
+ *          on a shared binding.
+ */
+#if (W5500_USE_FreeRTOS==YES) && !defined(_WIZCHIP_TLS_INDEX_)
+   #define _WIZCHIP_TLS_INDEX_    0
+#endif
+
+extern _WIZCHIP  wizchip_default;              ///< @ref _WIZCHIP instance used when nothing else is bound
+extern WIZCHIP_TLS _WIZCHIP* wizchip_cur;      ///< @ref _WIZCHIP instance the I/O functions work on, before the scheduler runs with FreeRTOS
+
+// WIZCHIP is the currently bound instance. Other chips are reached through wizchip_bind().
+// With FreeRTOS it looks the binding of the task up: take its address once per call in hot paths.
+#if (W5500_USE_FreeRTOS==YES)
+_WIZCHIP* wizchip_current(void);
+#else
+#define wizchip_current()    (wizchip_cur)
+#endif
+#define WIZCHIP   (*wizchip_current())
 
 /**
  * @ingroup DATA_TYPE
@@ -480,6 +555,7 @@ typedef enum
    CN_GET_NETMODE,  ///< Get network mode as WOL, PPPoE, Ping Block, and Force ARP mode
    CN_SET_TIMEOUT,  ///< Set network timeout as retry count and time.
    CN_GET_TIMEOUT,  ///< Get network timeout as retry count and time.
+   CN_UPDATE_NETINFO, ///< Set Network with @ref wiz_NetInfo, writing only what changed. Returns the NETINFO_CHG_xxx of the changes.
    //teddy 240122
 #if ((_WIZCHIP_ == W6100)||(_WIZCHIP_ == W6300))
    CN_SET_PREFER,   ///< Set the preferred source IPv6 address of @ref _SLCR_.\n Refer to @ref IPV6_ADDR_AUTO, @ref IPV6_ADDR_LLA, @ref IPV6_ADDR_GUA
@@ -683,6 +759,12 @@ typedef struct wiz_NetInfo_t
    dhcp_mode dhcp;  ///< 1 - Static, 2 - DHCP
 }wiz_NetInfo;
 
+#define NETINFO_CHG_GW     0x01   ///< Gateway changed. Refer to @ref wizchip_updatenetinfo().
+#define NETINFO_CHG_SN     0x02   ///< Subnet mask changed
+#define NETINFO_CHG_MAC    0x04   ///< Source MAC address changed
+#define NETINFO_CHG_IP     0x08   ///< Source IP address changed
+#define NETINFO_CHG_DNS    0x10   ///< DNS server changed, kept by the driver only
+
 /**
  * @ingroup DATA_TYPE
  *  Network mode
@@ -878,6 +960,23 @@ typedef struct wiz_PING_t
  */
 void reg_wizchip_cris_cbfunc(void(*cris_en)(void), void(*cris_ex)(void));
 
+/**
+ *@brief Initializes a @ref _WIZCHIP instance with the default I/O functions.
+ *@details Use it for the second and further chips on the board, then bind the instance with
+ *         @ref wizchip_bind() and register its callback functions as for the default one.
+ *@param chip : instance to initialize
+ */
+void wizchip_instance_init(_WIZCHIP* chip);
+
+/**
+ *@brief Binds a @ref _WIZCHIP instance to the I/O functions of the calling thread.
+ *@details With FreeRTOS the binding belongs to the calling task once the scheduler runs,
+ *         refer to @ref _WIZCHIP_TLS_INDEX_.
+ *@param chip : instance to bind. 0 binds @ref wizchip_default.
+ *@return The instance bound before.
+ */
+_WIZCHIP* wizchip_bind(_WIZCHIP* chip);
+
 
 /**
  *@brief Registers call back function for WIZCHIP select & deselect.
@@ -927,6 +1026,15 @@ void reg_wizchip_spi_cbfunc(uint8_t (*spi_rb)(void), void (*spi_wb)(uint8_t wb))
  */
 void reg_wizchip_spiburst_cbfunc(void (*spi_rb)(uint8_t* pBuf, uint16_t len), void (*spi_wb)(uint8_t* pBuf, uint16_t len));
 
+/**
+ *@brief Registers call back function for scatter-gather SPI burst.
+ *@param spi_rbv : callback function to burst read into several buffers using SPI
+ *@param spi_wbv : callback function to burst write several buffers using SPI
+ *@note If you do not register, each fragment is transferred with the burst callback
+ *      of @ref reg_wizchip_spiburst_cbfunc() inside the same chip select frame.
+ */
+void reg_wizchip_spiburstv_cbfunc(void (*spi_rbv)(wiz_IOVec* iov, uint8_t cnt), void (*spi_wbv)(wiz_IOVec* iov, uint8_t cnt));
+
 //teddy 240122
 /**
  *@brief Registers call back function for QSPI interface.
@@ -1279,6 +1387,18 @@ int8_t wizchip_getprefix(wiz_Prefix * prefix);
     * @param pnetinfo : @ref wizNetInfo
     */
    void wizchip_getnetinfo(wiz_NetInfo* pnetinfo);
+
+   /**
+    * @ingroup extra_functions
+    * @brief Update the network information of WIZCHIP, writing only what changed
+    * @details The common registers are read back and compared with pnetinfo. On W5500, where
+    *          @ref GAR, @ref SUBR, @ref SHAR and @ref SIPR are contiguous, the changed span is
+    *          written in one burst; nothing is written when nothing changed. No reset is made
+    *          and the sockets are left as they are, refer to socket_netchange() for those.
+    * @param pnetinfo : @ref wizNetInfo
+    * @return The NETINFO_CHG_xxx bits of what changed.
+    */
+   uint8_t wizchip_updatenetinfo(wiz_NetInfo* pnetinfo);
    
    /**
     * @ingroup extra_functions
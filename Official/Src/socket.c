@@ -64,24 +64,54 @@
 //#define SOCK_ANY_PORT_NUM  0xC000;
 #define SOCK_ANY_PORT_NUM  0xC000
 
-static uint16_t sock_any_port = SOCK_ANY_PORT_NUM;
-static uint16_t sock_io_mode = 0;
-static uint16_t sock_is_sending = 0;
-
-static uint16_t sock_remained_size[_WIZCHIP_SOCK_NUM_] = {0,0,};
-
-//M20150601 : For extern decleation
-//static uint8_t  sock_pack_info[_WIZCHIP_SOCK_NUM_] = {0,};
-uint8_t  sock_pack_info[_WIZCHIP_SOCK_NUM_] = {0,};
-//
-
-#if _WIZCHIP_ == 5200
-   static uint16_t sock_next_rd[_WIZCHIP_SOCK_NUM_] ={0,};
-#endif
-
-//A20150601 : For integrating with W5300
-#if _WIZCHIP_ == 5300
-   uint8_t sock_remained_byte[_WIZCHIP_SOCK_NUM_] = {0,}; // set by wiz_recv_data()
+// Context of the legacy API. Its chip is left unbound, so the legacy calls use the chip bound at the time.
+static wiz_SockCtx sock_ctx_default = { .chip = 0, .any_port = SOCK_ANY_PORT_NUM };
+
+/*
+ * Route the register access of a context call to the chip of the context
+ * and give the previous binding back afterwards.
+ */
+#define SOCK_CTX_CALL(rtype, call)                  \
+   do{                                              \
+      _WIZCHIP* prev = 0;                           \
+      rtype ret;                                    \
+      if(ctx->chip) prev = wizchip_bind(ctx->chip); \
+      ret = call;                                   \
+      if(prev) wizchip_bind(prev);                  \
+      return ret;                                   \
+   }while(0)
+
+#if _WIZCHIP_STATS_
+#define SOCK_STAT_KIND_TX        0
+#define SOCK_STAT_KIND_RX        1
+#define SOCK_STAT_KIND_CONNECT   2
+#define SOCK_STAT_KIND_CLOSE     3
+
+static void sock_stat_op(wiz_SockCtx* ctx, uint8_t sn, uint8_t kind, int32_t ret, uint32_t xfers);
+static void sock_stat_sendok(wiz_SockCtx* ctx, uint8_t sn, uint32_t elapsed);
+
+/*
+ * Same as SOCK_CTX_CALL(), accounting the outcome and the SPI transactions of the call on socket sn.
+ */
+#define SOCK_CTX_CALL_STAT(rtype, kind, call)                           \
+   do{                                                                  \
+      _WIZCHIP* prev = 0;                                               \
+      uint32_t xfers;                                                   \
+      rtype ret;                                                        \
+      if(ctx->chip) prev = wizchip_bind(ctx->chip);                     \
+      xfers = WIZCHIP.xfers;                                            \
+      ret = call;                                                       \
+      sock_stat_op(ctx, sn, kind, (int32_t)ret, WIZCHIP.xfers - xfers); \
+      if(prev) wizchip_bind(prev);                                      \
+      return ret;                                                       \
+   }while(0)
+
+#define SOCK_STAT_INC(field)           do{ ctx->stat[sn].field++; }while(0)
+#define SOCK_STAT_SENDOK(elapsed)      sock_stat_sendok(ctx, sn, elapsed)
+#else
+#define SOCK_CTX_CALL_STAT(rtype, kind, call)   SOCK_CTX_CALL(rtype, call)
+#define SOCK_STAT_INC(field)           do{}while(0)
+#define SOCK_STAT_SENDOK(elapsed)      do{}while(0)
 #endif
 
 
@@ -198,7 +228,136 @@ inline uint8_t inline_CheckAddrlen_W6x00( void ){
 
 
 
-int8_t socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
+void reg_socket_sendok_cbfunc_ctx(wiz_SockCtx* ctx, void (*sendok_cb)(uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact))
+{
+   ctx->sendok_cb = sendok_cb;
+}
+
+void reg_socket_poll_wait_cbfunc_ctx(wiz_SockCtx* ctx, void (*poll_wait)(uint32_t timeout_ms))
+{
+   ctx->poll_wait = poll_wait;
+}
+
+void reg_socket_discon_cbfunc_ctx(wiz_SockCtx* ctx, void (*discon_cb)(uint8_t sn, uint8_t cause, uint32_t latency_ms))
+{
+   ctx->discon_cb = discon_cb;
+}
+
+void reg_socket_shutdown_cbfunc_ctx(wiz_SockCtx* ctx, void (*shut_cb)(uint8_t sn, uint8_t how, uint32_t elapsed_ms))
+{
+   ctx->shut_cb = shut_cb;
+}
+
+/*
+ * TCP connection of socket sn is established: start the liveness clock.
+ */
+static void sock_tcp_up(wiz_SockCtx* ctx, uint8_t sn)
+{
+   ctx->tcp_up |= (1<<sn);
+   ctx->alive_ts[sn] = W5500_GetMicros();
+}
+
+/*
+ * TCP connection of socket sn is gone. Report it once, with the time since the peer was last heard of.
+ */
+static void sock_tcp_down(wiz_SockCtx* ctx, uint8_t sn, uint8_t cause)
+{
+   if(!(ctx->tcp_up & (1<<sn))) return;
+   ctx->tcp_up &= ~(1<<sn);
+   if(ctx->discon_cb) ctx->discon_cb(sn, cause, (W5500_GetMicros() - ctx->alive_ts[sn]) / 1000);
+}
+
+#if _WIZCHIP_STATS_
+static void sock_stat_op(wiz_SockCtx* ctx, uint8_t sn, uint8_t kind, int32_t ret, uint32_t xfers)
+{
+   wiz_SockStat* st;
+
+   if(sn >= _WIZCHIP_SOCK_NUM_) return;
+   st = &ctx->stat[sn];
+   st->xfers += xfers;
+   if(ret < 0)
+   {
+      st->errors[(ret >= SOCK_ERROR - (SOCK_STAT_ERRS - 1)) ? (SOCK_ERROR - ret) : 0]++;
+      return;
+   }
+   switch(kind)
+   {
+      case SOCK_STAT_KIND_TX:
+      case SOCK_STAT_KIND_RX:
+         if(ret == SOCK_BUSY)
+         {
+            st->busy++;
+            break;
+         }
+         if(kind == SOCK_STAT_KIND_TX)
+         {
+            st->tx_bytes += (uint32_t)ret;
+            st->tx_ops++;
+         }
+         else
+         {
+            st->rx_bytes += (uint32_t)ret;
+            st->rx_ops++;
+         }
+         break;
+      case SOCK_STAT_KIND_CONNECT:
+         if(ret == SOCK_OK) st->connects++;
+         else               st->busy++;
+         break;
+      default:
+         st->closes++;
+         break;
+   }
+}
+
+static void sock_stat_sendok(wiz_SockCtx* ctx, uint8_t sn, uint32_t elapsed)
+{
+   wiz_SockStat* st = &ctx->stat[sn];
+
+   if(st->sendok == 0 || elapsed < st->sendok_min_us) st->sendok_min_us = elapsed;
+   if(elapsed > st->sendok_max_us) st->sendok_max_us = elapsed;
+   st->sendok_sum_us += elapsed;
+   st->sendok++;
+}
+#endif
+
+static wiz_Unreach* sock_unreach_find(uint8_t * addr, uint16_t port, uint32_t ts);
+
+/*
+ * Account the completion of the SEND pending on socket sn.
+ * Asynchronous datagram sockets queue it, TCP sockets report it to the SEND_OK hook.
+ */
+static void sock_send_done(wiz_SockCtx* ctx, uint8_t sn, uint8_t ir, uint8_t exact)
+{
+   wiz_SendEvent* ev;
+   uint32_t elapsed = W5500_GetMicros() - ctx->send_ts[sn];
+
+   ctx->is_sending &= ~(1<<sn);
+   if(ir == Sn_IR_SENDOK) SOCK_STAT_SENDOK(elapsed);
+   if(ctx->send_async & (1<<sn))
+   {
+      // Reported unreachable while in flight, possibly through another context of the chip
+      if(sock_unreach_find(ctx->dgram_dip[sn], ctx->dgram_dport[sn], ctx->send_ts[sn])) ir = IR_UNREACH;
+      if(ctx->sendq_cnt >= SOCK_SENDQ_SIZE)
+      {
+         ctx->sendq_lost++;
+         return;
+      }
+      ev = &ctx->sendq[(ctx->sendq_head + ctx->sendq_cnt) % SOCK_SENDQ_SIZE];
+      ev->sn = sn;
+      ev->ir = ir;
+      ev->len = ctx->send_async_len[sn];
+      ev->elapsed_us = elapsed;
+      ctx->sendq_cnt++;
+   }
+   else if(ctx->sendok_cb) ctx->sendok_cb(sn, ir, elapsed, exact);
+}
+
+static int8_t  close_impl(wiz_SockCtx* ctx, uint8_t sn);
+static int32_t send_flush_impl(wiz_SockCtx* ctx, uint8_t sn);
+static int32_t sendto_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen);
+
+static int8_t socket_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
 { 
 
    uint8_t taddr[16];
@@ -310,7 +469,7 @@ int8_t socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
             break;
       }
    }
-   close(sn);
+   close_impl(ctx, sn);
 	//M20150601
 #if _WIZCHIP_ == 5300   
    setSn_MR(sn, ((uint16_t)(protocol | (flag & 0xF0))) | (((uint16_t)(flag & 0x02)) << 7) );
@@ -322,33 +481,73 @@ int8_t socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
 #endif 
    if(!port)
    {
-      port = sock_any_port++;
-      if(sock_any_port == 0xFFF0) sock_any_port = SOCK_ANY_PORT_NUM;
+      port = ctx->any_port++;
+      if(ctx->any_port == 0xFFF0) ctx->any_port = SOCK_ANY_PORT_NUM;
    }
    setSn_PORTR(sn,port);
    setSn_CR(sn,Sn_CR_OPEN);
    while(getSn_CR(sn));
    //A20150401 : For release the previous sock_io_mode
-   sock_io_mode &= ~(1 <<sn);
+   ctx->io_mode &= ~(1 <<sn);
    //
 #ifndef IPV6_AVAILABLE
-   sock_io_mode |= ((flag & SF_IO_NONBLOCK) << sn);   
+   ctx->io_mode |= ((flag & SF_IO_NONBLOCK) << sn);   
 #else
-   sock_io_mode |= ((flag & (SF_IO_NONBLOCK>>3)) << sn);
+   ctx->io_mode |= ((flag & (SF_IO_NONBLOCK>>3)) << sn);
 #endif
-   sock_is_sending &= ~(1<<sn);
-   sock_remained_size[sn] = 0;
+   ctx->is_sending &= ~(1<<sn);
+   ctx->remained_size[sn] = 0;
+   ctx->tx_reserved[sn] = 0;
+   ctx->coal_pending[sn] = 0;
+   ctx->coal_mss[sn] = 0;
+   ctx->poll_synced &= ~(1<<sn);
+   ctx->udp_conn &= ~(1<<sn);
+   ctx->udp_dst_valid &= ~(1<<sn);
+   ctx->send_async &= ~(1<<sn);
+   ctx->poll_err &= ~(1<<sn);
    //M20150601 : repalce 0 with PACK_COMPLETED
    //sock_pack_info[sn] = 0;
-   sock_pack_info[sn] = PACK_COMPLETED;//PACK_COMPLETED //TODO::need verify:LINAN 20250421
+   ctx->pack_info[sn] = PACK_COMPLETED;//PACK_COMPLETED //TODO::need verify:LINAN 20250421
   //
    while(getSn_SR(sn) == SOCK_CLOSED);
    return (int8_t)sn;
 }  
 
-int8_t close(uint8_t sn)
+/*
+ * Forget the state kept for socket sn, once it is closed.
+ */
+static void sock_closed_state(wiz_SockCtx* ctx, uint8_t sn)
+{
+	//A20150401 : Release the sock_io_mode of socket n.
+   ctx->io_mode &= ~(1<<sn); 
+	//
+   ctx->is_sending &= ~(1<<sn);
+   ctx->remained_size[sn] = 0;
+   ctx->tx_reserved[sn] = 0;
+   ctx->coal_cfg[sn].enable = 0;
+   ctx->coal_pending[sn] = 0;
+   ctx->pack_info[sn] = PACK_NONE;
+   ctx->poll_synced &= ~(1<<sn);
+   ctx->udp_conn &= ~(1<<sn);
+   ctx->udp_dst_valid &= ~(1<<sn);
+   ctx->send_async &= ~(1<<sn);
+   ctx->poll_err &= ~(1<<sn);
+   ctx->shut_pend &= ~(1<<sn);
+   ctx->shut_fin &= ~(1<<sn);
+}
+
+static int8_t close_impl(wiz_SockCtx* ctx, uint8_t sn)
 {
+   uint8_t reg[2];   // Sn_IR, Sn_SR
    CHECK_SOCKNUM();
+   // Closing a connection nobody reported down yet: tell a dead one from a local close before Sn_IR is cleared
+   if(ctx->tcp_up & (1<<sn))
+   {
+      WIZCHIP_READ_BUF(Sn_IR(sn), reg, 2);
+      if(reg[0] & Sn_IR_TIMEOUT) sock_tcp_down(ctx, sn, SOCK_DISCON_TIMEOUT);
+      else if((reg[0] & Sn_IR_DISCON) || reg[1] == SOCK_CLOSED || reg[1] == SOCK_CLOSE_WAIT) sock_tcp_down(ctx, sn, SOCK_DISCON_PEER);
+      else sock_tcp_down(ctx, sn, SOCK_DISCON_LOCAL);
+   }
 //A20160426 : Applied the erratum 1 of W5300
 #if   (_WIZCHIP_ == 5300) 
    //M20160503 : Wrong socket parameter. s -> sn 
@@ -371,7 +570,7 @@ int8_t close(uint8_t sn)
       setSn_CR(sn,Sn_CR_OPEN);
       while(getSn_CR(sn) != 0);
       while(getSn_SR(sn) != SOCK_UDP);
-      sendto(sn,destip,1,destip,0x3000); // send the dummy data to an unknown destination(0.0.0.1).
+      sendto_impl(ctx, sn,destip,1,destip,0x3000,4); // send the dummy data to an unknown destination(0.0.0.1).
    };   
 #endif 
    setSn_CR(sn,Sn_CR_CLOSE);
@@ -379,26 +578,45 @@ int8_t close(uint8_t sn)
    while( getSn_CR(sn) );
    /* clear all interrupt of SOCKETn. */
    setSn_IR(sn, 0xFF);  	
-	//A20150401 : Release the sock_io_mode of socket n.
-   sock_io_mode &= ~(1<<sn); 
-	//
-   sock_is_sending &= ~(1<<sn);
-   sock_remained_size[sn] = 0;
-   sock_pack_info[sn] = PACK_NONE;
+   sock_closed_state(ctx, sn);
    while(getSn_SR(sn) != SOCK_CLOSED);
    return SOCK_OK;
 }
 
-int8_t listen(uint8_t sn)
+static int8_t close_all_impl(wiz_SockCtx* ctx)
+{
+   uint8_t sn;
+
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      sock_tcp_down(ctx, sn, SOCK_DISCON_LOCAL);
+      setSn_CR(sn, Sn_CR_CLOSE);
+   }
+   // The chip ran the commands meanwhile, the waits below seldom loop
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      while(getSn_CR(sn));
+      setSn_IR(sn, 0xFF);
+      sock_closed_state(ctx, sn);
+   }
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      while(getSn_SR(sn) != SOCK_CLOSED);
+   }
+   return SOCK_OK;
+}
+
+static int8_t listen_impl(wiz_SockCtx* ctx, uint8_t sn)
 {
    CHECK_SOCKNUM();
+   ctx->poll_synced &= ~(1<<sn);   // the command changes Sn_SR without raising Sn_IR
    CHECK_TCPMODE(); 
    CHECK_SOCKINIT();
    setSn_CR(sn,Sn_CR_LISTEN);
    while(getSn_CR(sn));
    while(getSn_SR(sn) != SOCK_LISTEN)
    {
-      close(sn);
+      close_impl(ctx, sn);
       return SOCKERR_SOCKCLOSED;
    }
    return SOCK_OK;
@@ -409,7 +627,7 @@ int8_t connect_W5x00(uint8_t sn, uint8_t * addr, uint16_t port  ){
    // #ifdef IPV6_AVAILABLE
    // TODO :define how to work, when IPV6_AVAILABLE is defined
    // #endif 
-   return connect_IO_6(sn , addr , port, 4 );
+   return connect_ctx(&sock_ctx_default, sn , addr , port, 4 );
 }
 
 int8_t connect_W6x00(uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen ){
@@ -417,15 +635,16 @@ int8_t connect_W6x00(uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen
    // #ifdef IPV6_AVAILABLE
    // TODO :define how to work, when IPV6_AVAILABLE is defined
    // #endif 
-   return connect_IO_6(sn , addr , port ,addrlen );
+   return connect_ctx(&sock_ctx_default, sn , addr , port ,addrlen );
 }
 
-static int8_t connect_IO_6 (uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen )
+static int8_t connect_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen )
 { 
 
    // printf(" connect - addrlen = %d \r\n" , addrlen );
 
    CHECK_SOCKNUM();
+   ctx->poll_synced &= ~(1<<sn);
    CHECK_TCPMODE(); // same macro " CHECK_SOCKMODE(Sn_MR_TCP);"
    CHECK_SOCKINIT();
    
@@ -468,7 +687,7 @@ static int8_t connect_IO_6 (uint8_t sn, uint8_t * addr, uint16_t port, uint8_t a
       setSn_CR(sn,Sn_CR_CONNECT);
    }
    while(getSn_CR(sn));
-   if(sock_io_mode & (1<<sn)) return SOCK_BUSY;
+   if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
    
    #if W5500_RETRY_COUNTS == 0
    #error "W5500_RETRY_COUNTS can't be zero"
@@ -492,26 +711,28 @@ static int8_t connect_IO_6 (uint8_t sn, uint8_t * addr, uint16_t port, uint8_t a
       }
       W5500_Delay(W5500_RETRY_CONN_DELAY);
    } 
-   
+   sock_tcp_up(ctx, sn);
    return SOCK_OK;
 }
 
-int8_t disconnect(uint8_t sn)
+static int8_t disconnect_impl(wiz_SockCtx* ctx, uint8_t sn)
 {
    CHECK_SOCKNUM();
+   ctx->poll_synced &= ~(1<<sn);
    CHECK_TCPMODE();
    if(getSn_SR(sn) != SOCK_CLOSED)
    {
       setSn_CR(sn,Sn_CR_DISCON);
       /* wait to process the command... */
       while(getSn_CR(sn));
-	   sock_is_sending &= ~(1<<sn);
-      if(sock_io_mode & (1<<sn)) return SOCK_BUSY;
+	   ctx->is_sending &= ~(1<<sn);
+      sock_tcp_down(ctx, sn, SOCK_DISCON_LOCAL);
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
       while(getSn_SR(sn) != SOCK_CLOSED)
       {
          if(getSn_IR(sn) & Sn_IR_TIMEOUT)
          {
-            close(sn);
+            close_impl(ctx, sn);
             return SOCKERR_TIMEOUT;
          }
       }
@@ -520,11 +741,68 @@ int8_t disconnect(uint8_t sn)
 }
 
 
+/*
+ * Issue SEND for the data already written up to Sn_TX_WR.
+ * The previous SEND of the socket must complete first, so wait for its SEND_OK if it is still pending.
+ */
+static int32_t sock_send_issue(wiz_SockCtx* ctx, uint8_t sn, uint16_t len)
+{
+   uint8_t tmp=0;
+   if(ctx->is_sending & (1<<sn))
+   {
+      while ( !(getSn_IR(sn) & Sn_IR_SENDOK) )
+      {    
+         tmp = getSn_SR(sn);
+         if ((tmp != SOCK_ESTABLISHED) && (tmp != SOCK_CLOSE_WAIT) )
+         {
+            if( (tmp == SOCK_CLOSED) || (getSn_IR(sn) & Sn_IR_TIMEOUT) )
+            {
+               if(ctx->sendok_cb) ctx->sendok_cb(sn, Sn_IR_TIMEOUT, W5500_GetMicros() - ctx->send_ts[sn], 0);
+               close_impl(ctx, sn);
+            }
+            return SOCKERR_SOCKSTATUS;
+         }
+         if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
+      } 
+      setSn_IR(sn, Sn_IR_SENDOK);
+      SOCK_STAT_SENDOK(W5500_GetMicros() - ctx->send_ts[sn]);
+      // Completion seen while spinning on Sn_IR: the elapsed time is a real RTT sample
+      if(ctx->sendok_cb) ctx->sendok_cb(sn, Sn_IR_SENDOK, W5500_GetMicros() - ctx->send_ts[sn], 1);
+   }
+   setSn_CR(sn,Sn_CR_SEND);
+ 
+   while(getSn_CR(sn));   // wait to process the command...
+   ctx->send_ts[sn] = W5500_GetMicros();
+   ctx->is_sending |= (1<<sn);
+   SOCK_STAT_INC(sends);
+   // The SEND also covers whatever coalesced data was waiting in front of this one
+   ctx->coal_stat[sn].segments++;
+   ctx->coal_stat[sn].bytes += (uint32_t)ctx->coal_pending[sn] + len;
+   ctx->coal_pending[sn] = 0;
+ 
+   return len;
+}
+
+/*
+ * Flush threshold of a coalescing socket: the configured one, or Sn_MSSR read once per connection.
+ */
+static uint16_t sock_coal_threshold(wiz_SockCtx* ctx, uint8_t sn)
+{
+   if(ctx->coal_cfg[sn].threshold) return ctx->coal_cfg[sn].threshold;
+   if(ctx->coal_mss[sn] == 0)
+   {
+      ctx->coal_mss[sn] = getSn_MSSR(sn);
+      if(ctx->coal_mss[sn] == 0) ctx->coal_mss[sn] = 1460;   // Sn_MSSR reset value 0 means the chip default
+   }
+   return ctx->coal_mss[sn];
+}
+
 #if 1
-int32_t send(uint8_t sn, uint8_t * buf, uint16_t len)
+static int32_t send_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
 {
    uint8_t tmp=0;
    uint16_t freesize=0;
+   int32_t ret;
    /* 
     * The below codes can be omitted for optmization of speed
     */
@@ -535,29 +813,35 @@ int32_t send(uint8_t sn, uint8_t * buf, uint16_t len)
    CHECK_SOCKNUM();
    CHECK_SOCKMODE(Sn_MR_TCP);
    CHECK_SOCKDATA();
+   if(ctx->tx_reserved[sn]) return SOCKERR_SOCKSTATUS;
    tmp = getSn_SR(sn);
    if(tmp != SOCK_ESTABLISHED && tmp != SOCK_CLOSE_WAIT) return SOCKERR_SOCKSTATUS;
-   if( sock_is_sending & (1<<sn) )
+   // A coalescing socket keeps appending while a SEND is in flight, the completion is handled when it flushes
+   if( (ctx->is_sending & (1<<sn)) && !ctx->coal_cfg[sn].enable )
    {
       tmp = getSn_IR(sn);
       if(tmp & Sn_IR_SENDOK)
       {
          setSn_IR(sn, Sn_IR_SENDOK);
+         SOCK_STAT_SENDOK(W5500_GetMicros() - ctx->send_ts[sn]);
+         // Completion noticed lazily: the elapsed time is only an upper bound of the RTT
+         if(ctx->sendok_cb) ctx->sendok_cb(sn, Sn_IR_SENDOK, W5500_GetMicros() - ctx->send_ts[sn], 0);
          //M20150401 : Typing Error
          //#if _WZICHIP_ == 5200
          #if _WIZCHIP_ == 5200
-            if(getSn_TX_RD(sn) != sock_next_rd[sn])
+            if(getSn_TX_RD(sn) != ctx->next_rd[sn])
             {
                setSn_CR(sn,Sn_CR_SEND);
                while(getSn_CR(sn));
                return SOCK_BUSY;
             }
          #endif
-         sock_is_sending &= ~(1<<sn);         
+         ctx->is_sending &= ~(1<<sn);         
       }
       else if(tmp & Sn_IR_TIMEOUT)
       {
-         close(sn);
+         if(ctx->sendok_cb) ctx->sendok_cb(sn, Sn_IR_TIMEOUT, W5500_GetMicros() - ctx->send_ts[sn], 0);
+         close_impl(ctx, sn);
          return SOCKERR_TIMEOUT;
       }
       else return SOCK_BUSY;
@@ -568,47 +852,52 @@ int32_t send(uint8_t sn, uint8_t * buf, uint16_t len)
    while(1)
    {
       freesize = (uint16_t)getSn_TX_FSR(sn);
+      freesize = (freesize > ctx->coal_pending[sn]) ? (freesize - ctx->coal_pending[sn]) : 0;
       tmp = getSn_SR(sn);
       if ((tmp != SOCK_ESTABLISHED) && (tmp != SOCK_CLOSE_WAIT))
       {
-         if(tmp == SOCK_CLOSED) close(sn);
+         if(tmp == SOCK_CLOSED) close_impl(ctx, sn);
          return SOCKERR_SOCKSTATUS;
       }
-      if( (sock_io_mode & (1<<sn)) && (len > freesize) ) return SOCK_BUSY; //TODO::need verify:LINAN 20250421
+      // Coalesced data is not counted by Sn_TX_FSR before SEND, hand it over before waiting for room
+      if( (len > freesize) && ctx->coal_pending[sn] )
+      {
+         ret = send_flush_impl(ctx, sn);
+         if(ret != SOCK_OK) return ret;
+         continue;
+      }
+      if(len > freesize) SOCK_STAT_INC(stalls);
+      if( (ctx->io_mode & (1<<sn)) && (len > freesize) ) return SOCK_BUSY; //TODO::need verify:LINAN 20250421
      // if( sock_io_mode & (1<<sn) ) return SOCK_BUSY;  //TODO::need verify:LINAN 20250421
       if(len <= freesize) break;
    }
    wiz_send_data(sn, buf, len);
 #if _WIZCHIP_ == 5200
-   sock_next_rd[sn] = getSn_TX_RD(sn) + len;
+   ctx->next_rd[sn] = getSn_TX_RD(sn) + len;
 #endif
 
 #if _WIZCHIP_ == 5300
    setSn_TX_WRSR(sn,len);
 #endif
-   if(sock_is_sending & (1<<sn))
+   if(ctx->coal_cfg[sn].enable)
    {
-      while ( !(getSn_IR(sn) & Sn_IR_SENDOK) )
-      {    
-         tmp = getSn_SR(sn);
-         if ((tmp != SOCK_ESTABLISHED) && (tmp != SOCK_CLOSE_WAIT) )
-         {
-            if( (tmp == SOCK_CLOSED) || (getSn_IR(sn) & Sn_IR_TIMEOUT) ) close(sn);
-            return SOCKERR_SOCKSTATUS;
-         }
-         if(sock_io_mode & (1<<sn)) return SOCK_BUSY;
-      } 
-      setSn_IR(sn, Sn_IR_SENDOK);
+      ctx->coal_stat[sn].writes++;
+      if(ctx->coal_pending[sn] == 0) ctx->coal_ts[sn] = W5500_GetMicros();
+      ctx->coal_pending[sn] += len;
+      if(ctx->coal_pending[sn] >= sock_coal_threshold(ctx, sn)) ctx->coal_stat[sn].flush_full++;
+      else if(ctx->coal_cfg[sn].deadline_us && ((W5500_GetMicros() - ctx->coal_ts[sn]) >= ctx->coal_cfg[sn].deadline_us))
+         ctx->coal_stat[sn].flush_deadline++;
+      else return (int32_t)len;
+      // The data is accepted either way, a SEND still in flight (non-block io mode) only defers the flush
+      ret = sock_send_issue(ctx, sn, 0);
+      if(ret < 0) return ret;
+      return (int32_t)len;
    }
-   setSn_CR(sn,Sn_CR_SEND);
- 
-   while(getSn_CR(sn));   // wait to process the command...
-   sock_is_sending |= (1<<sn);
- 
-   return len;
+   ctx->coal_stat[sn].writes++;
+   return sock_send_issue(ctx, sn, len);
 }
 #else //for speed optimization, by lihan
-int32_t send(uint8_t sn, uint8_t * buf, uint16_t len)
+static int32_t send_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
 {
    uint8_t tmp=0;
    uint16_t freesize=0;
@@ -632,12 +921,302 @@ int32_t send(uint8_t sn, uint8_t * buf, uint16_t len)
    setSn_CR(sn,Sn_CR_SEND);
  
    while(getSn_CR(sn));   // wait to process the command...
-   sock_is_sending |= (1<<sn);
+   ctx->is_sending |= (1<<sn);
  
    return len;
 }
 #endif 
-int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
+
+static int32_t send_reserve_impl(wiz_SockCtx* ctx, uint8_t sn, uint16_t len, wiz_TxWindow* win)
+{
+   uint8_t tmp=0;
+   uint16_t freesize=0;
+
+   CHECK_SOCKNUM();
+   CHECK_SOCKMODE(Sn_MR_TCP);
+   CHECK_SOCKDATA();
+   if(win == 0) return SOCKERR_ARG;
+   if(ctx->tx_reserved[sn]) return SOCKERR_SOCKSTATUS;
+   if(len > getSn_TxMAX(sn)) return SOCKERR_DATALEN;
+   while(1)
+   {
+      freesize = (uint16_t)getSn_TX_FSR(sn);
+      tmp = getSn_SR(sn);
+      if ((tmp != SOCK_ESTABLISHED) && (tmp != SOCK_CLOSE_WAIT))
+      {
+         if(tmp == SOCK_CLOSED) close_impl(ctx, sn);
+         return SOCKERR_SOCKSTATUS;
+      }
+      if(len <= freesize) break;
+      SOCK_STAT_INC(stalls);
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
+   }
+   win->ptr = getSn_TX_WR(sn);
+   win->len = len;
+   ctx->tx_reserved[sn] = len;
+   return (int32_t)len;
+}
+
+static int32_t send_write_impl(wiz_SockCtx* ctx, uint8_t sn, wiz_TxWindow* win, uint16_t offset, uint8_t * buf, uint16_t len)
+{
+   CHECK_SOCKNUM();
+   if(win == 0 || buf == 0) return SOCKERR_ARG;
+   if(ctx->tx_reserved[sn] == 0) return SOCKERR_SOCKSTATUS;
+   if(((uint32_t)offset + len) > win->len) return SOCKERR_DATALEN;
+   wiz_send_data_at(sn, (uint16_t)(win->ptr + offset), buf, len);
+   return (int32_t)len;
+}
+
+static int32_t send_commit_impl(wiz_SockCtx* ctx, uint8_t sn, wiz_TxWindow* win, uint16_t len)
+{
+   int32_t ret;
+
+   CHECK_SOCKNUM();
+   if(win == 0) return SOCKERR_ARG;
+   if(ctx->tx_reserved[sn] == 0) return SOCKERR_SOCKSTATUS;
+   if(len > win->len) return SOCKERR_DATALEN;
+   // Committing zero bytes just drops the reservation
+   if(len == 0)
+   {
+      ctx->tx_reserved[sn] = 0;
+      return 0;
+   }
+   setSn_TX_WR(sn, (uint16_t)(win->ptr + len));
+   ret = sock_send_issue(ctx, sn, len);
+   // Keep the window on SOCK_BUSY so that the commit can be retried
+   if(ret != SOCK_BUSY) ctx->tx_reserved[sn] = 0;
+   return ret;
+}
+
+static int32_t sendv_impl(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   uint8_t tmp=0;
+   uint16_t freesize=0;
+   uint16_t len=0;
+
+   CHECK_SOCKNUM();
+   CHECK_SOCKMODE(Sn_MR_TCP);
+   if(iov == 0) return SOCKERR_ARG;
+   for(tmp = 0; tmp < cnt; tmp++)
+   {
+      if(((uint32_t)len + iov[tmp].len) > (uint32_t)getSn_TxMAX(sn)) return SOCKERR_DATALEN;
+      len += iov[tmp].len;
+   }
+   CHECK_SOCKDATA();
+   if(ctx->tx_reserved[sn]) return SOCKERR_SOCKSTATUS;
+   // The fragments must not reach the TX memory before a pending SEND can be followed up
+   if((ctx->io_mode & (1<<sn)) && (ctx->is_sending & (1<<sn)) && !(getSn_IR(sn) & (Sn_IR_SENDOK | Sn_IR_TIMEOUT)))
+      return SOCK_BUSY;
+   while(1)
+   {
+      freesize = (uint16_t)getSn_TX_FSR(sn);
+      tmp = getSn_SR(sn);
+      if ((tmp != SOCK_ESTABLISHED) && (tmp != SOCK_CLOSE_WAIT))
+      {
+         if(tmp == SOCK_CLOSED) close_impl(ctx, sn);
+         return SOCKERR_SOCKSTATUS;
+      }
+      if(len <= freesize) break;
+      SOCK_STAT_INC(stalls);
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
+   }
+   wiz_send_datav(sn, iov, cnt);
+   return sock_send_issue(ctx, sn, len);
+}
+
+static int32_t send_flush_impl(wiz_SockCtx* ctx, uint8_t sn)
+{
+   int32_t ret;
+
+   CHECK_SOCKNUM();
+   if(ctx->coal_pending[sn] == 0) return SOCK_OK;
+   ret = sock_send_issue(ctx, sn, 0);
+   if(ret < 0) return ret;
+   // sock_send_issue() leaves the data pending when it could not issue SEND yet
+   if(ctx->coal_pending[sn]) return SOCK_BUSY;
+   ctx->coal_stat[sn].flush_explicit++;
+   return SOCK_OK;
+}
+
+static int8_t send_flush_expired_impl(wiz_SockCtx* ctx)
+{
+   uint8_t sn;
+   uint32_t now = W5500_GetMicros();
+
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      if(!ctx->coal_pending[sn] || !ctx->coal_cfg[sn].deadline_us) continue;
+      if((now - ctx->coal_ts[sn]) < ctx->coal_cfg[sn].deadline_us) continue;
+      // Never block here on the completion of the previous SEND, try again on the next call
+      if((ctx->is_sending & (1<<sn)) && !(getSn_IR(sn) & (Sn_IR_SENDOK | Sn_IR_TIMEOUT))) continue;
+      if(sock_send_issue(ctx, sn, 0) == 0 && ctx->coal_pending[sn] == 0) ctx->coal_stat[sn].flush_deadline++;
+   }
+   return SOCK_OK;
+}
+
+/*
+ * End the shutdown of socket sn and report it. The socket is already closed.
+ */
+static void sock_shut_done(wiz_SockCtx* ctx, uint8_t sn, uint8_t how)
+{
+   ctx->shut_pend &= ~(1<<sn);
+   ctx->shut_fin &= ~(1<<sn);
+   if(ctx->shut_cb) ctx->shut_cb(sn, how, (W5500_GetMicros() - ctx->shut_ts[sn]) / 1000);
+}
+
+/*
+ * One non-blocking step of the shutdown of socket sn: drain TX memory, send FIN, wait for SOCK_CLOSED.
+ * Returns 1 while the shutdown is in progress.
+ */
+static uint8_t sock_shut_step(wiz_SockCtx* ctx, uint8_t sn)
+{
+   uint8_t reg[2];   // Sn_IR, Sn_SR
+
+   WIZCHIP_READ_BUF(Sn_IR(sn), reg, 2);
+   if(reg[1] == SOCK_CLOSED)
+   {
+      close_impl(ctx, sn);
+      sock_shut_done(ctx, sn, (ctx->shut_fin & (1<<sn)) ? SOCK_SHUT_CLOSED : SOCK_SHUT_ABORT);
+      return 0;
+   }
+   if(reg[0] & Sn_IR_TIMEOUT)
+   {
+      close_impl(ctx, sn);
+      sock_shut_done(ctx, sn, SOCK_SHUT_ABORT);
+      return 0;
+   }
+   if((W5500_GetMicros() - ctx->shut_ts[sn]) / 1000 >= ctx->shut_linger_ms[sn])
+   {
+      close_impl(ctx, sn);
+      sock_shut_done(ctx, sn, SOCK_SHUT_LINGER);
+      return 0;
+   }
+   if(ctx->shut_fin & (1<<sn)) return 1;
+   if((reg[1] == SOCK_ESTABLISHED) || (reg[1] == SOCK_CLOSE_WAIT))
+   {
+      if(ctx->is_sending & (1<<sn))
+      {
+         if(!(reg[0] & Sn_IR_SENDOK)) return 1;
+         setSn_IR(sn, Sn_IR_SENDOK);
+         sock_send_done(ctx, sn, Sn_IR_SENDOK, 0);
+      }
+      // Coalesced data still behind Sn_TX_WR goes out before the FIN
+      if(ctx->coal_pending[sn])
+      {
+         sock_send_issue(ctx, sn, 0);
+         return 1;
+      }
+      if(getSn_TX_FSR(sn) != getSn_TxMAX(sn)) return 1;
+   }
+   setSn_CR(sn, Sn_CR_DISCON);
+   while(getSn_CR(sn));
+   ctx->shut_fin |= (1<<sn);
+   return 1;
+}
+
+static int8_t disconnect_async_impl(wiz_SockCtx* ctx, uint8_t sn, uint32_t linger_ms)
+{
+   CHECK_SOCKNUM();
+   CHECK_TCPMODE();
+   if(ctx->shut_pend & (1<<sn)) return SOCK_BUSY;
+   if(getSn_SR(sn) == SOCK_CLOSED) return SOCK_OK;
+   ctx->poll_synced &= ~(1<<sn);
+   sock_tcp_down(ctx, sn, SOCK_DISCON_LOCAL);
+   if(linger_ms == 0)
+   {
+      close_impl(ctx, sn);
+      return SOCK_OK;
+   }
+   ctx->shut_pend |= (1<<sn);
+   ctx->shut_fin &= ~(1<<sn);
+   ctx->shut_ts[sn] = W5500_GetMicros();
+   ctx->shut_linger_ms[sn] = linger_ms;
+   // The first step may already end it, the shutdown callback has then been called
+   return sock_shut_step(ctx, sn) ? SOCK_BUSY : SOCK_OK;
+}
+
+static int8_t disconnect_process_impl(wiz_SockCtx* ctx)
+{
+   uint8_t sn;
+   int8_t pending = 0;
+
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      if(!(ctx->shut_pend & (1<<sn))) continue;
+      pending += sock_shut_step(ctx, sn);
+   }
+   return pending;
+}
+
+static int8_t socket_linkdown_impl(wiz_SockCtx* ctx)
+{
+   uint8_t sn;
+   uint8_t sr;
+   uint16_t shut;
+   int8_t aborted = 0;
+
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      if((getSn_MR(sn) & 0x0F) != Sn_MR_TCP) continue;
+      sr = getSn_SR(sn);
+      if(sr == SOCK_CLOSED || sr == SOCK_LISTEN) continue;
+      // Nothing reaches the peer any more: no drain, no FIN, no retransmissions
+      sock_tcp_down(ctx, sn, SOCK_DISCON_LINK);
+      shut = ctx->shut_pend & (1<<sn);   // cleared by close_impl()
+      close_impl(ctx, sn);
+      if(shut) sock_shut_done(ctx, sn, SOCK_SHUT_ABORT);
+      aborted++;
+   }
+   return aborted;
+}
+
+static uint8_t sock_onlink(uint8_t* dip, wiz_NetInfo* ni)
+{
+   uint8_t i;
+   for(i = 0; i < 4; i++)
+      if((dip[i] & ni->sn[i]) != (ni->ip[i] & ni->sn[i])) return 0;
+   return 1;
+}
+
+static int8_t socket_netchange_impl(wiz_SockCtx* ctx, wiz_NetInfo* before, wiz_NetInfo* after)
+{
+   uint8_t sn;
+   uint8_t sr;
+   uint8_t i;
+   uint8_t dip[4];
+   uint8_t local = 0, gw = 0, onlink;
+   uint16_t shut;
+   int8_t aborted = 0;
+
+   for(i = 0; i < 6; i++) if(before->mac[i] != after->mac[i]) local = 1;
+   for(i = 0; i < 4; i++)
+   {
+      if(before->ip[i] != after->ip[i]) local = 1;
+      if(before->gw[i] != after->gw[i]) gw = 1;
+   }
+   for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+   {
+      if((getSn_MR(sn) & 0x0F) != Sn_MR_TCP) continue;
+      sr = getSn_SR(sn);
+      if(sr == SOCK_CLOSED || sr == SOCK_LISTEN) continue;
+      if(!local)
+      {
+         // Same address: only the path to the peer matters
+         getSn_DIPR(sn, dip);
+         onlink = sock_onlink(dip, before);
+         if(onlink == sock_onlink(dip, after) && (onlink || !gw)) continue;
+      }
+      // The peer would not recognize the segments any more, or they would not reach it
+      sock_tcp_down(ctx, sn, SOCK_DISCON_NETCHG);
+      shut = ctx->shut_pend & (1<<sn);   // cleared by close_impl()
+      close_impl(ctx, sn);
+      if(shut) sock_shut_done(ctx, sn, SOCK_SHUT_ABORT);
+      aborted++;
+   }
+   return aborted;
+}
+
+static int32_t recv_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)//lihan
 {
    uint8_t  tmp = 0;
    uint16_t recvsize = 0;
@@ -651,6 +1230,7 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
 #endif
 //
    CHECK_SOCKNUM();
+   ctx->poll_synced &= ~(1<<sn);
    CHECK_SOCKMODE(Sn_MR_TCP);
    CHECK_SOCKDATA();
    
@@ -660,7 +1240,7 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
 //A20150601 : For Integrating with W5300
 #if _WIZCHIP_ == 5300
    //sock_pack_info[sn] = PACK_COMPLETED;    // for clear      
-   if(sock_remained_size[sn] == 0)
+   if(ctx->remained_size[sn] == 0)
    {
 #endif
 //
@@ -675,21 +1255,21 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
             if(recvsize != 0) break;
             else if(getSn_TX_FSR(sn) == getSn_TxMAX(sn))
             {
-               close(sn);
+               close_impl(ctx, sn);
                return SOCKERR_SOCKSTATUS;
             }
          }
          else
          {
-            close(sn);
+            close_impl(ctx, sn);
             return SOCKERR_SOCKSTATUS;
          }
       }
 #ifdef IPV6_AVAILABLE
       if(recvsize != 0) break;
-      if(sock_io_mode & (1<<sn)) return SOCK_BUSY;
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
 #else
-      if(sock_io_mode & (1<<sn)) return SOCK_BUSY;
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
       if(recvsize != 0) break;
 #endif 
    };
@@ -699,7 +1279,7 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
 
 //A20150601 : For integrating with W5300
 #if _WIZCHIP_ == 5300
-   if((sock_remained_size[sn] == 0) || (getSn_MR(sn) & Sn_MR_ALIGN))
+   if((ctx->remained_size[sn] == 0) || (getSn_MR(sn) & Sn_MR_ALIGN))
    {
       mr = getMR();
       if((getSn_MR(sn) & Sn_MR_ALIGN)==0)
@@ -709,19 +1289,19 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
             recvsize = (((uint16_t)head[1]) << 8) | ((uint16_t)head[0]);
          else
             recvsize = (((uint16_t)head[0]) << 8) | ((uint16_t)head[1]);
-         sock_pack_info[sn] = PACK_FIRST;
+         ctx->pack_info[sn] = PACK_FIRST;
       }
-      sock_remained_size[sn] = recvsize;
+      ctx->remained_size[sn] = recvsize;
    }
-   if(len > sock_remained_size[sn]) len = sock_remained_size[sn];
+   if(len > ctx->remained_size[sn]) len = ctx->remained_size[sn];
    recvsize = len;   
-   if(sock_pack_info[sn] & PACK_FIFOBYTE)
+   if(ctx->pack_info[sn] & PACK_FIFOBYTE)
    {
-      *buf = sock_remained_byte[sn];
+      *buf = ctx->remained_byte[sn];
       buf++;
-      sock_pack_info[sn] &= ~(PACK_FIFOBYTE);
+      ctx->pack_info[sn] &= ~(PACK_FIFOBYTE);
       recvsize -= 1;
-      sock_remained_size[sn] -= 1;
+      ctx->remained_size[sn] -= 1;
    }
    if(recvsize != 0)
    {
@@ -729,14 +1309,14 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
       setSn_CR(sn,Sn_CR_RECV);
       while(getSn_CR(sn));
    }
-   sock_remained_size[sn] -= recvsize;
-   if(sock_remained_size[sn] != 0)
+   ctx->remained_size[sn] -= recvsize;
+   if(ctx->remained_size[sn] != 0)
    {
-      sock_pack_info[sn] |= PACK_REMAINED;
-      if(recvsize & 0x1) sock_pack_info[sn] |= PACK_FIFOBYTE;
+      ctx->pack_info[sn] |= PACK_REMAINED;
+      if(recvsize & 0x1) ctx->pack_info[sn] |= PACK_FIFOBYTE;
    }
-   else sock_pack_info[sn] = PACK_COMPLETED;
-   if(getSn_MR(sn) & Sn_MR_ALIGN) sock_remained_size[sn] = 0;
+   else ctx->pack_info[sn] = PACK_COMPLETED;
+   if(getSn_MR(sn) & Sn_MR_ALIGN) ctx->remained_size[sn] = 0;
    //len = recvsize;
 #else   
    if(recvsize < len) len = recvsize;
@@ -744,36 +1324,320 @@ int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)//lihan
    setSn_CR(sn,Sn_CR_RECV); 
    while(getSn_CR(sn));  
 #endif
+   ctx->alive_ts[sn] = W5500_GetMicros();
      
    //M20150409 : Explicit Type Casting
    //return len;
    return (int32_t)len;
 }
 
+static int32_t recvv_impl(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   uint8_t  tmp = 0;
+   uint16_t recvsize = 0;
+   uint16_t len = 0;
+   uint16_t saved;
+
+   CHECK_SOCKNUM();
+   ctx->poll_synced &= ~(1<<sn);
+   CHECK_SOCKMODE(Sn_MR_TCP);
+   if(iov == 0) return SOCKERR_ARG;
+   for(tmp = 0; tmp < cnt; tmp++)
+   {
+      if(((uint32_t)len + iov[tmp].len) > 0xFFFF) return SOCKERR_DATALEN;
+      len += iov[tmp].len;
+   }
+   CHECK_SOCKDATA();
+
+   while(1)
+   {
+      recvsize = (uint16_t)getSn_RX_RSR(sn);
+      tmp = getSn_SR(sn);
+      if (tmp != SOCK_ESTABLISHED)
+      {
+         if(tmp == SOCK_CLOSE_WAIT)
+         {
+            if(recvsize != 0) break;
+            else if(getSn_TX_FSR(sn) == getSn_TxMAX(sn))
+            {
+               close_impl(ctx, sn);
+               return SOCKERR_SOCKSTATUS;
+            }
+         }
+         else
+         {
+            close_impl(ctx, sn);
+            return SOCKERR_SOCKSTATUS;
+         }
+      }
+      if(recvsize != 0) break;
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
+   };
+
+   if(recvsize < len)
+   {
+      // Only the fragments up to the received size are filled, the last one partially
+      len = recvsize;
+      for(tmp = 0; recvsize > iov[tmp].len; tmp++) recvsize -= iov[tmp].len;
+      saved = iov[tmp].len;
+      iov[tmp].len = recvsize;
+      wiz_recv_datav(sn, iov, tmp + 1);
+      iov[tmp].len = saved;
+   }
+   else wiz_recv_datav(sn, iov, cnt);
+   setSn_CR(sn,Sn_CR_RECV);
+   while(getSn_CR(sn));
+   ctx->alive_ts[sn] = W5500_GetMicros();
+
+   return (int32_t)len;
+}
+
 
 int32_t sendto_W5x00(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port ){
    //static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port)
    // printf("sendto_W5x00\r\n" ) ;
-   return sendto_IO_6(sn,   buf,  len,   addr,  port,4);
+   return sendto_ctx(&sock_ctx_default, sn,   buf,  len,   addr,  port,4);
 }
 
 int32_t sendto_W6x00(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen ){
    // printf("sendto_W6x00\r\n" ) ;
    //static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port)
-   return sendto_IO_6( sn,  buf,  len,   addr,  port, addrlen);
+   return sendto_ctx(&sock_ctx_default, sn,  buf,  len,   addr,  port, addrlen);
+}
+
+/*
+ * Entry of the chip's unreachable cache for addr:port read at or after ts, 0 if none.
+ */
+static wiz_Unreach* sock_unreach_find(uint8_t * addr, uint16_t port, uint32_t ts)
+{
+   _WIZCHIP* chip = &WIZCHIP;
+   uint8_t   i;
+
+   for(i = 0; i < SOCK_UNREACH_SIZE; i++)
+   {
+      if(chip->unreach[i].ts == 0) continue;
+      if((chip->unreach[i].port == port) && (chip->unreach[i].ip[0] == addr[0]) && (chip->unreach[i].ip[1] == addr[1]) &&
+         (chip->unreach[i].ip[2] == addr[2]) && (chip->unreach[i].ip[3] == addr[3]) &&
+         ((int32_t)(chip->unreach[i].ts - ts) >= 0))
+         return &chip->unreach[i];
+   }
+   return 0;
+}
+
+/*
+ * Read IR_UNREACH and move the reported destination into the negative cache.
+ * UIPR and UPORTR are adjacent, one burst gets both.
+ * The cache belongs to the chip: whichever context clears IR_UNREACH, all of them see the entry.
+ */
+static int8_t sock_unreach_check(wiz_SockCtx* ctx)
+{
+   _WIZCHIP* chip = &WIZCHIP;
+   uint8_t  reg[6];   // UIPR, UPORTR
+   uint8_t  i;
+   uint16_t port;
+   wiz_Unreach* ent;
+
+   (void)ctx;
+   chip->unreach_chk_ts = W5500_GetMicros();
+   if(!(getIR() & IR_UNREACH)) return 0;
+   WIZCHIP_READ_BUF(UIPR, reg, 6);
+   setIR(IR_UNREACH);
+   port = (((uint16_t)reg[4]) << 8) + reg[5];
+   // Refresh the entry of the same destination, else take a free or the oldest one
+   ent = &chip->unreach[0];
+   for(i = 0; i < SOCK_UNREACH_SIZE; i++)
+   {
+      if((chip->unreach[i].port == port) && (chip->unreach[i].ip[0] == reg[0]) && (chip->unreach[i].ip[1] == reg[1]) &&
+         (chip->unreach[i].ip[2] == reg[2]) && (chip->unreach[i].ip[3] == reg[3]))
+      {
+         ent = &chip->unreach[i];
+         break;
+      }
+      if(ent->ts == 0) continue;
+      if((chip->unreach[i].ts == 0) || ((int32_t)(chip->unreach[i].ts - ent->ts) < 0)) ent = &chip->unreach[i];
+   }
+   for(i = 0; i < 4; i++) ent->ip[i] = reg[i];
+   ent->port = port;
+   // 0 marks a free entry. An asynchronous send in flight to this destination completes with IR_UNREACH.
+   ent->ts = chip->unreach_chk_ts | 1;
+   chip->unreach_cnt++;
+   return 1;
+}
+
+/*
+ * Negative cache lookup before a datagram goes out. IR is read at most every SOCK_UNREACH_CHECK_MS.
+ */
+static int8_t sock_unreach_hit(wiz_SockCtx* ctx, uint8_t * addr, uint16_t port)
+{
+   _WIZCHIP* chip = &WIZCHIP;
+   uint8_t  i;
+   uint32_t now = W5500_GetMicros();
+
+   if((now - chip->unreach_chk_ts) >= (uint32_t)SOCK_UNREACH_CHECK_MS * 1000) sock_unreach_check(ctx);
+   for(i = 0; i < SOCK_UNREACH_SIZE; i++)
+   {
+      if(chip->unreach[i].ts == 0) continue;
+      if((now - chip->unreach[i].ts) >= (uint32_t)SOCK_UNREACH_TTL_MS * 1000)
+      {
+         chip->unreach[i].ts = 0;
+         continue;
+      }
+      if((chip->unreach[i].port == port) && (chip->unreach[i].ip[0] == addr[0]) && (chip->unreach[i].ip[1] == addr[1]) &&
+         (chip->unreach[i].ip[2] == addr[2]) && (chip->unreach[i].ip[3] == addr[3]))
+      {
+         ctx->unreach_hits++;
+         return 1;
+      }
+   }
+   return 0;
 }
 
-static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen)
+/*
+ * Common tail of the datagram send paths: copy the data into TX memory, SEND and wait for SEND_OK.
+ * The destination registers are already programmed.
+ */
+static int32_t sock_dgram_issue(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt, uint16_t len, uint8_t tcmd)
 {
    uint8_t tmp = 0;
-   uint8_t tcmd = Sn_CR_SEND;
    uint16_t freesize = 0;
+   wiz_IOVec one;
+#if _WIZCHIP_ < 5500
+   uint32_t taddr;
+#endif
+
+   // Asynchronous mode: the previous datagram has to be done before the next SEND
+   if(ctx->is_sending & (1<<sn))
+   {
+      tmp = getSn_IR(sn) & (Sn_IR_SENDOK | Sn_IR_TIMEOUT);
+      if(tmp == 0) return SOCK_BUSY;
+      setSn_IR(sn, tmp);
+      sock_send_done(ctx, sn, (tmp & Sn_IR_SENDOK) ? Sn_IR_SENDOK : Sn_IR_TIMEOUT, 0);
+   }
+   freesize = getSn_TxMAX(sn);
+   if (len > freesize) // check size not to exceed MAX size.
+   {
+      // A single buffer is truncated as sendto() always did, a fragment list is not cut
+      if(cnt != 1) return SOCKERR_DATALEN;
+      // Cut a copy, the caller's list stays as it was
+      one.buf = iov[0].buf;
+      one.len = len = freesize;
+      iov = &one;
+   }
+  
+   while(1)
+   {
+      freesize = getSn_TX_FSR(sn);
+      if(getSn_SR(sn) == SOCK_CLOSED) return SOCKERR_SOCKCLOSED;
+      if(len > freesize) SOCK_STAT_INC(stalls);
+      if( (ctx->io_mode & (1<<sn)) && (len > freesize) ) return SOCK_BUSY; 
+      if(len <= freesize) break;
+   };
+   wiz_send_datav(sn, iov, cnt);
+
+   #if _WIZCHIP_ < 5500   //M20150401 : for WIZCHIP Errata #4, #5 (ARP errata)
+      getSIPR((uint8_t*)&taddr);
+      if(taddr == 0)
+      {
+         getSUBR((uint8_t*)&taddr);
+         setSUBR((uint8_t*)"\x00\x00\x00\x00");
+      }
+      else taddr = 0;
+   #endif
+
+#ifdef IPV6_AVAILABLE
+   setSn_CR(sn,tcmd);
+#else
+   (void)tcmd;
+//A20150601 : For W5300
+#if _WIZCHIP_ == 5300
+   setSn_TX_WRSR(sn, len);
+#endif
+//   
+   setSn_CR(sn,Sn_CR_SEND);
+#endif 
+   /* wait to process the command... */
+   while(getSn_CR(sn));
+   ctx->send_ts[sn] = W5500_GetMicros();
+   SOCK_STAT_INC(sends);
+   if(ctx->send_async & (1<<sn))
+   {
+      // The outcome is queued later, refer to sendcompletion()
+      ctx->send_async_len[sn] = len;
+      ctx->is_sending |= (1<<sn);
+   #if _WIZCHIP_ < 5500
+      if(taddr) setSUBR((uint8_t*)&taddr);
+   #endif
+      return (int32_t)len;
+   }
+   while(1)
+   {
+      tmp = getSn_IR(sn);
+      if(tmp & Sn_IR_SENDOK)
+      {
+         setSn_IR(sn, Sn_IR_SENDOK);
+         SOCK_STAT_SENDOK(W5500_GetMicros() - ctx->send_ts[sn]);
+         break;
+      }  
+      //M:20131104
+      //else if(tmp & Sn_IR_TIMEOUT) return SOCKERR_TIMEOUT;
+      else if(tmp & Sn_IR_TIMEOUT)
+      {
+         setSn_IR(sn, Sn_IR_TIMEOUT);   
+         //M20150409 : Fixed the lost of sign bits by type casting.
+         //len = (uint16_t)SOCKERR_TIMEOUT;
+         //break;
+         #if _WIZCHIP_ < 5500   //M20150401 : for WIZCHIP Errata #4, #5 (ARP errata)
+            if(taddr) setSUBR((uint8_t*)&taddr);
+         #endif
+         return SOCKERR_TIMEOUT;
+      }
+      ////////////
+   }  
+   #if _WIZCHIP_ < 5500   //M20150401 : for WIZCHIP Errata #4, #5 (ARP errata)
+      if(taddr) setSUBR((uint8_t*)&taddr);
+   #endif
+   //M20150409 : Explicit Type Casting
+   //return len;
+   return (int32_t)len;
+}
+
+static int32_t sendtov_impl(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt, uint8_t * addr, uint16_t port, uint8_t addrlen)
+{
+   uint8_t tmp = 0;
+   uint8_t tcmd = Sn_CR_SEND;
+   uint16_t len = 0;
    uint32_t taddr;
 
+   if(iov == 0) return SOCKERR_ARG;
+   for(tmp = 0; tmp < cnt; tmp++)
+   {
+      if(((uint32_t)len + iov[tmp].len) > 0xFFFF) return SOCKERR_DATALEN;
+      len += iov[tmp].len;
+   }
+
    /* 
     * The below codes can be omitted for optmization of speed
     */
    CHECK_SOCKNUM();
+   if(addrlen == 4)
+   {
+   #if SOCK_UNREACH_TTL_MS > 0
+      if(sock_unreach_hit(ctx, addr, port)) return SOCKERR_UNREACH;
+   #endif
+      ctx->dgram_dip[sn][0] = addr[0];
+      ctx->dgram_dip[sn][1] = addr[1];
+      ctx->dgram_dip[sn][2] = addr[2];
+      ctx->dgram_dip[sn][3] = addr[3];
+      ctx->dgram_dport[sn] = port;
+   }
+   // Connected UDP: the chip already holds this destination
+   if( (ctx->udp_dst_valid & (1<<sn)) && (addrlen == 4) && (port == ctx->udp_dport[sn]) &&
+       (addr[0] == ctx->udp_dip[sn][0]) && (addr[1] == ctx->udp_dip[sn][1]) &&
+       (addr[2] == ctx->udp_dip[sn][2]) && (addr[3] == ctx->udp_dip[sn][3]) )
+   {
+      CHECK_SOCKDATA();
+      return sock_dgram_issue(ctx, sn, iov, cnt, len, Sn_CR_SEND);
+   }
    //CHECK_DGRAMMODE();
    /************/
    switch(getSn_MR(sn) & 0x0F)
@@ -790,6 +1654,8 @@ static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * ad
          return SOCKERR_SOCKMODE;
    }
    tmp = getSn_MR(sn);
+   // The destination registers are rewritten below, a connected UDP socket has to restore its own on the next udp_send()
+   ctx->udp_dst_valid &= ~(1<<sn);
    if(tmp != Sn_MR_MACRAW)
    {
        if (addrlen == 16)      // addrlen=16, Sn_MR_UDP6(1010), Sn_MR_UDPD(1110)), IPRAW6(1011)
@@ -841,71 +1707,9 @@ static int32_t sendto_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * ad
       
    setSn_DIPR(sn,addr);
    setSn_DPORT(sn,port);   
-#endif 
-
-   freesize = getSn_TxMAX(sn);
-   if (len > freesize) len = freesize; // check size not to exceed MAX size.
-  
-   while(1)
-   {
-      freesize = getSn_TX_FSR(sn);
-      if(getSn_SR(sn) == SOCK_CLOSED) return SOCKERR_SOCKCLOSED;
-      if( (sock_io_mode & (1<<sn)) && (len > freesize) ) return SOCK_BUSY; 
-      if(len <= freesize) break;
-   };
-   wiz_send_data(sn, buf, len);
-
-   #if _WIZCHIP_ < 5500   //M20150401 : for WIZCHIP Errata #4, #5 (ARP errata)
-      getSIPR((uint8_t*)&taddr);
-      if(taddr == 0)
-      {
-         getSUBR((uint8_t*)&taddr);
-         setSUBR((uint8_t*)"\x00\x00\x00\x00");
-      }
-      else taddr = 0;
-   #endif
-
-#ifdef IPV6_AVAILABLE
-   setSn_CR(sn,tcmd);
-#else
-//A20150601 : For W5300
-#if _WIZCHIP_ == 5300
-   setSn_TX_WRSR(sn, len);
 #endif
-//   
-   setSn_CR(sn,Sn_CR_SEND);
-#endif 
-   /* wait to process the command... */
-   while(getSn_CR(sn));
-   while(1)
-   {
-      tmp = getSn_IR(sn);
-      if(tmp & Sn_IR_SENDOK)
-      {
-         setSn_IR(sn, Sn_IR_SENDOK);
-         break;
-      }  
-      //M:20131104
-      //else if(tmp & Sn_IR_TIMEOUT) return SOCKERR_TIMEOUT;
-      else if(tmp & Sn_IR_TIMEOUT)
-      {
-         setSn_IR(sn, Sn_IR_TIMEOUT);   
-         //M20150409 : Fixed the lost of sign bits by type casting.
-         //len = (uint16_t)SOCKERR_TIMEOUT;
-         //break;
-         #if _WIZCHIP_ < 5500   //M20150401 : for WIZCHIP Errata #4, #5 (ARP errata)
-            if(taddr) setSUBR((uint8_t*)&taddr);
-         #endif
-         return SOCKERR_TIMEOUT;
-      }
-      ////////////
-   }  
-   #if _WIZCHIP_ < 5500   //M20150401 : for WIZCHIP Errata #4, #5 (ARP errata)
-      if(taddr) setSUBR((uint8_t*)&taddr);
-   #endif
-   //M20150409 : Explicit Type Casting
-   //return len;
-   return (int32_t)len;
+
+   return sock_dgram_issue(ctx, sn, iov, cnt, len, tcmd);
 }
 
 
@@ -915,15 +1719,15 @@ int32_t recvfrom_W5x00(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr,
    // printf("recvfrom_W5x00\r\n" ) ;
    uint8_t addrlen = 4; //M20150601 : For W5300
    uint8_t *dummy = &addrlen;
-   return recvfrom_IO_6(sn,   buf,  len,   addr,  port, dummy);
+   return recvfrom_ctx(&sock_ctx_default, sn,   buf,  len,   addr,  port, dummy);
 }
 
 int32_t recvfrom_W6x00(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port, uint8_t *addrlen ){
    // printf("recvfrom_W6x00\r\n" ) ;
    //int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port)
-   return recvfrom_IO_6( sn,  buf,  len,   addr,  port, addrlen);
+   return recvfrom_ctx(&sock_ctx_default, sn,  buf,  len,   addr,  port, addrlen);
 }
-static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port, uint8_t *addrlen) //TODO : WILL BE IMPROVED
+static int32_t recvfrom_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port, uint8_t *addrlen) //TODO : WILL BE IMPROVED
 { 
 //M20150601 : For W5300   
 #if _WIZCHIP_ == 5300
@@ -940,6 +1744,7 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
     * The below codes can be omitted for optmization of speed
     */
    CHECK_SOCKNUM();
+   ctx->poll_synced &= ~(1<<sn);
    //CHECK_DGRAMMODE();
    //CHECK_SOCKDATA();
    /************/
@@ -964,22 +1769,22 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
          return SOCKERR_SOCKMODE;
    }
    CHECK_SOCKDATA();
-   if(sock_remained_size[sn] == 0)
+   if(ctx->remained_size[sn] == 0)
    {
       while(1)
       {
          pack_len = getSn_RX_RSR(sn);
          if(getSn_SR(sn) == SOCK_CLOSED) return SOCKERR_SOCKCLOSED;
 #ifndef IPV6_AVAILABLE
-         if( (sock_io_mode & (1<<sn)) && (pack_len == 0) ) return SOCK_BUSY;
+         if( (ctx->io_mode & (1<<sn)) && (pack_len == 0) ) return SOCK_BUSY;
          if(pack_len != 0) break;
 #else
          if(pack_len != 0)
          {
-            sock_pack_info[sn] = PACK_NONE;
+            ctx->pack_info[sn] = PACK_NONE;
             break;
          } 
-         if( sock_io_mode & (1<<sn) ) return SOCK_BUSY;
+         if( ctx->io_mode & (1<<sn) ) return SOCK_BUSY;
 #endif 
       };
    }
@@ -1002,9 +1807,9 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
             if(addr == 0) 
                return SOCKERR_ARG;
             
-            sock_pack_info[sn] = head[0] & 0xF8;
+            ctx->pack_info[sn] = head[0] & 0xF8;
            
-            if(sock_pack_info[sn] & PACK_IPv6) {
+            if(ctx->pack_info[sn] & PACK_IPv6) {
                *addrlen = 16 ; 
             }else{ 
                *addrlen = 4 ; 
@@ -1015,7 +1820,7 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
             while(getSn_CR(sn));
 
 #else    
-         if(sock_remained_size[sn] == 0)
+         if(ctx->remained_size[sn] == 0)
          {
             wiz_recv_data(sn, head, 8);
             setSn_CR(sn,Sn_CR_RECV);
@@ -1031,8 +1836,8 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
    		      addr[3] = head[2];
    		      *port = head[5];
    		      *port = (*port << 8) + head[4];
-      			sock_remained_size[sn] = head[7];
-      			sock_remained_size[sn] = (sock_remained_size[sn] << 8) + head[6];
+      			ctx->remained_size[sn] = head[7];
+      			ctx->remained_size[sn] = (ctx->remained_size[sn] << 8) + head[6];
    		   }
             else
             {
@@ -1043,24 +1848,24 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
             addr[3] = head[3];
             *port = head[4];
             *port = (*port << 8) + head[5];
-            sock_remained_size[sn] = head[6];
-            sock_remained_size[sn] = (sock_remained_size[sn] << 8) + head[7];
+            ctx->remained_size[sn] = head[6];
+            ctx->remained_size[sn] = (ctx->remained_size[sn] << 8) + head[7];
          #if _WIZCHIP_ == 5300
             }
          #endif
-            sock_pack_info[sn] = PACK_FIRST;
+            ctx->pack_info[sn] = PACK_FIRST;
          }
-			if(len < sock_remained_size[sn]) pack_len = len;
-			else pack_len = sock_remained_size[sn];
+			if(len < ctx->remained_size[sn]) pack_len = len;
+			else pack_len = ctx->remained_size[sn];
 			//A20150601 : For W5300
 			len = pack_len;
 			#if _WIZCHIP_ == 5300
-			   if(sock_pack_info[sn] & PACK_FIFOBYTE)
+			   if(ctx->pack_info[sn] & PACK_FIFOBYTE)
 			   {
-			      *buf++ = sock_remained_byte[sn];
+			      *buf++ = ctx->remained_byte[sn];
 			      pack_len -= 1;
-			      sock_remained_size[sn] -= 1;
-			      sock_pack_info[sn] &= ~PACK_FIFOBYTE;
+			      ctx->remained_size[sn] -= 1;
+			      ctx->pack_info[sn] &= ~PACK_FIFOBYTE;
 			   }
 			#endif
 			//
@@ -1070,7 +1875,7 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
 #endif         
             break;
       case Sn_MR_MACRAW :
-	      if(sock_remained_size[sn] == 0)
+	      if(ctx->remained_size[sn] == 0)
 	      {
    			wiz_recv_data(sn, head, 2);
    			setSn_CR(sn,Sn_CR_RECV);
@@ -1080,29 +1885,29 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
           #endif
         }
    			// read peer's IP address, port number & packet length
-    			sock_remained_size[sn] = head[0];
-   			sock_remained_size[sn] = (sock_remained_size[sn] <<8) + head[1] -2;
+    			ctx->remained_size[sn] = head[0];
+   			ctx->remained_size[sn] = (ctx->remained_size[sn] <<8) + head[1] -2;
    			#if _WIZCHIP_ == W5300
-   			if(sock_remained_size[sn] & 0x01)
-   				sock_remained_size[sn] = sock_remained_size[sn] + 1 - 4;
+   			if(ctx->remained_size[sn] & 0x01)
+   				ctx->remained_size[sn] = ctx->remained_size[sn] + 1 - 4;
    			else
-   				sock_remained_size[sn] -= 4;
+   				ctx->remained_size[sn] -= 4;
 			#endif
-   			if(sock_remained_size[sn] > 1514) 
+   			if(ctx->remained_size[sn] > 1514) 
    			{
-   			   close(sn);
+   			   close_impl(ctx, sn);
    			   return SOCKFATAL_PACKLEN;
    			}
-   			sock_pack_info[sn] = PACK_FIRST;
+   			ctx->pack_info[sn] = PACK_FIRST;
    	   }
-			if(len < sock_remained_size[sn]) pack_len = len;
-			else pack_len = sock_remained_size[sn];
+			if(len < ctx->remained_size[sn]) pack_len = len;
+			else pack_len = ctx->remained_size[sn];
 			wiz_recv_data(sn,buf,pack_len);
          break; 
    //#if ( _WIZCHIP_ < 5200 )
       case Sn_MR_IPRAW6:
       case Sn_MR_IPRAW4 : 
-         if(sock_remained_size[sn] == 0)
+         if(ctx->remained_size[sn] == 0)
          {
 #ifndef IPV6_AVAILABLE
             wiz_recv_data(sn, head, 6);
@@ -1112,21 +1917,15 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
             addr[1] = head[1];
             addr[2] = head[2];
             addr[3] = head[3];
-            sock_remained_size[sn] = head[4];
+            ctx->remained_size[sn] = head[4];
             //M20150401 : For Typing Error
             //sock_remaiend_size[sn] = (sock_remained_size[sn] << 8) + head[5];
-            sock_remained_size[sn] = (sock_remained_size[sn] << 8) + head[5];
-            sock_pack_info[sn] = PACK_FIRST;
-         //
-         // Need to packet length check
-         //
-         if(len < sock_remained_size[sn]) pack_len = len;
-         else pack_len = sock_remained_size[sn];
-         wiz_recv_data(sn, buf, pack_len); // data copy.
+            ctx->remained_size[sn] = (ctx->remained_size[sn] << 8) + head[5];
+            ctx->pack_info[sn] = PACK_FIRST;
 #else
             if(*addr == 0) return SOCKERR_ARG;
-            sock_pack_info[sn] = head[0] & 0xF8;
-            if(sock_pack_info[sn] & PACK_IPv6) *addrlen = 16;
+            ctx->pack_info[sn] = head[0] & 0xF8;
+            if(ctx->pack_info[sn] & PACK_IPv6) *addrlen = 16;
             else *addrlen = 4;
             wiz_recv_data(sn, addr, *addrlen);
             setSn_CR(sn,Sn_CR_RECV);
@@ -1134,15 +1933,24 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
            
 #endif
          }
+#ifndef IPV6_AVAILABLE
+         // The rest of a packet longer than len comes with the next calls, as in UDP mode
+         //
+         // Need to packet length check
+         //
+         if(len < ctx->remained_size[sn]) pack_len = len;
+         else pack_len = ctx->remained_size[sn];
+         wiz_recv_data(sn, buf, pack_len); // data copy.
+#endif
          break;
          default:
             wiz_recv_ignore(sn, pack_len); // data copy.
-            sock_remained_size[sn] = pack_len;
+            ctx->remained_size[sn] = pack_len;
             break;
       }
 #ifdef IPV6_AVAILABLE
-      sock_remained_size[sn] = pack_len;
-      sock_pack_info[sn] |= PACK_FIRST;
+      ctx->remained_size[sn] = pack_len;
+      ctx->pack_info[sn] |= PACK_FIRST;
       if((getSn_MR(sn) & 0x03) == 0x02)  // Sn_MR_UDP4(0010), Sn_MR_UDP6(1010), Sn_MR_UDPD(1110)
       {
          /* Read port number of PACKET INFO in SOCKETn RX buffer */
@@ -1153,32 +1961,32 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
          while(getSn_CR(sn));   
       }
             
-      if   (len < sock_remained_size[sn]) pack_len = len;
-      else pack_len = sock_remained_size[sn];    
+      if   (len < ctx->remained_size[sn]) pack_len = len;
+      else pack_len = ctx->remained_size[sn];    
       wiz_recv_data(sn, buf, pack_len);
       setSn_CR(sn,Sn_CR_RECV);  
    /* wait to process the command... */
       while(getSn_CR(sn)) ;
          
-      sock_remained_size[sn] -= pack_len;
-      if(sock_remained_size[sn] != 0) sock_pack_info[sn] |= PACK_REMAINED;
-      else sock_pack_info[sn] |= PACK_COMPLETED;
+      ctx->remained_size[sn] -= pack_len;
+      if(ctx->remained_size[sn] != 0) ctx->pack_info[sn] |= PACK_REMAINED;
+      else ctx->pack_info[sn] |= PACK_COMPLETED;
       
 #else 
 	setSn_CR(sn,Sn_CR_RECV);
 	/* wait to process the command... */
 	while(getSn_CR(sn)) ;
-	sock_remained_size[sn] -= pack_len;
+	ctx->remained_size[sn] -= pack_len;
 	//M20150601 : 
 	//if(sock_remained_size[sn] != 0) sock_pack_info[sn] |= 0x01;
-	if(sock_remained_size[sn] != 0)
+	if(ctx->remained_size[sn] != 0)
 	{
-	   sock_pack_info[sn] |= PACK_REMAINED;
+	   ctx->pack_info[sn] |= PACK_REMAINED;
    #if _WIZCHIP_ == 5300	   
-	   if(pack_len & 0x01) sock_pack_info[sn] |= PACK_FIFOBYTE;
+	   if(pack_len & 0x01) ctx->pack_info[sn] |= PACK_FIFOBYTE;
    #endif	      
 	}
-	else sock_pack_info[sn] = PACK_COMPLETED;
+	else ctx->pack_info[sn] = PACK_COMPLETED;
 #if _WIZCHIP_ == 5300	   
    pack_len = len;
 #endif
@@ -1190,22 +1998,35 @@ static int32_t recvfrom_IO_6(uint8_t sn, uint8_t * buf, uint16_t len, uint8_t *
 }
 
 
-int8_t  ctlsocket(uint8_t sn, ctlsock_type cstype, void* arg)
+static int8_t ctlsocket_impl(wiz_SockCtx* ctx, uint8_t sn, ctlsock_type cstype, void* arg)
 {
    uint8_t tmp = 0;
    CHECK_SOCKNUM();
-   tmp = *((uint8_t*)arg); 
+   // The statistics clears take no argument
+   switch(cstype)
+   {
+      case CS_CLR_RECVWAIT:
+#if _WIZCHIP_STATS_
+      case CS_CLR_SOCKSTAT:
+#endif
+      case CS_CLR_COALSTAT:
+         break;
+      default:
+         if(arg == 0) return SOCKERR_ARG;
+         tmp = *((uint8_t*)arg);
+         break;
+   }
    switch(cstype)
    {
       case CS_SET_IOMODE:
-         if(tmp == SOCK_IO_NONBLOCK)  sock_io_mode |= (1<<sn);
-         else if(tmp == SOCK_IO_BLOCK) sock_io_mode &= ~(1<<sn);
+         if(tmp == SOCK_IO_NONBLOCK)  ctx->io_mode |= (1<<sn);
+         else if(tmp == SOCK_IO_BLOCK) ctx->io_mode &= ~(1<<sn);
          else return SOCKERR_ARG;
          break;
       case CS_GET_IOMODE: 
          //M20140501 : implict type casting -> explict type casting
          //*((uint8_t*)arg) = (sock_io_mode >> sn) & 0x0001;
-         *((uint8_t*)arg) = (uint8_t)((sock_io_mode >> sn) & 0x0001);
+         *((uint8_t*)arg) = (uint8_t)((ctx->io_mode >> sn) & 0x0001);
          //
          break;
       case CS_GET_MAXTXBUF:
@@ -1230,6 +2051,58 @@ int8_t  ctlsocket(uint8_t sn, ctlsock_type cstype, void* arg)
          *((uint8_t*)arg) = getSn_IMR(sn);
          break;
 #endif
+      case CS_SET_SENDMODE:
+         if((getSn_MR(sn) & 0x0F) == Sn_MR_TCP) return SOCKERR_SOCKMODE;
+         if(tmp == SOCK_SEND_ASYNC) ctx->send_async |= (1<<sn);
+         else if(tmp == SOCK_SEND_SYNC)
+         {
+            // Leaving asynchronous mode with a SEND in flight would lose its outcome
+            if(ctx->is_sending & (1<<sn)) return SOCK_BUSY;
+            ctx->send_async &= ~(1<<sn);
+         }
+         else return SOCKERR_ARG;
+         break;
+      case CS_GET_SENDMODE:
+         *((uint8_t*)arg) = (uint8_t)((ctx->send_async >> sn) & 0x0001);
+         break;
+      case CS_GET_RECVWAIT:
+         *((wiz_RecvWait*)arg) = ctx->recv_wait[sn];
+         break;
+      case CS_CLR_RECVWAIT:
+         ctx->recv_wait[sn] = (wiz_RecvWait){0,};
+         break;
+#if _WIZCHIP_STATS_
+      case CS_GET_SOCKSTAT:
+         *((wiz_SockStat*)arg) = ctx->stat[sn];
+         ((wiz_SockStat*)arg)->sendok_avg_us = ctx->stat[sn].sendok ? (uint32_t)(ctx->stat[sn].sendok_sum_us / ctx->stat[sn].sendok) : 0;
+         break;
+      case CS_CLR_SOCKSTAT:
+         ctx->stat[sn] = (wiz_SockStat){0,};
+         break;
+#endif
+      case CS_SET_COALESCE:
+         // Only send() coalesces, on another socket the setting would be ignored silently
+         if(((wiz_Coalesce*)arg)->enable && (getSn_MR(sn) & 0x0F) != Sn_MR_TCP) return SOCKERR_SOCKMODE;
+         // Switching off hands over whatever is still pending
+         if(!((wiz_Coalesce*)arg)->enable && ctx->coal_pending[sn])
+         {
+            if(send_flush_impl(ctx, sn) != SOCK_OK) return SOCKERR_SOCKSTATUS;
+         }
+         ctx->coal_cfg[sn] = *((wiz_Coalesce*)arg);
+         ctx->coal_mss[sn] = 0;
+         break;
+      case CS_GET_COALESCE:
+         *((wiz_Coalesce*)arg) = ctx->coal_cfg[sn];
+         break;
+      case CS_GET_COALSTAT:
+         *((wiz_CoalStat*)arg) = ctx->coal_stat[sn];
+         // Payload share of the wire bytes, with Ethernet(14) + IPv4(20) + TCP(20) headers per segment
+         ((wiz_CoalStat*)arg)->goodput_pct = ctx->coal_stat[sn].bytes ?
+            (uint8_t)((ctx->coal_stat[sn].bytes * 100ULL) / (ctx->coal_stat[sn].bytes + 54ULL * ctx->coal_stat[sn].segments)) : 0;
+         break;
+      case CS_CLR_COALSTAT:
+         ctx->coal_stat[sn] = (wiz_CoalStat){0,};
+         break;
 #ifdef IPV6_AVAILABLE
       case CS_SET_PREFER:
     	  if((tmp & 0x03) == 0x01) return SOCKERR_ARG;
@@ -1245,7 +2118,7 @@ int8_t  ctlsocket(uint8_t sn, ctlsock_type cstype, void* arg)
    return SOCK_OK;
 }
 
-int8_t  setsockopt(uint8_t sn, sockopt_type sotype, void* arg)
+static int8_t setsockopt_impl(wiz_SockCtx* ctx, uint8_t sn, sockopt_type sotype, void* arg)
 {
  // M20131220 : Remove warning
  //uint8_t tmp;
@@ -1262,6 +2135,9 @@ int8_t  setsockopt(uint8_t sn, sockopt_type sotype, void* arg)
          setSn_MSSR(sn,*(uint16_t*)arg);
          break;
       case SO_DESTIP:
+         if(arg == 0) return SOCKERR_ARG;
+         // Sn_DIPR no longer holds the cached UDP destination
+         ctx->udp_dst_valid &= ~(1<<sn);
 #ifdef IPV6_AVAILABLE
          if(((wiz_IPAddress*)arg)->len == 16) 
             setSn_DIP6R(sn, ((wiz_IPAddress*)arg)->ip);
@@ -1270,6 +2146,8 @@ int8_t  setsockopt(uint8_t sn, sockopt_type sotype, void* arg)
          setSn_DIPR(sn, (uint8_t*)arg);
          break;
       case SO_DESTPORT:
+         if(arg == 0) return SOCKERR_ARG;
+         ctx->udp_dst_valid &= ~(1<<sn);
          setSn_DPORTR(sn, *(uint16_t*)arg);
          break;
 #if _WIZCHIP_ != 5100 
@@ -1303,14 +2181,14 @@ int8_t  setsockopt(uint8_t sn, sockopt_type sotype, void* arg)
    return SOCK_OK;
 }
 
-int8_t getsockopt(uint8_t sn, sockopt_type sotype, void* arg)
+static int8_t getsockopt_impl(wiz_SockCtx* ctx, uint8_t sn, sockopt_type sotype, void* arg)
 {
    CHECK_SOCKNUM();
    switch(sotype)
    {
       case SO_FLAG:
 #ifdef IPV6_AVAILABLE
-         *(uint8_t*)arg = (getSn_MR(sn) & 0xF0) | (getSn_MR2(sn)) | ((uint8_t)(((sock_io_mode >> sn) & 0x0001) << 3));
+         *(uint8_t*)arg = (getSn_MR(sn) & 0xF0) | (getSn_MR2(sn)) | ((uint8_t)(((ctx->io_mode >> sn) & 0x0001) << 3));
 #endif
          *(uint8_t*)arg = getSn_MR(sn) & 0xF0;
          break;
@@ -1367,12 +2245,12 @@ int8_t getsockopt(uint8_t sn, sockopt_type sotype, void* arg)
       case SO_REMAINSIZE:
          if(getSn_MR(sn)==SOCK_CLOSED) return SOCKERR_SOCKSTATUS;
          if(getSn_MR(sn) & 0x01)   *(uint16_t*)arg = getSn_RX_RSR(sn);
-         else                      *(uint16_t*)arg = sock_remained_size[sn];
+         else                      *(uint16_t*)arg = ctx->remained_size[sn];
          break;
       case SO_PACKINFO:
          if(getSn_MR(sn)==SOCK_CLOSED) return SOCKERR_SOCKSTATUS;
          if(getSn_MR(sn) & 0x01)       return SOCKERR_SOCKMODE;
-         else *(uint8_t*)arg = sock_pack_info[sn];
+         else *(uint8_t*)arg = ctx->pack_info[sn];
          break;
       case SO_MODE:
          *(uint8_t*) arg = 0x0F & getSn_MR(sn);
@@ -1382,7 +2260,7 @@ int8_t getsockopt(uint8_t sn, sockopt_type sotype, void* arg)
                if(getSn_MR(sn) & Sn_MR_TCP)
                   *(uint16_t*)arg = getSn_RX_RSR(sn);
                else
-                  *(uint16_t*)arg = sock_remained_size[sn];
+                  *(uint16_t*)arg = ctx->remained_size[sn];
                break;
       case SO_PACKINFO  :
                //CHECK_SOCKMODE(Sn_MR_TCP);
@@ -1390,7 +2268,7 @@ int8_t getsockopt(uint8_t sn, sockopt_type sotype, void* arg)
                if((getSn_MR(sn) == Sn_MR_TCP))
                   return SOCKERR_SOCKMODE;
       #endif
-               *(uint8_t*)arg = sock_pack_info[sn];
+               *(uint8_t*)arg = ctx->pack_info[sn];
                break;
 
 #endif 
@@ -1425,5 +2303,851 @@ int16_t peeksockmsg(uint8_t sn, uint8_t* submsg, uint16_t subsize)
 }
 
 
-#endif 
+#endif
+
+static void unreachable_clear_impl(wiz_SockCtx* ctx)
+{
+   _WIZCHIP* chip = ctx->chip ? ctx->chip : &WIZCHIP;
+   uint8_t i;
+   for(i = 0; i < SOCK_UNREACH_SIZE; i++) chip->unreach[i].ts = 0;
+}
+
+static int8_t sendcompletion_impl(wiz_SockCtx* ctx, wiz_SendEvent* ev)
+{
+   uint8_t sn;
+   uint8_t ir;
 
+   if(ev == 0) return SOCKERR_ARG;
+   if(ctx->sendq_cnt == 0)
+   {
+      for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+      {
+         if(!(ctx->send_async & ctx->is_sending & (1<<sn))) continue;
+         ir = getSn_IR(sn) & (Sn_IR_SENDOK | Sn_IR_TIMEOUT);
+         if(ir == 0) continue;
+         setSn_IR(sn, ir);
+         sock_send_done(ctx, sn, (ir & Sn_IR_SENDOK) ? Sn_IR_SENDOK : Sn_IR_TIMEOUT, 0);
+      }
+      if(ctx->sendq_cnt == 0) return SOCK_BUSY;
+   }
+   *ev = ctx->sendq[ctx->sendq_head];
+   ctx->sendq_head = (ctx->sendq_head + 1) % SOCK_SENDQ_SIZE;
+   ctx->sendq_cnt--;
+   return SOCK_OK;
+}
+
+static int8_t udp_connect_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * addr, uint16_t port)
+{
+   CHECK_SOCKNUM();
+   CHECK_SOCKMODE(Sn_MR_UDP);
+   if(addr == 0)
+   {
+      ctx->udp_conn &= ~(1<<sn);
+      return SOCK_OK;
+   }
+   if((addr[0] | addr[1] | addr[2] | addr[3]) == 0) return SOCKERR_IPINVALID;
+   if(port == 0) return SOCKERR_PORTZERO;
+   if(getSn_SR(sn) != SOCK_UDP) return SOCKERR_SOCKSTATUS;
+   setSn_DIPR(sn,addr);
+   setSn_DPORT(sn,port);
+   ctx->udp_dip[sn][0] = addr[0];
+   ctx->udp_dip[sn][1] = addr[1];
+   ctx->udp_dip[sn][2] = addr[2];
+   ctx->udp_dip[sn][3] = addr[3];
+   ctx->udp_dport[sn] = port;
+   ctx->udp_conn |= (1<<sn);
+   ctx->udp_dst_valid |= (1<<sn);
+   return SOCK_OK;
+}
+
+static int32_t udp_send_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   wiz_IOVec iov;
+
+   CHECK_SOCKNUM();
+   if(!(ctx->udp_conn & (1<<sn))) return SOCKERR_SOCKSTATUS;
+   CHECK_SOCKDATA();
+   // No unreachable lookup: it reads IR every SOCK_UNREACH_CHECK_MS, sendto() keeps it
+   ctx->dgram_dip[sn][0] = ctx->udp_dip[sn][0];
+   ctx->dgram_dip[sn][1] = ctx->udp_dip[sn][1];
+   ctx->dgram_dip[sn][2] = ctx->udp_dip[sn][2];
+   ctx->dgram_dip[sn][3] = ctx->udp_dip[sn][3];
+   ctx->dgram_dport[sn] = ctx->udp_dport[sn];
+   // Only after a sendto() to another peer the destination has to be programmed again
+   if(!(ctx->udp_dst_valid & (1<<sn)))
+   {
+      setSn_DIPR(sn,ctx->udp_dip[sn]);
+      setSn_DPORT(sn,ctx->udp_dport[sn]);
+      ctx->udp_dst_valid |= (1<<sn);
+   }
+   iov.buf = buf;
+   iov.len = len;
+   return sock_dgram_issue(ctx, sn, &iov, 1, len, Sn_CR_SEND);
+}
+
+static int32_t recvfrom_view_impl(wiz_SockCtx* ctx, uint8_t sn, void (*cb)(wiz_DgramView* view, void* arg), void* arg)
+{
+   wiz_DgramView view;
+   uint8_t  head[8];
+   uint16_t ptr;
+   uint16_t rsr;
+
+   CHECK_SOCKNUM();
+   CHECK_SOCKMODE(Sn_MR_UDP);
+   if(cb == 0) return SOCKERR_ARG;
+   // A datagram partly read by recvfrom() has to be finished there first
+   if(ctx->remained_size[sn] != 0) return SOCKERR_SOCKSTATUS;
+   ctx->poll_synced &= ~(1<<sn);
+   view.len = 0;
+   while(1)
+   {
+      rsr = getSn_RX_RSR(sn);
+      if(getSn_SR(sn) == SOCK_CLOSED) return SOCKERR_SOCKCLOSED;
+      // The 8-byte header may still be arriving, then the rest of the payload
+      if(rsr >= 8 && view.len == 0)
+      {
+         ptr = getSn_RX_RD(sn);
+         wiz_recv_data_at(sn, ptr, head, 8);
+         view.len = (((uint16_t)head[6]) << 8) + head[7];
+         // A length the RX memory can't hold is no header: drop what is there
+         if((uint32_t)view.len + 8 > (uint32_t)getSn_RxMAX(sn))
+         {
+            setSn_RX_RD(sn, (uint16_t)(ptr + rsr));
+            setSn_CR(sn,Sn_CR_RECV);
+            while(getSn_CR(sn));
+            return SOCKERR_DATALEN;
+         }
+      }
+      if(rsr >= 8 && rsr - 8 >= view.len) break;
+      // Left unread until complete, the caller never sees a cut datagram
+      if(ctx->io_mode & (1<<sn)) return SOCK_BUSY;
+   }
+   view.sn = sn;
+   view.addr[0] = head[0];
+   view.addr[1] = head[1];
+   view.addr[2] = head[2];
+   view.addr[3] = head[3];
+   view.port = (((uint16_t)head[4]) << 8) + head[5];
+   view.base = ptr + 8;
+   cb(&view, arg);
+   // Whatever the callback did not read is dropped by moving the read pointer, no copy
+   ptr = view.base + view.len;
+   setSn_RX_RD(sn, ptr);
+   setSn_CR(sn,Sn_CR_RECV);
+   while(getSn_CR(sn));
+   ctx->pack_info[sn] = PACK_COMPLETED;
+   return (int32_t)view.len;
+}
+
+int32_t dgram_read(wiz_DgramView* view, uint16_t offset, uint8_t * buf, uint16_t len)
+{
+   if(view == 0 || buf == 0) return SOCKERR_ARG;
+   if(offset >= view->len) return 0;
+   if(len > view->len - offset) len = view->len - offset;
+   wiz_recv_data_at(view->sn, view->base + offset, buf, len);
+   return (int32_t)len;
+}
+
+/*
+ * Fold the pending interrupt of socket sn into the readiness cache of the context.
+ * Sn_IR and Sn_SR are adjacent, so both come with one burst. Sn_RX_RSR is read only
+ * when the cache of the socket was invalidated by an API call.
+ * Only the bits accounted for here are cleared: SEND_OK and a datagram TIMEOUT are
+ * left to the context that issued the SEND.
+ */
+static void sock_poll_update(wiz_SockCtx* ctx, uint8_t sn)
+{
+   uint8_t reg[2];   // Sn_IR, Sn_SR
+   uint8_t ir;
+
+   WIZCHIP_READ_BUF(Sn_IR(sn), reg, 2);
+   ir = reg[0] & 0x1F;
+   if(!(ctx->is_sending & (1<<sn)))
+   {
+      ir &= ~Sn_IR_SENDOK;
+      if((ir & Sn_IR_TIMEOUT) && (getSn_MR(sn) & 0x0F) != Sn_MR_TCP) ir &= ~Sn_IR_TIMEOUT;
+   }
+   if(ir) setSn_IR(sn, ir);
+   ctx->poll_sr[sn] = reg[1];
+   if(!(ctx->poll_synced & (1<<sn)))
+   {
+      if(getSn_RX_RSR(sn)) ctx->poll_rd |= (1<<sn);
+      else                 ctx->poll_rd &= ~(1<<sn);
+      ctx->poll_synced |= (1<<sn);
+   }
+   if(ir & Sn_IR_RECV) ctx->poll_rd |= (1<<sn);
+   // SEND_OK is consumed here, so the completion of the pending SEND is accounted as send() would do it
+   if((ir & (Sn_IR_SENDOK | Sn_IR_TIMEOUT)) && (ctx->is_sending & (1<<sn)))
+      sock_send_done(ctx, sn, (ir & Sn_IR_SENDOK) ? Sn_IR_SENDOK : Sn_IR_TIMEOUT, 0);
+   if(ir & Sn_IR_TIMEOUT) ctx->poll_err |= (1<<sn);
+   // Sn_IR is cleared above, so the end of a connection is reported here or never
+   if(ir & Sn_IR_TIMEOUT) sock_tcp_down(ctx, sn, SOCK_DISCON_TIMEOUT);
+   else if((ir & Sn_IR_DISCON) || reg[1] == SOCK_CLOSED || reg[1] == SOCK_CLOSE_WAIT) sock_tcp_down(ctx, sn, SOCK_DISCON_PEER);
+   else if(reg[1] == SOCK_ESTABLISHED)
+   {
+      if(!(ctx->tcp_up & (1<<sn))) sock_tcp_up(ctx, sn);
+      else if(ir & Sn_IR_RECV) ctx->alive_ts[sn] = W5500_GetMicros();
+   }
+}
+
+static int16_t socket_check_impl(wiz_SockCtx* ctx, uint8_t sn)
+{
+   CHECK_SOCKNUM();
+   sock_poll_update(ctx, sn);
+   return ctx->poll_sr[sn];
+}
+
+static int32_t recv_timeout_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint32_t timeout_ms)
+{
+   uint32_t start;
+   uint32_t waited;
+   uint32_t backoff = SOCK_RECV_BACKOFF_MIN_MS;
+   uint8_t  first = 1;
+   int32_t  ret;
+
+   CHECK_SOCKNUM();
+   CHECK_SOCKMODE(Sn_MR_TCP);
+   CHECK_SOCKDATA();
+   start = W5500_GetMicros();
+   while(1)
+   {
+      sock_poll_update(ctx, sn);
+      // Data, or a state recv() has to deal with (peer closed, connection lost)
+      if((ctx->poll_rd & (1<<sn)) || ctx->poll_sr[sn] != SOCK_ESTABLISHED) break;
+      if(first)
+      {
+         ctx->recv_wait[sn].waits++;
+         first = 0;
+      }
+      else ctx->recv_wait[sn].wasted++;
+      waited = (W5500_GetMicros() - start) / 1000;
+      if(waited >= timeout_ms)
+      {
+         ctx->recv_wait[sn].timeouts++;
+         return SOCKERR_TIMEOUT;
+      }
+      waited = timeout_ms - waited;
+      if(waited > backoff) waited = backoff;
+      if(ctx->poll_wait) ctx->poll_wait(waited);
+      else W5500_Delay(waited);
+      if(backoff < SOCK_RECV_BACKOFF_MAX_MS) backoff <<= 1;
+      ctx->recv_wait[sn].checks++;
+   }
+   // recv() is called in non-block mode so it can never spin
+   if(ctx->io_mode & (1<<sn)) return recv_impl(ctx, sn, buf, len);
+   ctx->io_mode |= (1<<sn);
+   ret = recv_impl(ctx, sn, buf, len);
+   ctx->io_mode &= ~(1<<sn);
+   return ret;
+}
+
+#if _WIZCHIP_ == 5500
+#define SOCK_SNAP_LEN      0x2A   // Sn_MR .. Sn_RX_RD
+#define SOCK_SNAP_MR       0x00
+#define SOCK_SNAP_CR       0x01
+#define SOCK_SNAP_SR       0x03
+#define SOCK_SNAP_TX_FSR   0x20
+#define SOCK_SNAP_RX_RSR   0x26
+#define SOCK_SNAP_RX_RD    0x28
+#endif
+
+static int32_t recv_avail_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
+{
+#if _WIZCHIP_ == 5500
+   uint8_t  snap[SOCK_SNAP_LEN];
+   uint16_t rsr, rd;
+
+   CHECK_SOCKNUM();
+   CHECK_SOCKDATA();
+   ctx->poll_synced &= ~(1<<sn);
+   // Mode, command, status, free size, received size and read pointer in one burst
+   WIZCHIP_READ_BUF(Sn_MR(sn), snap, SOCK_SNAP_LEN);
+   if((snap[SOCK_SNAP_MR] & 0x0F) != Sn_MR_TCP) return SOCKERR_SOCKMODE;
+   // The RECV of the previous call not taken by the chip yet
+   if(snap[SOCK_SNAP_CR]) return SOCK_BUSY;
+   // Sn_RX_RSR only grows until RECV, a byte torn by an update reads low, never past the data
+   rsr = ((uint16_t)snap[SOCK_SNAP_RX_RSR] << 8) | snap[SOCK_SNAP_RX_RSR + 1];
+   if(snap[SOCK_SNAP_SR] != SOCK_ESTABLISHED)
+   {
+      if(snap[SOCK_SNAP_SR] != SOCK_CLOSE_WAIT ||
+         (rsr == 0 && (((uint16_t)snap[SOCK_SNAP_TX_FSR] << 8) | snap[SOCK_SNAP_TX_FSR + 1]) == getSn_TxMAX(sn)))
+      {
+         close_impl(ctx, sn);
+         return SOCKERR_SOCKSTATUS;
+      }
+   }
+   if(rsr == 0) return SOCK_BUSY;
+   if(len > rsr) len = rsr;
+   rd = ((uint16_t)snap[SOCK_SNAP_RX_RD] << 8) | snap[SOCK_SNAP_RX_RD + 1];
+   wiz_recv_data_at(sn, rd, buf, len);
+   rd += len;
+   snap[0] = (uint8_t)(rd >> 8);
+   snap[1] = (uint8_t)rd;
+   WIZCHIP_WRITE_BUF(Sn_RX_RD(sn), snap, 2);
+   // Not waited for: the next call finds it in Sn_CR if the chip has not taken it yet
+   setSn_CR(sn, Sn_CR_RECV);
+   ctx->alive_ts[sn] = W5500_GetMicros();
+   return (int32_t)len;
+#else
+   int32_t ret;
+
+   if(ctx->io_mode & (1<<sn)) return recv_impl(ctx, sn, buf, len);
+   ctx->io_mode |= (1<<sn);
+   ret = recv_impl(ctx, sn, buf, len);
+   ctx->io_mode &= ~(1<<sn);
+   return ret;
+#endif
+}
+
+static int32_t recv_view_impl(wiz_SockCtx* ctx, uint8_t sn, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg)
+{
+   wiz_StreamView view;
+   uint16_t rsr, fsr, rd, used;
+   uint8_t  sr;
+#if _WIZCHIP_ == 5500
+   uint8_t  snap[SOCK_SNAP_LEN];
+#endif
+
+   CHECK_SOCKNUM();
+   if(cb == 0) return SOCKERR_ARG;
+   ctx->poll_synced &= ~(1<<sn);
+#if _WIZCHIP_ == 5500
+   WIZCHIP_READ_BUF(Sn_MR(sn), snap, SOCK_SNAP_LEN);
+   if((snap[SOCK_SNAP_MR] & 0x0F) != Sn_MR_TCP) return SOCKERR_SOCKMODE;
+   if(snap[SOCK_SNAP_CR]) return SOCK_BUSY;
+   sr  = snap[SOCK_SNAP_SR];
+   rsr = ((uint16_t)snap[SOCK_SNAP_RX_RSR] << 8) | snap[SOCK_SNAP_RX_RSR + 1];
+   fsr = ((uint16_t)snap[SOCK_SNAP_TX_FSR] << 8) | snap[SOCK_SNAP_TX_FSR + 1];
+   rd  = ((uint16_t)snap[SOCK_SNAP_RX_RD] << 8) | snap[SOCK_SNAP_RX_RD + 1];
+#else
+   CHECK_SOCKMODE(Sn_MR_TCP);
+   if(getSn_CR(sn)) return SOCK_BUSY;
+   sr  = getSn_SR(sn);
+   rsr = getSn_RX_RSR(sn);
+   fsr = getSn_TX_FSR(sn);
+   rd  = getSn_RX_RD(sn);
+#endif
+   if(sr != SOCK_ESTABLISHED)
+   {
+      if(sr != SOCK_CLOSE_WAIT || (rsr == 0 && fsr == getSn_TxMAX(sn)))
+      {
+         close_impl(ctx, sn);
+         return SOCKERR_SOCKSTATUS;
+      }
+   }
+   if(rsr == 0) return SOCK_BUSY;
+   view.sn   = sn;
+   view.len  = rsr;
+   view.base = rd;
+   used = cb(&view, arg);
+   // Nothing complete: no RECV, the data waits in place for more
+   if(used == 0) return 0;
+   if(used > rsr) used = rsr;
+   rd += used;
+#if _WIZCHIP_ == 5500
+   snap[0] = (uint8_t)(rd >> 8);
+   snap[1] = (uint8_t)rd;
+   WIZCHIP_WRITE_BUF(Sn_RX_RD(sn), snap, 2);
+#else
+   setSn_RX_RD(sn, rd);
+#endif
+   // Not waited for, as in recv_avail()
+   setSn_CR(sn, Sn_CR_RECV);
+   ctx->alive_ts[sn] = W5500_GetMicros();
+   return (int32_t)used;
+}
+
+int32_t stream_read(wiz_StreamView* view, uint16_t offset, uint8_t * buf, uint16_t len)
+{
+   if(view == 0 || buf == 0) return SOCKERR_ARG;
+   if(offset >= view->len) return 0;
+   if(len > view->len - offset) len = view->len - offset;
+   wiz_recv_data_at(view->sn, view->base + offset, buf, len);
+   return (int32_t)len;
+}
+
+static uint8_t sock_poll_revents(wiz_SockCtx* ctx, uint8_t sn, uint8_t events)
+{
+   uint8_t rev = 0;
+
+   if(ctx->poll_rd & (1<<sn)) rev |= SOCK_POLL_IN;
+   switch(ctx->poll_sr[sn])
+   {
+      case SOCK_ESTABLISHED:
+         rev |= SOCK_POLL_CONN;
+         if(!(ctx->is_sending & (1<<sn))) rev |= SOCK_POLL_OUT;
+         break;
+      case SOCK_CLOSE_WAIT:
+         rev |= SOCK_POLL_CLOSE;
+         if(!(ctx->is_sending & (1<<sn))) rev |= SOCK_POLL_OUT;
+         break;
+      case SOCK_UDP:
+      case SOCK_IPRAW:
+      case SOCK_MACRAW:
+         if(!(ctx->is_sending & (1<<sn))) rev |= SOCK_POLL_OUT;
+         break;
+      case SOCK_CLOSED:
+         rev |= SOCK_POLL_CLOSE;
+         break;
+      default:
+         break;
+   }
+   rev &= events;
+   if(ctx->poll_err & (1<<sn))
+   {
+      rev |= SOCK_POLL_ERR;
+      ctx->poll_err &= ~(1<<sn);
+   }
+   return rev;
+}
+
+static int16_t pollsocket_impl(wiz_SockCtx* ctx, wiz_PollFd* fds, uint8_t nfds, uint32_t timeout_ms)
+{
+   uint8_t  i, sn;
+   uint8_t  sir;
+   uint8_t  want = 0;
+   int16_t  ready;
+   uint32_t start;
+   uint32_t waited;
+
+   if(fds == 0 || nfds == 0) return SOCKERR_ARG;
+   for(i = 0; i < nfds; i++)
+   {
+      if(fds[i].sn >= _WIZCHIP_SOCK_NUM_) return SOCKERR_SOCKNUM;
+      want |= (1<<fds[i].sn);
+   }
+   start = W5500_GetMicros();
+   while(1)
+   {
+      // One SIR read tells which sockets have news. Others only need a sweep when their cache is stale.
+      // Sockets not asked for are left alone, their Sn_IR may belong to another context.
+      sir = getSIR() & want;
+   #if SOCK_UNREACH_TTL_MS > 0
+      if((W5500_GetMicros() - WIZCHIP.unreach_chk_ts) >= (uint32_t)SOCK_UNREACH_CHECK_MS * 1000) sock_unreach_check(ctx);
+   #endif
+      for(sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++)
+      {
+         if((sir & (1<<sn)) || ((want & (1<<sn)) && !(ctx->poll_synced & (1<<sn))))
+            sock_poll_update(ctx, sn);
+      }
+      ready = 0;
+      for(i = 0; i < nfds; i++)
+      {
+         fds[i].revents = sock_poll_revents(ctx, fds[i].sn, fds[i].events);
+         if(fds[i].revents) ready++;
+      }
+      if(ready || timeout_ms == 0) return ready;
+      waited = (W5500_GetMicros() - start) / 1000;
+      if(timeout_ms != SOCK_POLL_FOREVER)
+      {
+         if(waited >= timeout_ms) return 0;
+         waited = timeout_ms - waited;
+      }
+      else waited = SOCK_POLL_FOREVER;
+      if(ctx->poll_wait) ctx->poll_wait(waited);
+      #if W5500_USE_FreeRTOS==YES
+      else taskYIELD();
+      #endif
+   }
+}
+
+static int32_t sendto_impl(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen)
+{
+   wiz_IOVec iov;
+   iov.buf = buf;
+   iov.len = len;
+   return sendtov_impl(ctx, sn, &iov, 1, addr, port, addrlen);
+}
+
+///////////////////////////////////
+// Socket context API            //
+///////////////////////////////////
+
+void socket_ctx_init(wiz_SockCtx* ctx, _WIZCHIP* chip)
+{
+   uint16_t i;
+   uint8_t* p = (uint8_t*)ctx;
+
+   for(i = 0; i < sizeof(wiz_SockCtx); i++) p[i] = 0;
+   ctx->chip = chip;
+   ctx->any_port = SOCK_ANY_PORT_NUM;
+}
+
+wiz_SockCtx* socket_ctx_default(void)
+{
+   return &sock_ctx_default;
+}
+
+int8_t socket_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
+{
+   SOCK_CTX_CALL(int8_t, socket_impl(ctx, sn, protocol, port, flag));
+}
+
+int8_t close_ctx(wiz_SockCtx* ctx, uint8_t sn)
+{
+   SOCK_CTX_CALL_STAT(int8_t, SOCK_STAT_KIND_CLOSE, close_impl(ctx, sn));
+}
+
+int8_t listen_ctx(wiz_SockCtx* ctx, uint8_t sn)
+{
+   SOCK_CTX_CALL(int8_t, listen_impl(ctx, sn));
+}
+
+int8_t connect_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * addr, uint16_t port, uint8_t addrlen)
+{
+   SOCK_CTX_CALL_STAT(int8_t, SOCK_STAT_KIND_CONNECT, connect_impl(ctx, sn, addr, port, addrlen));
+}
+
+int8_t disconnect_ctx(wiz_SockCtx* ctx, uint8_t sn)
+{
+   SOCK_CTX_CALL(int8_t, disconnect_impl(ctx, sn));
+}
+
+int32_t send_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_TX, send_impl(ctx, sn, buf, len));
+}
+
+int32_t send_reserve_ctx(wiz_SockCtx* ctx, uint8_t sn, uint16_t len, wiz_TxWindow* win)
+{
+   SOCK_CTX_CALL(int32_t, send_reserve_impl(ctx, sn, len, win));
+}
+
+int32_t send_write_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_TxWindow* win, uint16_t offset, uint8_t * buf, uint16_t len)
+{
+   SOCK_CTX_CALL(int32_t, send_write_impl(ctx, sn, win, offset, buf, len));
+}
+
+int32_t send_commit_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_TxWindow* win, uint16_t len)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_TX, send_commit_impl(ctx, sn, win, len));
+}
+
+int32_t sendv_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_TX, sendv_impl(ctx, sn, iov, cnt));
+}
+
+int8_t disconnect_async_ctx(wiz_SockCtx* ctx, uint8_t sn, uint32_t linger_ms)
+{
+   SOCK_CTX_CALL(int8_t, disconnect_async_impl(ctx, sn, linger_ms));
+}
+
+int8_t disconnect_process_ctx(wiz_SockCtx* ctx)
+{
+   SOCK_CTX_CALL(int8_t, disconnect_process_impl(ctx));
+}
+
+int8_t close_all_ctx(wiz_SockCtx* ctx)
+{
+   SOCK_CTX_CALL(int8_t, close_all_impl(ctx));
+}
+
+int8_t socket_linkdown_ctx(wiz_SockCtx* ctx)
+{
+   SOCK_CTX_CALL(int8_t, socket_linkdown_impl(ctx));
+}
+
+int8_t socket_netchange_ctx(wiz_SockCtx* ctx, wiz_NetInfo* before, wiz_NetInfo* after)
+{
+   SOCK_CTX_CALL(int8_t, socket_netchange_impl(ctx, before, after));
+}
+
+int32_t send_flush_ctx(wiz_SockCtx* ctx, uint8_t sn)
+{
+   SOCK_CTX_CALL(int32_t, send_flush_impl(ctx, sn));
+}
+
+void send_flush_expired_ctx(wiz_SockCtx* ctx)
+{
+   _WIZCHIP* prev = 0;
+   if(ctx->chip) prev = wizchip_bind(ctx->chip);
+   send_flush_expired_impl(ctx);
+   if(prev) wizchip_bind(prev);
+}
+
+int32_t recv_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recv_impl(ctx, sn, buf, len));
+}
+
+int32_t recvv_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recvv_impl(ctx, sn, iov, cnt));
+}
+
+int32_t sendto_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port, uint8_t addrlen)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_TX, sendto_impl(ctx, sn, buf, len, addr, port, addrlen));
+}
+
+int32_t sendtov_ctx(wiz_SockCtx* ctx, uint8_t sn, wiz_IOVec* iov, uint8_t cnt, uint8_t * addr, uint16_t port)
+{
+   if(iov == 0 || cnt == 0) return SOCKERR_ARG;
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_TX, sendtov_impl(ctx, sn, iov, cnt, addr, port, 4));
+}
+
+int32_t recvfrom_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port, uint8_t *addrlen)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recvfrom_impl(ctx, sn, buf, len, addr, port, addrlen));
+}
+
+int8_t ctlsocket_ctx(wiz_SockCtx* ctx, uint8_t sn, ctlsock_type cstype, void* arg)
+{
+   SOCK_CTX_CALL(int8_t, ctlsocket_impl(ctx, sn, cstype, arg));
+}
+
+int8_t setsockopt_ctx(wiz_SockCtx* ctx, uint8_t sn, sockopt_type sotype, void* arg)
+{
+   SOCK_CTX_CALL(int8_t, setsockopt_impl(ctx, sn, sotype, arg));
+}
+
+int8_t getsockopt_ctx(wiz_SockCtx* ctx, uint8_t sn, sockopt_type sotype, void* arg)
+{
+   SOCK_CTX_CALL(int8_t, getsockopt_impl(ctx, sn, sotype, arg));
+}
+
+int16_t pollsocket_ctx(wiz_SockCtx* ctx, wiz_PollFd* fds, uint8_t nfds, uint32_t timeout_ms)
+{
+   SOCK_CTX_CALL(int16_t, pollsocket_impl(ctx, fds, nfds, timeout_ms));
+}
+
+int8_t unreachable_check_ctx(wiz_SockCtx* ctx)
+{
+   SOCK_CTX_CALL(int8_t, sock_unreach_check(ctx));
+}
+
+void unreachable_clear_ctx(wiz_SockCtx* ctx)
+{
+   unreachable_clear_impl(ctx);
+}
+
+int8_t sendcompletion_ctx(wiz_SockCtx* ctx, wiz_SendEvent* ev)
+{
+   SOCK_CTX_CALL(int8_t, sendcompletion_impl(ctx, ev));
+}
+
+int8_t udp_connect_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * addr, uint16_t port)
+{
+   SOCK_CTX_CALL(int8_t, udp_connect_impl(ctx, sn, addr, port));
+}
+
+int32_t udp_send_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_TX, udp_send_impl(ctx, sn, buf, len));
+}
+
+int32_t recvfrom_view_ctx(wiz_SockCtx* ctx, uint8_t sn, void (*cb)(wiz_DgramView* view, void* arg), void* arg)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recvfrom_view_impl(ctx, sn, cb, arg));
+}
+
+int16_t socket_check_ctx(wiz_SockCtx* ctx, uint8_t sn)
+{
+   SOCK_CTX_CALL(int16_t, socket_check_impl(ctx, sn));
+}
+
+int32_t recv_timeout_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len, uint32_t timeout_ms)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recv_timeout_impl(ctx, sn, buf, len, timeout_ms));
+}
+
+int32_t recv_avail_ctx(wiz_SockCtx* ctx, uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recv_avail_impl(ctx, sn, buf, len));
+}
+
+int32_t recv_view_ctx(wiz_SockCtx* ctx, uint8_t sn, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg)
+{
+   SOCK_CTX_CALL_STAT(int32_t, SOCK_STAT_KIND_RX, recv_view_impl(ctx, sn, cb, arg));
+}
+
+///////////////////////////////////
+// Legacy API on the default     //
+// socket context                //
+///////////////////////////////////
+
+void reg_socket_sendok_cbfunc(void (*sendok_cb)(uint8_t sn, uint8_t ir, uint32_t elapsed_us, uint8_t exact))
+{
+   reg_socket_sendok_cbfunc_ctx(&sock_ctx_default, sendok_cb);
+}
+
+void reg_socket_poll_wait_cbfunc(void (*poll_wait)(uint32_t timeout_ms))
+{
+   reg_socket_poll_wait_cbfunc_ctx(&sock_ctx_default, poll_wait);
+}
+
+void reg_socket_discon_cbfunc(void (*discon_cb)(uint8_t sn, uint8_t cause, uint32_t latency_ms))
+{
+   reg_socket_discon_cbfunc_ctx(&sock_ctx_default, discon_cb);
+}
+
+void reg_socket_shutdown_cbfunc(void (*shut_cb)(uint8_t sn, uint8_t how, uint32_t elapsed_ms))
+{
+   reg_socket_shutdown_cbfunc_ctx(&sock_ctx_default, shut_cb);
+}
+
+int8_t socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
+{
+   return socket_ctx(&sock_ctx_default, sn, protocol, port, flag);
+}
+
+int8_t close(uint8_t sn)
+{
+   return close_ctx(&sock_ctx_default, sn);
+}
+
+int8_t listen(uint8_t sn)
+{
+   return listen_ctx(&sock_ctx_default, sn);
+}
+
+int8_t disconnect(uint8_t sn)
+{
+   return disconnect_ctx(&sock_ctx_default, sn);
+}
+
+int32_t send(uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   return send_ctx(&sock_ctx_default, sn, buf, len);
+}
+
+int32_t send_reserve(uint8_t sn, uint16_t len, wiz_TxWindow* win)
+{
+   return send_reserve_ctx(&sock_ctx_default, sn, len, win);
+}
+
+int32_t send_write(uint8_t sn, wiz_TxWindow* win, uint16_t offset, uint8_t * buf, uint16_t len)
+{
+   return send_write_ctx(&sock_ctx_default, sn, win, offset, buf, len);
+}
+
+int32_t send_commit(uint8_t sn, wiz_TxWindow* win, uint16_t len)
+{
+   return send_commit_ctx(&sock_ctx_default, sn, win, len);
+}
+
+int32_t sendv(uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   return sendv_ctx(&sock_ctx_default, sn, iov, cnt);
+}
+
+int32_t send_flush(uint8_t sn)
+{
+   return send_flush_ctx(&sock_ctx_default, sn);
+}
+
+void send_flush_expired(void)
+{
+   send_flush_expired_ctx(&sock_ctx_default);
+}
+
+int32_t recv(uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   return recv_ctx(&sock_ctx_default, sn, buf, len);
+}
+
+int32_t recvv(uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   return recvv_ctx(&sock_ctx_default, sn, iov, cnt);
+}
+
+int32_t sendtov(uint8_t sn, wiz_IOVec* iov, uint8_t cnt, uint8_t * addr, uint16_t port)
+{
+   return sendtov_ctx(&sock_ctx_default, sn, iov, cnt, addr, port);
+}
+
+int8_t  ctlsocket(uint8_t sn, ctlsock_type cstype, void* arg)
+{
+   return ctlsocket_ctx(&sock_ctx_default, sn, cstype, arg);
+}
+
+int8_t  setsockopt(uint8_t sn, sockopt_type sotype, void* arg)
+{
+   return setsockopt_ctx(&sock_ctx_default, sn, sotype, arg);
+}
+
+int8_t  getsockopt(uint8_t sn, sockopt_type sotype, void* arg)
+{
+   return getsockopt_ctx(&sock_ctx_default, sn, sotype, arg);
+}
+
+int16_t pollsocket(wiz_PollFd* fds, uint8_t nfds, uint32_t timeout_ms)
+{
+   return pollsocket_ctx(&sock_ctx_default, fds, nfds, timeout_ms);
+}
+
+int32_t recvfrom_view(uint8_t sn, void (*cb)(wiz_DgramView* view, void* arg), void* arg)
+{
+   return recvfrom_view_ctx(&sock_ctx_default, sn, cb, arg);
+}
+
+int8_t udp_connect(uint8_t sn, uint8_t * addr, uint16_t port)
+{
+   return udp_connect_ctx(&sock_ctx_default, sn, addr, port);
+}
+
+int32_t udp_send(uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   return udp_send_ctx(&sock_ctx_default, sn, buf, len);
+}
+
+int8_t sendcompletion(wiz_SendEvent* ev)
+{
+   return sendcompletion_ctx(&sock_ctx_default, ev);
+}
+
+int8_t unreachable_check(void)
+{
+   return unreachable_check_ctx(&sock_ctx_default);
+}
+
+void unreachable_clear(void)
+{
+   unreachable_clear_ctx(&sock_ctx_default);
+}
+
+int16_t socket_check(uint8_t sn)
+{
+   return socket_check_ctx(&sock_ctx_default, sn);
+}
+
+int32_t recv_timeout(uint8_t sn, uint8_t * buf, uint16_t len, uint32_t timeout_ms)
+{
+   return recv_timeout_ctx(&sock_ctx_default, sn, buf, len, timeout_ms);
+}
+
+int32_t recv_avail(uint8_t sn, uint8_t * buf, uint16_t len)
+{
+   return recv_avail_ctx(&sock_ctx_default, sn, buf, len);
+}
+
+int32_t recv_view(uint8_t sn, uint16_t (*cb)(wiz_StreamView* view, void* arg), void* arg)
+{
+   return recv_view_ctx(&sock_ctx_default, sn, cb, arg);
+}
+
+int8_t disconnect_async(uint8_t sn, uint32_t linger_ms)
+{
+   return disconnect_async_ctx(&sock_ctx_default, sn, linger_ms);
+}
+
+int8_t disconnect_process(void)
+{
+   return disconnect_process_ctx(&sock_ctx_default);
+}
+
+int8_t socket_linkdown(void)
+{
+   return socket_linkdown_ctx(&sock_ctx_default);
+}
+
+int8_t socket_netchange(wiz_NetInfo* before, wiz_NetInfo* after)
+{
+   return socket_netchange_ctx(&sock_ctx_default, before, after);
+}
+
+int8_t close_all(void)
+{
+   return close_all_ctx(&sock_ctx_default);
+}
@@ -59,55 +59,68 @@
 #define _W5500_SPI_FDM_OP_LEN2_     0x02
 #define _W5500_SPI_FDM_OP_LEN4_     0x03
 
+#if _WIZCHIP_STATS_
+#define WIZCHIP_COUNT_XFER()        (chip->xfers++)
+#else
+#define WIZCHIP_COUNT_XFER()
+#endif
+
 #if   (_WIZCHIP_ == 5500)
 ////////////////////////////////////////////////////
 
+// The bound chip is looked up once per transaction: WIZCHIP is a call with FreeRTOS.
+// chip->CRIS is what WIZCHIP_CRITICAL_ENTER()/WIZCHIP_CRITICAL_EXIT() reach.
+
 uint8_t  WIZCHIP_READ(uint32_t AddrSel)
 {
+   _WIZCHIP* chip = &WIZCHIP;
    uint8_t ret;
    uint8_t spi_data[3];
 
-   WIZCHIP_CRITICAL_ENTER();
-   WIZCHIP.CS._select();
+   chip->CRIS._enter();
+   chip->CS._select();
+   WIZCHIP_COUNT_XFER();
 
    AddrSel |= (_W5500_SPI_READ_ | _W5500_SPI_VDM_OP_);
 
-   if(!WIZCHIP.IF.SPI._read_burst || !WIZCHIP.IF.SPI._write_burst) 	// byte operation
+   if(!chip->IF.SPI._read_burst || !chip->IF.SPI._write_burst) 	// byte operation
    {
-	   WIZCHIP.IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
+	   chip->IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
+		chip->IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
+		chip->IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
    }
    else																// burst operation
    {
 		spi_data[0] = (AddrSel & 0x00FF0000) >> 16;
 		spi_data[1] = (AddrSel & 0x0000FF00) >> 8;
 		spi_data[2] = (AddrSel & 0x000000FF) >> 0;
-		WIZCHIP.IF.SPI._write_burst(spi_data, 3);
+		chip->IF.SPI._write_burst(spi_data, 3);
    }
-   ret = WIZCHIP.IF.SPI._read_byte();
+   ret = chip->IF.SPI._read_byte();
 
-   WIZCHIP.CS._deselect();
-   WIZCHIP_CRITICAL_EXIT();
+   chip->CS._deselect();
+   chip->CRIS._exit();
    return ret;
 }
 
 void     WIZCHIP_WRITE(uint32_t AddrSel, uint8_t wb )
 {
+   _WIZCHIP* chip = &WIZCHIP;
    uint8_t spi_data[4];
 
-   WIZCHIP_CRITICAL_ENTER();
-   WIZCHIP.CS._select();
+   chip->CRIS._enter();
+   chip->CS._select();
+   WIZCHIP_COUNT_XFER();
 
    AddrSel |= (_W5500_SPI_WRITE_ | _W5500_SPI_VDM_OP_);
 
    //if(!WIZCHIP.IF.SPI._read_burst || !WIZCHIP.IF.SPI._write_burst) 	// byte operation
-   if(!WIZCHIP.IF.SPI._write_burst) 	// byte operation
+   if(!chip->IF.SPI._write_burst) 	// byte operation
    {
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
-		WIZCHIP.IF.SPI._write_byte(wb);
+		chip->IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
+		chip->IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
+		chip->IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
+		chip->IF.SPI._write_byte(wb);
    }
    else									// burst operation
    {
@@ -115,73 +128,155 @@ void     WIZCHIP_WRITE(uint32_t AddrSel, uint8_t wb )
 		spi_data[1] = (AddrSel & 0x0000FF00) >> 8;
 		spi_data[2] = (AddrSel & 0x000000FF) >> 0;
 		spi_data[3] = wb;
-		WIZCHIP.IF.SPI._write_burst(spi_data, 4);
+		chip->IF.SPI._write_burst(spi_data, 4);
    }
 
-   WIZCHIP.CS._deselect();
-   WIZCHIP_CRITICAL_EXIT();
+   chip->CS._deselect();
+   chip->CRIS._exit();
 }
          
 void     WIZCHIP_READ_BUF (uint32_t AddrSel, uint8_t* pBuf, uint16_t len)
 {
+   _WIZCHIP* chip = &WIZCHIP;
    uint8_t spi_data[3];
    uint16_t i;
 
-   WIZCHIP_CRITICAL_ENTER();
-   WIZCHIP.CS._select();
+   chip->CRIS._enter();
+   chip->CS._select();
+   WIZCHIP_COUNT_XFER();
 
    AddrSel |= (_W5500_SPI_READ_ | _W5500_SPI_VDM_OP_);
 
-   if(!WIZCHIP.IF.SPI._read_burst || !WIZCHIP.IF.SPI._write_burst) 	// byte operation
+   if(!chip->IF.SPI._read_burst || !chip->IF.SPI._write_burst) 	// byte operation
    {
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
+		chip->IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
+		chip->IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
+		chip->IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
 		for(i = 0; i < len; i++)
-		   pBuf[i] = WIZCHIP.IF.SPI._read_byte();
+		   pBuf[i] = chip->IF.SPI._read_byte();
    }
    else																// burst operation
    {
 		spi_data[0] = (AddrSel & 0x00FF0000) >> 16;
 		spi_data[1] = (AddrSel & 0x0000FF00) >> 8;
 		spi_data[2] = (AddrSel & 0x000000FF) >> 0;
-		WIZCHIP.IF.SPI._write_burst(spi_data, 3);
-		WIZCHIP.IF.SPI._read_burst(pBuf, len);
+		chip->IF.SPI._write_burst(spi_data, 3);
+		chip->IF.SPI._read_burst(pBuf, len);
    }
 
-   WIZCHIP.CS._deselect();
-   WIZCHIP_CRITICAL_EXIT();
+   chip->CS._deselect();
+   chip->CRIS._exit();
 }
 
 void     WIZCHIP_WRITE_BUF(uint32_t AddrSel, uint8_t* pBuf, uint16_t len)
 {
+   _WIZCHIP* chip = &WIZCHIP;
    uint8_t spi_data[3];
    uint16_t i;
 
-   WIZCHIP_CRITICAL_ENTER();
-   WIZCHIP.CS._select();
+   chip->CRIS._enter();
+   chip->CS._select();
+   WIZCHIP_COUNT_XFER();
 
    AddrSel |= (_W5500_SPI_WRITE_ | _W5500_SPI_VDM_OP_);
 
-   if(!WIZCHIP.IF.SPI._write_burst) 	// byte operation
+   if(!chip->IF.SPI._write_burst) 	// byte operation
    {
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
-		WIZCHIP.IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
+		chip->IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
+		chip->IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
+		chip->IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
 		for(i = 0; i < len; i++)
-			WIZCHIP.IF.SPI._write_byte(pBuf[i]);
+			chip->IF.SPI._write_byte(pBuf[i]);
+   }
+   else									// burst operation
+   {
+		spi_data[0] = (AddrSel & 0x00FF0000) >> 16;
+		spi_data[1] = (AddrSel & 0x0000FF00) >> 8;
+		spi_data[2] = (AddrSel & 0x000000FF) >> 0;
+		chip->IF.SPI._write_burst(spi_data, 3);
+		chip->IF.SPI._write_burst(pBuf, len);
+   }
+
+   chip->CS._deselect();
+   chip->CRIS._exit();
+}
+
+void     WIZCHIP_READ_BUFV (uint32_t AddrSel, wiz_IOVec* iov, uint8_t cnt)
+{
+   _WIZCHIP* chip = &WIZCHIP;
+   uint8_t spi_data[3];
+   uint16_t i;
+   uint8_t n;
+
+   chip->CRIS._enter();
+   chip->CS._select();
+   WIZCHIP_COUNT_XFER();
+
+   AddrSel |= (_W5500_SPI_READ_ | _W5500_SPI_VDM_OP_);
+
+   if(!chip->IF.SPI._read_burst || !chip->IF.SPI._write_burst) 	// byte operation
+   {
+		chip->IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
+		chip->IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
+		chip->IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
+		for(n = 0; n < cnt; n++)
+		   for(i = 0; i < iov[n].len; i++)
+		      iov[n].buf[i] = chip->IF.SPI._read_byte();
+   }
+   else																// burst operation
+   {
+		spi_data[0] = (AddrSel & 0x00FF0000) >> 16;
+		spi_data[1] = (AddrSel & 0x0000FF00) >> 8;
+		spi_data[2] = (AddrSel & 0x000000FF) >> 0;
+		chip->IF.SPI._write_burst(spi_data, 3);
+		if(chip->IF.SPI._read_burstv)
+		   chip->IF.SPI._read_burstv(iov, cnt);
+		else
+		   for(n = 0; n < cnt; n++)
+		      if(iov[n].len) chip->IF.SPI._read_burst(iov[n].buf, iov[n].len);
+   }
+
+   chip->CS._deselect();
+   chip->CRIS._exit();
+}
+
+void     WIZCHIP_WRITE_BUFV(uint32_t AddrSel, wiz_IOVec* iov, uint8_t cnt)
+{
+   _WIZCHIP* chip = &WIZCHIP;
+   uint8_t spi_data[3];
+   uint16_t i;
+   uint8_t n;
+
+   chip->CRIS._enter();
+   chip->CS._select();
+   WIZCHIP_COUNT_XFER();
+
+   AddrSel |= (_W5500_SPI_WRITE_ | _W5500_SPI_VDM_OP_);
+
+   if(!chip->IF.SPI._write_burst) 	// byte operation
+   {
+		chip->IF.SPI._write_byte((AddrSel & 0x00FF0000) >> 16);
+		chip->IF.SPI._write_byte((AddrSel & 0x0000FF00) >>  8);
+		chip->IF.SPI._write_byte((AddrSel & 0x000000FF) >>  0);
+		for(n = 0; n < cnt; n++)
+		   for(i = 0; i < iov[n].len; i++)
+		      chip->IF.SPI._write_byte(iov[n].buf[i]);
    }
    else									// burst operation
    {
 		spi_data[0] = (AddrSel & 0x00FF0000) >> 16;
 		spi_data[1] = (AddrSel & 0x0000FF00) >> 8;
 		spi_data[2] = (AddrSel & 0x000000FF) >> 0;
-		WIZCHIP.IF.SPI._write_burst(spi_data, 3);
-		WIZCHIP.IF.SPI._write_burst(pBuf, len);
+		chip->IF.SPI._write_burst(spi_data, 3);
+		if(chip->IF.SPI._write_burstv)
+		   chip->IF.SPI._write_burstv(iov, cnt);
+		else
+		   for(n = 0; n < cnt; n++)
+		      if(iov[n].len) chip->IF.SPI._write_burst(iov[n].buf, iov[n].len);
    }
 
-   WIZCHIP.CS._deselect();
-   WIZCHIP_CRITICAL_EXIT();
+   chip->CS._deselect();
+   chip->CRIS._exit();
 }
 
 
@@ -237,6 +332,32 @@ void wiz_send_data(uint8_t sn, uint8_t *wizdata, uint16_t len)
    setSn_TX_WR(sn,ptr);
 }
 
+void wiz_send_data_at(uint8_t sn, uint16_t ptr, uint8_t *wizdata, uint16_t len)
+{
+   uint32_t addrsel = 0;
+
+   if(len == 0)  return;
+   addrsel = ((uint32_t)ptr << 8) + (WIZCHIP_TXBUF_BLOCK(sn) << 3);
+   WIZCHIP_WRITE_BUF(addrsel,wizdata, len);
+}
+
+void wiz_send_datav(uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   uint16_t ptr = 0;
+   uint16_t len = 0;
+   uint32_t addrsel = 0;
+   uint8_t n;
+
+   for(n = 0; n < cnt; n++) len += iov[n].len;
+   if(len == 0)  return;
+   ptr = getSn_TX_WR(sn);
+   addrsel = ((uint32_t)ptr << 8) + (WIZCHIP_TXBUF_BLOCK(sn) << 3);
+   WIZCHIP_WRITE_BUFV(addrsel, iov, cnt);
+
+   ptr += len;
+   setSn_TX_WR(sn,ptr);
+}
+
 void wiz_recv_data(uint8_t sn, uint8_t *wizdata, uint16_t len)
 {
    uint16_t ptr = 0;
@@ -254,6 +375,32 @@ void wiz_recv_data(uint8_t sn, uint8_t *wizdata, uint16_t len)
    setSn_RX_RD(sn,ptr);
 }
 
+void wiz_recv_data_at(uint8_t sn, uint16_t ptr, uint8_t *wizdata, uint16_t len)
+{
+   uint32_t addrsel = 0;
+
+   if(len == 0) return;
+   addrsel = ((uint32_t)ptr << 8) + (WIZCHIP_RXBUF_BLOCK(sn) << 3);
+   WIZCHIP_READ_BUF(addrsel, wizdata, len);
+}
+
+void wiz_recv_datav(uint8_t sn, wiz_IOVec* iov, uint8_t cnt)
+{
+   uint16_t ptr = 0;
+   uint16_t len = 0;
+   uint32_t addrsel = 0;
+   uint8_t n;
+
+   for(n = 0; n < cnt; n++) len += iov[n].len;
+   if(len == 0) return;
+   ptr = getSn_RX_RD(sn);
+   addrsel = ((uint32_t)ptr << 8) + (WIZCHIP_RXBUF_BLOCK(sn) << 3);
+   WIZCHIP_READ_BUFV(addrsel, iov, cnt);
+   ptr += len;
+
+   setSn_RX_RD(sn,ptr);
+}
+
 
 void wiz_recv_ignore(uint8_t sn, uint16_t len)
 {
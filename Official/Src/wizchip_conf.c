@@ -54,6 +54,15 @@
 
 #include "wizchip_conf.h"
 
+#if (W5500_USE_FreeRTOS==YES)
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (configNUM_THREAD_LOCAL_STORAGE_POINTERS <= _WIZCHIP_TLS_INDEX_)
+#error "configNUM_THREAD_LOCAL_STORAGE_POINTERS must be above _WIZCHIP_TLS_INDEX_"
+#endif
+#endif
+
 /////////////
 //M20150401 : Remove ; in the default callback function such as wizchip_cris_enter(), wizchip_cs_select() and etc.
 /////////////
@@ -124,11 +133,12 @@ void 	wizchip_bus_writedata(uint32_t AddrSel, iodata_t wb)  { *((volatile iodata
  */
 void wizchip_bus_read_buf(uint32_t AddrSel, iodata_t* buf, int16_t len, uint8_t addrinc)
 { 
+   _WIZCHIP* chip = &WIZCHIP;
    uint16_t i;
    if(addrinc) addrinc = sizeof(iodata_t);
    for ( i = 0; i < len; i++)
    {
-      *buf++ = WIZCHIP.IF.BUS._read_data(AddrSel);
+      *buf++ = chip->IF.BUS._read_data(AddrSel);
       AddrSel += (uint32_t) addrinc;
    }
 }
@@ -148,11 +158,12 @@ void wizchip_bus_read_buf(uint32_t AddrSel, iodata_t* buf, int16_t len, uint8_t
  */
 void wizchip_bus_write_buf(uint32_t AddrSel, iodata_t* buf, int16_t len, uint8_t addrinc)
 { 
+   _WIZCHIP* chip = &WIZCHIP;
    uint16_t i;
    if(addrinc) addrinc = sizeof(iodata_t);
    for( i = 0; i < len ; i++)
    {
-      WIZCHIP.IF.BUS._write_data(AddrSel,*buf++);
+      chip->IF.BUS._write_data(AddrSel,*buf++);
       AddrSel += (uint32_t)addrinc;
    }
 
@@ -185,9 +196,10 @@ void 	wizchip_spi_writebyte(uint8_t wb) {}
 // 20231018 taylor
 void 	wizchip_spi_readburst(uint8_t* pBuf, uint16_t len)
 {
+	_WIZCHIP* chip = &WIZCHIP;
 	for(uint16_t i=0; i<len; i++)
 	{
-		*pBuf++ = WIZCHIP.IF.SPI._read_byte();
+		*pBuf++ = chip->IF.SPI._read_byte();
 	}
 }
 #else
@@ -204,9 +216,10 @@ void 	wizchip_spi_readburst(uint8_t* pBuf, uint16_t len) 	{}
 // 20231018 taylor
 void 	wizchip_spi_writeburst(uint8_t* pBuf, uint16_t len)
 {
+	_WIZCHIP* chip = &WIZCHIP;
 	for(uint16_t i=0; i<len; i++)
 	{
-		WIZCHIP.IF.SPI._write_byte(*pBuf++);
+		chip->IF.SPI._write_byte(*pBuf++);
 	}
 }
 #else
@@ -251,29 +264,48 @@ _WIZCHIP  WIZCHIP =
 //    .IF.SPI._write_byte  = wizchip_spi_writebyte
       };
 */      
-_WIZCHIP  WIZCHIP =
-{
-    _WIZCHIP_IO_MODE_,
-    _WIZCHIP_ID_ ,
-    {
-        wizchip_cris_enter,
-        wizchip_cris_exit
-    },
-    {
-        wizchip_cs_select,
-        wizchip_cs_deselect
-    },
-    {
-        {
-            //M20150601 : Rename the function 
-            //wizchip_bus_readbyte,
-            //wizchip_bus_writebyte
-            wizchip_bus_readdata,
-            wizchip_bus_writedata
-        },
-
-    }
-};
+// Transaction counter of the instance, compiled out with the statistics
+#if _WIZCHIP_STATS_
+#define WIZCHIP_STATS_INIT     , 0
+#else
+#define WIZCHIP_STATS_INIT
+#endif
+
+#define WIZCHIP_DEFAULT_INIT                   \
+{                                              \
+    _WIZCHIP_IO_MODE_,                         \
+    _WIZCHIP_ID_ ,                             \
+    {                                          \
+        wizchip_cris_enter,                    \
+        wizchip_cris_exit                      \
+    },                                         \
+    {                                          \
+        wizchip_cs_select,                     \
+        wizchip_cs_deselect                    \
+    },                                         \
+    {                                          \
+        {                                      \
+            wizchip_bus_readdata,              \
+            wizchip_bus_writedata,             \
+            0,                                 \
+            0                                  \
+        },                                     \
+    },                                         \
+    { { {0, 0, 0, 0}, 0, 0 } },                \
+    0,                                         \
+    0                                          \
+    WIZCHIP_STATS_INIT                         \
+}
+
+//M20150601 : Rename the function 
+//wizchip_bus_readbyte,
+//wizchip_bus_writebyte
+_WIZCHIP  wizchip_default = WIZCHIP_DEFAULT_INIT;
+
+// Pristine copy for the additional instances of wizchip_instance_init()
+static const _WIZCHIP wizchip_template = WIZCHIP_DEFAULT_INIT;
+
+WIZCHIP_TLS _WIZCHIP* wizchip_cur = &wizchip_default;
 
 
 static uint8_t    _DNS_[4];      // DNS server ip address
@@ -285,6 +317,38 @@ static uint8_t      _DNS6_[16];    ///< DSN server IPv6 address
 static ipconf_mode  _IPMODE_;      ///< IP configuration mode
 #endif
 
+void wizchip_instance_init(_WIZCHIP* chip)
+{
+   *chip = wizchip_template;
+}
+
+#if (W5500_USE_FreeRTOS==YES)
+_WIZCHIP* wizchip_current(void)
+{
+   _WIZCHIP* chip;
+
+   // No task to hold the binding before the scheduler runs
+   if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) return wizchip_cur;
+   chip = (_WIZCHIP*)pvTaskGetThreadLocalStoragePointer(NULL, _WIZCHIP_TLS_INDEX_);
+   return chip ? chip : &wizchip_default;
+}
+#endif
+
+_WIZCHIP* wizchip_bind(_WIZCHIP* chip)
+{
+   _WIZCHIP* prev = wizchip_current();
+   if(!chip) chip = &wizchip_default;
+#if (W5500_USE_FreeRTOS==YES)
+   if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+   {
+      vTaskSetThreadLocalStoragePointer(NULL, _WIZCHIP_TLS_INDEX_, chip);
+      return prev;
+   }
+#endif
+   wizchip_cur = chip;
+   return prev;
+}
+
 void reg_wizchip_cris_cbfunc(void(*cris_en)(void), void(*cris_ex)(void))
 {
    if(!cris_en || !cris_ex)
@@ -427,6 +491,15 @@ void reg_wizchip_spiburst_cbfunc(void (*spi_rb)(uint8_t* pBuf, uint16_t len), vo
       WIZCHIP.IF.SPI._write_burst  = spi_wb;
    }
 }
+
+void reg_wizchip_spiburstv_cbfunc(void (*spi_rbv)(wiz_IOVec* iov, uint8_t cnt), void (*spi_wbv)(wiz_IOVec* iov, uint8_t cnt))
+{
+   while(!(WIZCHIP.if_mode & _WIZCHIP_IO_MODE_SPI_));
+
+   // NULL keeps the per-fragment fallback of WIZCHIP_READ_BUFV()/WIZCHIP_WRITE_BUFV()
+   WIZCHIP.IF.SPI._read_burstv  = spi_rbv;
+   WIZCHIP.IF.SPI._write_burstv = spi_wbv;
+}
 #if 1 //teddy 240122
 void reg_wizchip_qspi_cbfunc(void (*qspi_rb)(uint8_t opcode, uint16_t addr, uint8_t* pBuf, uint16_t len), 
                               void (*qspi_wb)(uint8_t opcode, uint16_t addr, uint8_t* pBuf, uint16_t len))
@@ -605,6 +678,10 @@ int8_t ctlnetwork(ctlnetwork_type cntype, void* arg)
       case CN_GET_TIMEOUT:
          wizchip_gettimeout((wiz_NetTimeout*)arg);
          break;
+#if (_WIZCHIP_ == W5100 || _WIZCHIP_ == W5100S || _WIZCHIP_ == W5200 || _WIZCHIP_ == W5300 || _WIZCHIP_ == W5500)
+      case CN_UPDATE_NETINFO:
+         return (int8_t)wizchip_updatenetinfo((wiz_NetInfo*)arg);
+#endif
 		 //teddy 240122
 #if ((_WIZCHIP_ == 6100)||(_WIZCHIP_ == 6300))
       case CN_SET_PREFER:
@@ -1377,6 +1454,62 @@ void wizchip_setnetinfo(wiz_NetInfo* pnetinfo)
    _DHCP_   = pnetinfo->dhcp;
 }
 
+#define NETINFO_REG_LEN    18     // GAR, SUBR, SHAR and SIPR back to back
+
+uint8_t wizchip_updatenetinfo(wiz_NetInfo* pnetinfo)
+{
+   uint8_t cur[NETINFO_REG_LEN];
+   uint8_t nxt[NETINFO_REG_LEN];
+   uint8_t first = NETINFO_REG_LEN, last = 0;
+   uint8_t chg = 0;
+   uint8_t i;
+
+   for(i = 0; i < 4; i++)
+   {
+      nxt[i]      = pnetinfo->gw[i];
+      nxt[4 + i]  = pnetinfo->sn[i];
+      nxt[14 + i] = pnetinfo->ip[i];
+   }
+   for(i = 0; i < 6; i++) nxt[8 + i] = pnetinfo->mac[i];
+#if _WIZCHIP_ == W5500
+   WIZCHIP_READ_BUF(GAR, cur, NETINFO_REG_LEN);
+#else
+   getGAR(&cur[0]);
+   getSUBR(&cur[4]);
+   getSHAR(&cur[8]);
+   getSIPR(&cur[14]);
+#endif
+   for(i = 0; i < NETINFO_REG_LEN; i++)
+   {
+      if(cur[i] == nxt[i]) continue;
+      if(first == NETINFO_REG_LEN) first = i;
+      last = i;
+      if(i < 4)       chg |= NETINFO_CHG_GW;
+      else if(i < 8)  chg |= NETINFO_CHG_SN;
+      else if(i < 14) chg |= NETINFO_CHG_MAC;
+      else            chg |= NETINFO_CHG_IP;
+   }
+   if(first != NETINFO_REG_LEN)
+   {
+#if _WIZCHIP_ == W5500
+      // Unchanged bytes inside the span are written back as they are, one burst beats several
+      WIZCHIP_WRITE_BUF(WIZCHIP_OFFSET_INC(GAR, first), &nxt[first], last - first + 1);
+#else
+      if(chg & NETINFO_CHG_GW)  setGAR(pnetinfo->gw);
+      if(chg & NETINFO_CHG_SN)  setSUBR(pnetinfo->sn);
+      if(chg & NETINFO_CHG_MAC) setSHAR(pnetinfo->mac);
+      if(chg & NETINFO_CHG_IP)  setSIPR(pnetinfo->ip);
+#endif
+   }
+   for(i = 0; i < 4; i++)
+   {
+      if(_DNS_[i] != pnetinfo->dns[i]) chg |= NETINFO_CHG_DNS;
+      _DNS_[i] = pnetinfo->dns[i];
+   }
+   _DHCP_ = pnetinfo->dhcp;
+   return chg;
+}
+
 void wizchip_getnetinfo(wiz_NetInfo* pnetinfo)
 {
    getSHAR(pnetinfo->mac);